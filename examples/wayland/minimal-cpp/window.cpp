@@ -36,7 +36,7 @@ void Window::paintGL()
     GLenum currentTarget = GL_TEXTURE_2D;
     m_textureBlitter.bind(currentTarget);
     functions->glEnable(GL_BLEND);
-    functions->glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    functions->glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
     const auto views = m_compositor->views();
     for (View *view : views) {
@@ -4,7 +4,7 @@
 
 function(qt6_generate_wayland_protocol_client_sources target)
     cmake_parse_arguments(arg
-        "NO_INCLUDE_CORE_ONLY;PRIVATE_CODE;PUBLIC_CODE"
+        "NO_INCLUDE_CORE_ONLY;PRIVATE_CODE;PUBLIC_CODE;STRING_VIEWS"
         "__QT_INTERNAL_WAYLAND_INCLUDE_DIR"
         "FILES"
         ${ARGN})
@@ -28,6 +28,11 @@ function(qt6_generate_wayland_protocol_client_sources target)
     string(REPLACE "." "_" module_define_infix "${module_define_infix}")
     set(build_macro "QT_BUILD_${module_define_infix}_LIB")
 
+    set(qtwaylandscanner_extra_args "")
+    if(arg_STRING_VIEWS)
+        list(APPEND qtwaylandscanner_extra_args "--string-views")
+    endif()
+
     foreach(protocol_file IN LISTS arg_FILES)
         get_filename_component(protocol_name "${protocol_file}" NAME_WLE)
 
@@ -80,6 +85,7 @@ function(qt6_generate_wayland_protocol_client_sources target)
                 "${protocol_file}"
                 --build-macro=${build_macro}
                 --header-path="${wayland_include_dir}"
+                ${qtwaylandscanner_extra_args}
                 > "${qtwaylandscanner_header_output}"
             DEPENDS ${protocol_file} Qt6::qtwaylandscanner
         )
@@ -96,6 +102,7 @@ function(qt6_generate_wayland_protocol_client_sources target)
                 --build-macro=${build_macro}
                 --header-path='${wayland_include_dir}'
                 --add-include='${qtwaylandscanner_code_include}'
+                ${qtwaylandscanner_extra_args}
                 > "${qtwaylandscanner_code_output}"
             DEPENDS ${protocol_file} Qt6::qtwaylandscanner
         )
@@ -11,6 +11,7 @@
 #include "qwaylandscreen_p.h"
 
 #include <QtGui/QImage>
+#include <QtGui/QPainter>
 
 QT_BEGIN_NAMESPACE
 
@@ -28,8 +29,13 @@ public:
     QWaylandWindow *m_wayland_window = nullptr;
 
     bool m_isDirty = true;
+    QRegion m_dirtyRegion;
     QImage m_decorationContentImage;
 
+    // Top, bottom, left and right margin, painted by paintDirtyMargins()
+    QImage m_marginImages[4];
+    QRect m_marginRects[4];
+
     Qt::MouseButtons m_mouseButtons = Qt::NoButton;
 };
 
@@ -64,52 +70,161 @@ void QWaylandAbstractDecoration::setWaylandWindow(QWaylandWindow *window)
     d->m_wayland_window = window;
 }
 
-// Creates regions like this on the outside of a rectangle with inner size \a size
-// -----
-// |   |
-// -----
-// I.e. the top and bottom extends into the corners
-static QRegion marginsRegion(const QSize &size, const QMargins &margins)
-{
-    QRegion r;
-
-    r += QRect(0, 0, size.width(), margins.top()); // top
-    r += QRect(0, size.height()-margins.bottom(), size.width(), margins.bottom()); //bottom
-    r += QRect(0, margins.top(), margins.left(), size.height()); //left
-    r += QRect(size.width()-margins.left(), margins.top(), margins.right(), size.height()-margins.top()); // right
-    return r;
-}
-
 const QImage &QWaylandAbstractDecoration::contentImage()
 {
     Q_D(QWaylandAbstractDecoration);
-    if (d->m_isDirty) {
+    if (isDirty()) {
         // Update the decoration backingstore
 
         const qreal bufferScale = waylandWindow()->scale();
         const QSize imageSize = waylandWindow()->surfaceSize() * bufferScale;
-        d->m_decorationContentImage = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+        if (d->m_decorationContentImage.size() != imageSize)
+            d->m_decorationContentImage = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
         // Only scale by buffer scale, not QT_SCALE_FACTOR etc.
         d->m_decorationContentImage.setDevicePixelRatio(bufferScale);
         d->m_decorationContentImage.fill(Qt::transparent);
         this->paint(&d->m_decorationContentImage);
 
-        QRegion damage = marginsRegion(waylandWindow()->surfaceSize(), waylandWindow()->frameMargins());
-        for (QRect r : damage)
-            waylandWindow()->damage(r);
-
         d->m_isDirty = false;
+        d->m_dirtyRegion = QRegion();
     }
 
     return d->m_decorationContentImage;
 }
 
+/*
+    Repaints the parts of the decoration that changed since the last call into
+    images the size of the margins, and returns them in surface coordinates.
+
+    Decorations implementing paintClipped() only repaint the dirty parts, other
+    decorations are rendered into an image of the size of the whole surface
+    first.
+*/
+QRegion QWaylandAbstractDecoration::updateMargins()
+{
+    Q_D(QWaylandAbstractDecoration);
+    if (!isDirty())
+        return QRegion();
+
+    const QSize surfaceSize = waylandWindow()->surfaceSize();
+    const QMargins m = margins();
+    const QRect marginRects[4] = {
+        QRect(0, 0, surfaceSize.width(), m.top()),
+        QRect(0, surfaceSize.height() - m.bottom(), surfaceSize.width(), m.bottom()),
+        QRect(0, m.top(), m.left(), surfaceSize.height() - m.top() - m.bottom()),
+        QRect(surfaceSize.width() - m.right(), m.top(), m.right(), surfaceSize.height() - m.top() - m.bottom())
+    };
+    QRegion allMargins;
+    for (const QRect &rect : marginRects)
+        allMargins += rect;
+
+    // Only scale by buffer scale, not QT_SCALE_FACTOR etc.
+    const qreal bufferScale = waylandWindow()->scale();
+    for (int i = 0; i < 4; ++i) {
+        QImage &image = d->m_marginImages[i];
+        if (d->m_marginRects[i] != marginRects[i] || image.devicePixelRatio() != bufferScale) {
+            d->m_marginRects[i] = marginRects[i];
+            image = QImage(marginRects[i].size() * bufferScale, QImage::Format_ARGB32_Premultiplied);
+            image.setDevicePixelRatio(bufferScale);
+            d->m_isDirty = true;
+        }
+    }
+
+    const bool fullRepaint = d->m_isDirty;
+    const QRegion dirty = fullRepaint ? allMargins : d->m_dirtyRegion & allMargins;
+    d->m_isDirty = false;
+    d->m_dirtyRegion = QRegion();
+
+    bool clipped = true;
+    for (int i = 0; i < 4 && clipped; ++i) {
+        const QRegion marginDirty = dirty & marginRects[i];
+        if (marginDirty.isEmpty())
+            continue;
+
+        QPainter painter(&d->m_marginImages[i]);
+        painter.translate(-marginRects[i].topLeft());
+        painter.setClipRegion(marginDirty);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for (const QRect &rect : marginDirty)
+            painter.fillRect(rect, Qt::transparent);
+        painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        clipped = paintClipped(&painter);
+    }
+
+    if (!clipped) {
+        // Fall back to repainting everything into a surface sized image
+        d->m_isDirty = true;
+        const QImage &content = contentImage();
+        for (int i = 0; i < 4; ++i) {
+            QPainter painter(&d->m_marginImages[i]);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            const QRect &rect = marginRects[i];
+            painter.drawImage(QRect(QPoint(), rect.size()), content,
+                              QRectF(QPointF(rect.topLeft()) * bufferScale, QSizeF(rect.size()) * bufferScale));
+        }
+        return allMargins;
+    }
+
+    return dirty;
+}
+
+/*
+    Draws \a region, in surface coordinates, of the margin images last painted
+    by updateMargins() with \a painter, which operates in surface coordinates.
+*/
+void QWaylandAbstractDecoration::drawMargins(QPainter *painter, const QRegion &region) const
+{
+    Q_D(const QWaylandAbstractDecoration);
+    for (int i = 0; i < 4; ++i) {
+        const QImage &image = d->m_marginImages[i];
+        const QRect &marginRect = d->m_marginRects[i];
+        const qreal scale = image.devicePixelRatio();
+        for (const QRect &rect : region & marginRect) {
+            const QRect source = rect.translated(-marginRect.topLeft());
+            painter->drawImage(rect, image, QRectF(QPointF(source.topLeft()) * scale, QSizeF(source.size()) * scale));
+        }
+    }
+}
+
+/*
+    Repaints the parts of the decoration that changed since the last call and
+    draws them with \a painter, which operates in surface coordinates. Returns
+    the region that was drawn.
+*/
+QRegion QWaylandAbstractDecoration::paintDirtyMargins(QPainter *painter)
+{
+    const QRegion dirty = updateMargins();
+    drawMargins(painter, dirty);
+    return dirty;
+}
+
 void QWaylandAbstractDecoration::update()
 {
     Q_D(QWaylandAbstractDecoration);
     d->m_isDirty = true;
 }
 
+/*
+    Marks only \a rect, in surface coordinates, as needing a repaint. Used for
+    state changes such as the hover state of a single button.
+*/
+void QWaylandAbstractDecoration::update(const QRect &rect)
+{
+    Q_D(QWaylandAbstractDecoration);
+    d->m_dirtyRegion += rect;
+}
+
+/*
+    Paints the decoration in surface coordinates with \a painter, which may be
+    clipped to the parts that need updating and must not be reset. Returns
+    false when the decoration can only be painted with paint(QPaintDevice *).
+*/
+bool QWaylandAbstractDecoration::paintClipped(QPainter *painter)
+{
+    Q_UNUSED(painter);
+    return false;
+}
+
 void QWaylandAbstractDecoration::setMouseButtons(Qt::MouseButtons mb)
 {
     Q_D(QWaylandAbstractDecoration);
@@ -162,7 +277,7 @@ bool QWaylandAbstractDecoration::isLeftReleased(Qt::MouseButtons newMouseButtonS
 bool QWaylandAbstractDecoration::isDirty() const
 {
     Q_D(const QWaylandAbstractDecoration);
-    return d->m_isDirty;
+    return d->m_isDirty || !d->m_dirtyRegion.isEmpty();
 }
 
 QWindow *QWaylandAbstractDecoration::window() const
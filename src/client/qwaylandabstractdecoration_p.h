@@ -23,6 +23,7 @@
 #include <QtGui/QColor>
 #include <QtGui/QStaticText>
 #include <QtGui/QImage>
+#include <QtGui/QRegion>
 #include <QtGui/QEventPoint>
 #include <QtWaylandClient/qtwaylandclientglobal.h>
 
@@ -61,18 +62,23 @@ public:
     QWaylandWindow *waylandWindow() const;
 
     void update();
+    void update(const QRect &rect);
     bool isDirty() const;
 
     virtual QMargins margins(MarginsType marginsType = Full) const = 0;
 
     QWindow *window() const;
     const QImage &contentImage();
+    QRegion updateMargins();
+    void drawMargins(QPainter *painter, const QRegion &region) const;
+    QRegion paintDirtyMargins(QPainter *painter);
 
     virtual bool handleMouse(QWaylandInputDevice *inputDevice, const QPointF &local, const QPointF &global,Qt::MouseButtons b,Qt::KeyboardModifiers mods) = 0;
     virtual bool handleTouch(QWaylandInputDevice *inputDevice, const QPointF &local, const QPointF &global, QEventPoint::State state, Qt::KeyboardModifiers mods) = 0;
 
 protected:
     virtual void paint(QPaintDevice *device) = 0;
+    virtual bool paintClipped(QPainter *painter);
 
     void setMouseButtons(Qt::MouseButtons mb);
 
@@ -31,8 +31,13 @@ void QWaylandBuffer::release(void *data, wl_buffer *)
     QWaylandBuffer *self = static_cast<QWaylandBuffer *>(data);
     self->mBusy = false;
     self->mCommitted = false;
-    if (self->mDeleteOnRelease)
+    if (self->mDeleteOnRelease) {
         delete self;
+        return;
+    }
+    // The callback may end up deleting the buffer
+    if (auto callback = self->mReleaseCallback)
+        callback();
 }
 
 void QWaylandBuffer::setDeleteOnRelease(bool deleteOnRelease)
@@ -20,6 +20,8 @@
 #include <QtCore/QSize>
 #include <QtCore/QRect>
 
+#include <functional>
+
 #include <QtWaylandClient/private/wayland-wayland-client-protocol.h>
 #include <QtCore/private/qglobal_p.h>
 
@@ -44,6 +46,7 @@ public:
     bool committed() const { return mCommitted; }
 
     void setDeleteOnRelease(bool deleteOnRelease);
+    void setReleaseCallback(const std::function<void()> &callback) { mReleaseCallback = callback; }
 
 protected:
     struct wl_buffer *mBuffer = nullptr;
@@ -52,6 +55,7 @@ private:
     bool mBusy = false;
     bool mCommitted = false;
     bool mDeleteOnRelease = false;
+    std::function<void()> mReleaseCallback;
 
     static void release(void *data, wl_buffer *);
     static const wl_buffer_listener listener;
@@ -59,6 +59,21 @@ QMimeData *QWaylandClipboard::mimeData(QClipboard::Mode mode)
     }
 }
 
+/*
+    Receives the data of the selection for \a mimeType without blocking, unlike
+    mimeData()->data(), which waits until the source client sent all of it.
+    Selections of this client are ready right away.
+*/
+QFuture<QByteArray> QWaylandClipboard::retrieveDataAsync(const QString &mimeType, QClipboard::Mode mode)
+{
+    QMimeData *data = mimeData(mode);
+    if (!data || data == &m_emptyData || data == m_clientClipboard[mode])
+        return QtFuture::makeReadyValueFuture(data ? data->data(mimeType) : QByteArray());
+
+    // Offers of other clients always come with a QWaylandMimeData
+    return static_cast<QWaylandMimeData *>(data)->retrieveDataAsync(mimeType);
+}
+
 void QWaylandClipboard::setMimeData(QMimeData *data, QClipboard::Mode mode)
 {
     auto *seat = mDisplay->currentInputDevice();
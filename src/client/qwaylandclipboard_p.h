@@ -18,6 +18,7 @@
 #include <qpa/qplatformclipboard.h>
 #include <QtCore/QVariant>
 #include <QtCore/QMimeData>
+#include <QtCore/QFuture>
 
 #include <QtWaylandClient/qtwaylandclientglobal.h>
 #include <QtCore/private/qglobal_p.h>
@@ -42,6 +43,8 @@ public:
     bool supportsMode(QClipboard::Mode mode) const override;
     bool ownsMode(QClipboard::Mode mode) const override;
 
+    QFuture<QByteArray> retrieveDataAsync(const QString &mimeType, QClipboard::Mode mode = QClipboard::Clipboard);
+
 private:
     QWaylandDisplay *mDisplay = nullptr;
     QMimeData m_emptyData;
@@ -209,6 +209,7 @@ void QWaylandDataDevice::data_device_enter(uint32_t serial, wl_surface *surface,
         return; // Ignore foreign surfaces
 
     m_dragWindow = dragWaylandWindow->window();
+    m_dragSurfacePosition = dragWaylandWindow->surfacePosition(surface);
     m_dragPoint = calculateDragPosition(x, y, m_dragWindow);
     m_enterSerial = serial;
 
@@ -317,10 +318,8 @@ QPoint QWaylandDataDevice::calculateDragPosition(int x, int y, QWindow *wnd) con
     QPoint pnt(wl_fixed_to_int(x), wl_fixed_to_int(y));
     if (wnd) {
         QWaylandWindow *wwnd = static_cast<QWaylandWindow*>(m_dragWindow->handle());
-        if (wwnd && wwnd->decoration()) {
-            pnt -= QPoint(wwnd->decoration()->margins().left(),
-                          wwnd->decoration()->margins().top());
-        }
+        if (wwnd)
+            pnt = wwnd->mapFromWlSurface(pnt + m_dragSurfacePosition).toPoint();
     }
     return pnt;
 }
@@ -94,6 +94,7 @@ private:
     uint32_t m_enterSerial = 0;
     QPointer<QWindow> m_dragWindow;
     QPoint m_dragPoint;
+    QPoint m_dragSurfacePosition;
     QScopedPointer<QWaylandDataOffer> m_dragOffer;
     QScopedPointer<QWaylandDataOffer> m_selectionOffer;
     QScopedPointer<QWaylandDataSource> m_selectionSource;
@@ -10,6 +10,15 @@
 #include <qpa/qplatformclipboard.h>
 
 #include <QtCore/QDebug>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QPromise>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QTimer>
+
+#include <climits>
+#include <functional>
+
+#include <fcntl.h>
 
 using namespace std::chrono;
 
@@ -81,6 +90,115 @@ static QByteArray convertData(const QString &originalMime, const QString &newMim
     return data;
 }
 
+// The source client has to send at least one chunk per timeout
+static constexpr auto ReadTimeout = 1s;
+
+// Reading in large chunks straight into the result keeps big transfers
+// (e.g. images) from being dominated by syscalls and reallocations
+static constexpr qsizetype ReadChunkSize = 64 * 1024;
+
+// Returns the number of bytes read, 0 at the end of the data, or -1 on errors
+static qsizetype readChunk(int fd, QByteArray &data)
+{
+    const qsizetype size = data.size();
+    data.resize(size + ReadChunkSize);
+    const qsizetype n = QT_READ(fd, data.data() + size, ReadChunkSize);
+    data.resize(size + qMax<qsizetype>(n, 0));
+    return n;
+}
+
+/*
+    Receives the contents of a pipe from the event loop, and reports them
+    through a QPromise. It deletes itself once the transfer completed, failed,
+    or was canceled through the future.
+*/
+class QWaylandMimeDataReader : public QObject
+{
+public:
+    using Finalizer = std::function<QByteArray(const QByteArray &)>;
+
+    QWaylandMimeDataReader(int fd, Finalizer finalizer, QObject *parent)
+        : QObject(parent)
+        , m_fd(fd)
+        , m_finalizer(std::move(finalizer))
+        , m_notifier(fd, QSocketNotifier::Read)
+    {
+        m_promise.start();
+        m_promise.setProgressRange(0, 0);
+
+        // Only the read end is ours, the write end belongs to the source client
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        m_timeout.setSingleShot(true);
+        m_timeout.setInterval(ReadTimeout);
+        QObject::connect(&m_timeout, &QTimer::timeout, this, [this] {
+            qWarning("QWaylandDataOffer: timeout reading from pipe");
+            finish(false);
+        });
+        QObject::connect(&m_notifier, &QSocketNotifier::activated, this, [this] { readAvailable(); });
+        m_watcher.setFuture(m_promise.future());
+        QObject::connect(&m_watcher, &QFutureWatcherBase::canceled, this, [this] { finish(false); });
+        m_timeout.start();
+    }
+
+    ~QWaylandMimeDataReader() override
+    {
+        // An unfinished promise cancels its future when destroyed
+        m_notifier.setEnabled(false);
+        if (m_fd != -1)
+            qt_safe_close(m_fd);
+    }
+
+    QFuture<QByteArray> future() { return m_promise.future(); }
+
+private:
+    void readAvailable()
+    {
+        Q_FOREVER {
+            const qsizetype n = readChunk(m_fd, m_data);
+            if (n > 0) {
+                m_promise.setProgressValue(int(qMin<qsizetype>(m_data.size(), INT_MAX)));
+                continue;
+            }
+            if (n == 0) {
+                finish(true);
+            } else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                qWarning("QWaylandDataOffer: read() failed");
+                finish(false);
+            } else {
+                m_timeout.start();
+            }
+            return;
+        }
+    }
+
+    void finish(bool success)
+    {
+        if (m_fd == -1)
+            return;
+
+        m_notifier.setEnabled(false);
+        m_timeout.stop();
+        qt_safe_close(std::exchange(m_fd, -1));
+
+        if (success) {
+            m_promise.addResult(m_finalizer(m_data));
+        } else if (!m_promise.isCanceled()) {
+            m_promise.addResult(QByteArray());
+        }
+        m_promise.finish();
+        deleteLater();
+    }
+
+    int m_fd = -1;
+    Finalizer m_finalizer;
+    QByteArray m_data;
+    QPromise<QByteArray> m_promise;
+    QFutureWatcher<QByteArray> m_watcher;
+    QSocketNotifier m_notifier;
+    QTimer m_timeout;
+};
+
 QWaylandDataOffer::QWaylandDataOffer(QWaylandDisplay *display, struct ::wl_data_offer *offer)
     : QtWayland::wl_data_offer(offer)
     , m_display(display)
@@ -180,6 +298,43 @@ QStringList QWaylandMimeData::formats_sys() const
     return m_types;
 }
 
+QString QWaylandMimeData::receivedMimeType(const QString &mimeType) const
+{
+    if (m_types.contains(mimeType))
+        return mimeType;
+    if (mimeType == QStringLiteral("text/plain") && m_types.contains(utf8Text()))
+        return utf8Text();
+    if (mimeType == uriList() && m_types.contains(mozUrl()))
+        return mozUrl();
+    return QString();
+}
+
+// Returns the read end of a pipe the source client writes the data into, or -1
+int QWaylandMimeData::startReceiving(const QString &mimeType) const
+{
+    int pipefd[2];
+    if (qt_safe_pipe(pipefd) == -1) {
+        qWarning("QWaylandMimeData: pipe2() failed");
+        return -1;
+    }
+
+    m_dataOffer->startReceiving(mimeType, pipefd[1]);
+
+    close(pipefd[1]);
+    return pipefd[0];
+}
+
+QByteArray QWaylandMimeData::storeData(const QString &mimeType, const QString &receivedMimeType,
+                                       const QByteArray &data) const
+{
+    const QByteArray content = convertData(mimeType, receivedMimeType, data);
+
+    if (mimeType != portalFileTransfer())
+        m_data.insert(mimeType, content);
+
+    return content;
+}
+
 QVariant QWaylandMimeData::retrieveData_sys(const QString &mimeType, QMetaType type) const
 {
     Q_UNUSED(type);
@@ -188,41 +343,44 @@ QVariant QWaylandMimeData::retrieveData_sys(const QString &mimeType, QMetaType t
     if (it != m_data.constEnd())
         return *it;
 
-    QString mime = mimeType;
-
-    if (!m_types.contains(mimeType)) {
-        if (mimeType == QStringLiteral("text/plain") && m_types.contains(utf8Text()))
-            mime = utf8Text();
-        else if (mimeType == uriList() && m_types.contains(mozUrl()))
-            mime = mozUrl();
-        else
-            return QVariant();
-    }
-
-    int pipefd[2];
-    if (qt_safe_pipe(pipefd) == -1) {
-        qWarning("QWaylandMimeData: pipe2() failed");
+    const QString mime = receivedMimeType(mimeType);
+    if (mime.isEmpty())
         return QVariant();
-    }
 
-    m_dataOffer->startReceiving(mime, pipefd[1]);
-
-    close(pipefd[1]);
+    const int fd = startReceiving(mime);
+    if (fd == -1)
+        return QVariant();
 
     QByteArray content;
-    if (readData(pipefd[0], content) != 0) {
+    if (readData(fd, content) != 0) {
         qWarning("QWaylandDataOffer: error reading data for mimeType %s", qPrintable(mimeType));
         content = QByteArray();
     }
 
-    close(pipefd[0]);
+    close(fd);
 
-    content = convertData(mimeType, mime, content);
+    return storeData(mimeType, mime, content);
+}
 
-    if (mimeType != portalFileTransfer())
-        m_data.insert(mimeType, content);
+QFuture<QByteArray> QWaylandMimeData::retrieveDataAsync(const QString &mimeType)
+{
+    auto it = m_data.constFind(mimeType);
+    if (it != m_data.constEnd())
+        return QtFuture::makeReadyValueFuture(*it);
 
-    return content;
+    const QString mime = receivedMimeType(mimeType);
+    if (mime.isEmpty())
+        return QtFuture::makeReadyValueFuture(QByteArray());
+
+    const int fd = startReceiving(mime);
+    if (fd == -1)
+        return QtFuture::makeReadyValueFuture(QByteArray());
+
+    // The reader is a child of this, so that it is canceled together with the offer
+    auto finalizer = [this, mimeType, mime](const QByteArray &data) {
+        return storeData(mimeType, mime, data);
+    };
+    return (new QWaylandMimeDataReader(fd, std::move(finalizer), this))->future();
 }
 
 int QWaylandMimeData::readData(int fd, QByteArray &data) const
@@ -232,7 +390,7 @@ int QWaylandMimeData::readData(int fd, QByteArray &data) const
     readset.events = POLLIN;
 
     Q_FOREVER {
-        int ready = qt_safe_poll(&readset, 1, QDeadlineTimer(1s));
+        int ready = qt_safe_poll(&readset, 1, QDeadlineTimer(ReadTimeout));
         if (ready < 0) {
             qWarning() << "QWaylandDataOffer: qt_safe_poll() failed";
             return -1;
@@ -240,16 +398,13 @@ int QWaylandMimeData::readData(int fd, QByteArray &data) const
             qWarning("QWaylandDataOffer: timeout reading from pipe");
             return -1;
         } else {
-            char buf[4096];
-            int n = QT_READ(fd, buf, sizeof buf);
+            const qsizetype n = readChunk(fd, data);
 
             if (n < 0) {
                 qWarning("QWaylandDataOffer: read() failed");
                 return -1;
             } else if (n == 0) {
                 return 0;
-            } else if (n > 0) {
-                data.append(buf, n);
             }
         }
     }
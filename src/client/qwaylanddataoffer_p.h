@@ -15,6 +15,7 @@
 // We mean it.
 //
 
+#include <QtCore/qfuture.h>
 #include <QtCore/qhash.h>
 #include <QtCore/qstring.h>
 
@@ -74,12 +75,21 @@ public:
 
     void appendFormat(const QString &mimeType);
 
+    // Receives the data without blocking, driven by the event loop. The returned
+    // future reports the number of bytes received so far as its progress value
+    // and can be canceled.
+    QFuture<QByteArray> retrieveDataAsync(const QString &mimeType);
+
 protected:
     bool hasFormat_sys(const QString &mimeType) const override;
     QStringList formats_sys() const override;
     QVariant retrieveData_sys(const QString &mimeType, QMetaType type) const override;
 
 private:
+    QString receivedMimeType(const QString &mimeType) const;
+    int startReceiving(const QString &mimeType) const;
+    QByteArray storeData(const QString &mimeType, const QString &receivedMimeType,
+                         const QByteArray &data) const;
     int readData(int fd, QByteArray &data) const;
 
     QWaylandAbstractDataOffer *m_dataOffer = nullptr;
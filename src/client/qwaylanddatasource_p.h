@@ -19,6 +19,7 @@
 
 #include <QtWaylandClient/private/qwayland-wayland.h>
 #include <QtWaylandClient/private/qtwaylandclientglobal_p.h>
+#include <QtWaylandClient/private/qwaylandmimedatasender_p.h>
 
 QT_REQUIRE_CONFIG(wayland_datadevice);
 
@@ -55,6 +56,7 @@ protected:
 
 private:
     QMimeData *m_mime_data = nullptr;
+    QWaylandMimeDataSender m_sender;
     bool m_accepted = false;
     Qt::DropAction m_dropAction = Qt::IgnoreAction;
 };
@@ -0,0 +1,261 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qwaylanddecorationsurface_p.h"
+#include "qwaylandabstractdecoration_p.h"
+#include "qwaylanddisplay_p.h"
+#include "qwaylandshmbackingstore_p.h"
+#include "qwaylandviewport_p.h"
+#include "qwaylandwindow_p.h"
+
+#include <QtCore/QThread>
+#include <QtGui/QPainter>
+#include <QtGui/qpa/qplatformscreen.h>
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWaylandClient {
+
+// Buffers in flight per edge, a new frame is skipped if all of them are held by the compositor
+static const size_t MaxBuffers = 3;
+
+class QWaylandDecorationSurface::Edge : public QWaylandSurface
+{
+public:
+    explicit Edge(QWaylandWindow *window);
+    ~Edge() override;
+
+    void update(QWaylandDecorationSurface *owner, const QRect &rect, const QRegion &dirty);
+    QPoint position() const { return m_rect.topLeft(); }
+
+private:
+    QWaylandShmBuffer *availableBuffer(QWaylandDecorationSurface *owner, const QSize &size);
+
+    QtWayland::wl_subsurface m_subSurface;
+    QScopedPointer<QWaylandViewport> m_viewport;
+    std::vector<std::unique_ptr<QWaylandShmBuffer>> m_buffers;
+    QRect m_rect; // In surface coordinates, including the margins
+    QRegion m_pendingDamage;
+    QPoint m_position;
+    int m_bufferScale = 1;
+    bool m_attached = false;
+};
+
+QWaylandDecorationSurface::Edge::Edge(QWaylandWindow *window)
+    : QWaylandSurface(window->display())
+    , m_subSurface(window->display()->subCompositor()->get_subsurface(object(), window->wlSurface()))
+{
+    // Let input events for this surface be handled by the window
+    m_window = window;
+
+    // Subsurfaces start out synchronized, so that decoration updates are applied
+    // together with the next commit of the window contents.
+    m_subSurface.place_below(window->wlSurface());
+
+    // Same as for the window itself, see QWaylandWindow::initializeWlSurface()
+    if (window->display()->viewporter() && window->display()->fractionalScaleManager())
+        m_viewport.reset(new QWaylandViewport(window->display()->viewporter()->get_viewport(object())));
+}
+
+QWaylandDecorationSurface::Edge::~Edge()
+{
+    m_subSurface.destroy();
+}
+
+QWaylandShmBuffer *QWaylandDecorationSurface::Edge::availableBuffer(QWaylandDecorationSurface *owner,
+                                                                    const QSize &size)
+{
+    QWaylandShmBuffer *available = nullptr;
+    for (auto it = m_buffers.begin(); it != m_buffers.end();) {
+        QWaylandShmBuffer *buffer = it->get();
+        if (!buffer->busy() && buffer->size() != size) {
+            it = m_buffers.erase(it);
+            continue;
+        }
+        if (!available && !buffer->busy())
+            available = buffer;
+        ++it;
+    }
+
+    if (!available && m_buffers.size() < MaxBuffers) {
+        m_buffers.emplace_back(owner->createBuffer(size));
+        available = m_buffers.back().get();
+        available->dirtyRegion() = m_rect;
+    }
+    return available;
+}
+
+/*
+    Shows the part \a rect, in surface coordinates, of the decoration, repainting
+    what is in \a dirty or has not been shown yet.
+*/
+void QWaylandDecorationSurface::Edge::update(QWaylandDecorationSurface *owner, const QRect &rect,
+                                             const QRegion &dirty)
+{
+    if (rect != m_rect) {
+        // Buffers of the same size may still be reused, but need to be repainted
+        m_rect = rect;
+        m_pendingDamage = rect;
+        for (const auto &buffer : m_buffers)
+            buffer->dirtyRegion() = rect;
+    }
+    const QRegion edgeDirty = dirty & rect;
+    for (const auto &buffer : m_buffers)
+        buffer->dirtyRegion() += edgeDirty;
+    m_pendingDamage += edgeDirty;
+    if (m_pendingDamage.isEmpty())
+        return;
+
+    if (rect.isEmpty()) {
+        if (m_attached) {
+            attach(nullptr, 0, 0);
+            commit();
+            m_attached = false;
+        }
+        m_buffers.clear();
+        m_pendingDamage = QRegion();
+        return;
+    }
+
+    const qreal scale = m_window->scale();
+    QWaylandShmBuffer *buffer = availableBuffer(owner, rect.size() * scale);
+    if (!buffer)
+        return; // Try again with the next frame
+
+    {
+        QPainter painter(buffer->image());
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.translate(-rect.topLeft());
+        m_window->decoration()->drawMargins(&painter, buffer->dirtyRegion());
+    }
+    buffer->dirtyRegion() = QRegion();
+
+    // Relative to the window's wl_surface, which starts inside the margins
+    const QMargins margins = m_window->decoration()->margins();
+    const QPoint position = rect.topLeft() - QPoint(margins.left(), margins.top());
+    if (position != m_position || !m_attached) {
+        m_subSurface.set_position(position.x(), position.y());
+        m_position = position;
+    }
+
+    if (m_viewport) {
+        m_viewport->setDestination(rect.size());
+    } else if (version() >= 3 && m_bufferScale != int(std::ceil(scale))) {
+        m_bufferScale = int(std::ceil(scale));
+        set_buffer_scale(m_bufferScale);
+    }
+
+    buffer->setBusy(true);
+    attach(buffer->buffer(), 0, 0);
+    for (const QRect &damaged : std::exchange(m_pendingDamage, QRegion())) {
+        const QRect local = damaged.translated(-rect.topLeft());
+        damage(local.x(), local.y(), local.width(), local.height());
+    }
+    commit();
+    m_attached = true;
+}
+
+QWaylandDecorationSurface::QWaylandDecorationSurface(QWaylandWindow *window)
+    : m_window(window)
+{
+    for (auto &edge : m_edges)
+        edge.reset(new Edge(window));
+}
+
+QWaylandDecorationSurface::~QWaylandDecorationSurface() = default;
+
+bool QWaylandDecorationSurface::isSupported(QWaylandDisplay *display)
+{
+    static const bool enabled = qEnvironmentVariableIntValue("QT_WAYLAND_DECORATION_SUBSURFACE") != 0;
+    return enabled && display->subCompositor();
+}
+
+/*
+    Position of \a surface in wl_surface coordinates, if it shows a part of the
+    decoration.
+*/
+std::optional<QPoint> QWaylandDecorationSurface::surfacePosition(::wl_surface *surface) const
+{
+    for (const auto &edge : m_edges) {
+        if (edge->object() == surface)
+            return edge->position();
+    }
+    return std::nullopt;
+}
+
+/*
+    Buffers of all edges share one pool, with room for every edge to have all of
+    its buffers in flight at up to twice the size, e.g. during interactive resizing.
+*/
+QWaylandShmBuffer *QWaylandDecorationSurface::createBuffer(const QSize &size)
+{
+    if (m_pool && m_pool->isEmpty()
+        && (m_pool->reservedSize() < m_poolSize || m_pool->reservedSize() > 4 * m_poolSize)) {
+        m_pool.reset();
+    }
+
+    if (!m_pool) {
+        m_pool.reset(new QWaylandShmPool(m_window->display(), m_poolSize));
+        if (!m_pool->isValid())
+            m_pool.reset();
+    }
+
+    QImage::Format format = QImage::Format_ARGB32_Premultiplied;
+    if (QPlatformScreen *screen = QPlatformScreen::platformScreenForWindow(m_window->window()))
+        format = screen->format();
+    const qreal scale = m_window->scale();
+
+    if (m_pool) {
+        auto *buffer = new QWaylandShmBuffer(m_window->display(), m_pool.get(), size, format, scale);
+        if (buffer->buffer())
+            return buffer;
+        delete buffer;
+    }
+
+    // The pool is exhausted, fall back to a buffer with its own pool
+    return new QWaylandShmBuffer(m_window->display(), size, format, scale);
+}
+
+/*
+    Repaints what changed in the decoration and commits it. As the subsurfaces are
+    synchronized, this only takes effect with the next commit of the window.
+*/
+void QWaylandDecorationSurface::update()
+{
+    Q_ASSERT(QThread::currentThread() == m_window->thread());
+    QWaylandAbstractDecoration *decoration = m_window->decoration();
+    if (!decoration)
+        return;
+
+    const QRegion dirty = decoration->isDirty() ? decoration->updateMargins() : QRegion();
+
+    // Same split as in QWaylandAbstractDecoration::updateMargins()
+    const QSize surfaceSize = m_window->surfaceSize();
+    const QMargins m = decoration->margins();
+    const QRect edgeRects[4] = {
+        QRect(0, 0, surfaceSize.width(), m.top()),
+        QRect(0, surfaceSize.height() - m.bottom(), surfaceSize.width(), m.bottom()),
+        QRect(0, m.top(), m.left(), surfaceSize.height() - m.top() - m.bottom()),
+        QRect(surfaceSize.width() - m.right(), m.top(), m.right(), surfaceSize.height() - m.top() - m.bottom())
+    };
+
+    static const qsizetype pageSize = 4096;
+    const qreal scale = m_window->scale();
+    qsizetype edgesSize = 0;
+    for (const QRect &rect : edgeRects) {
+        const QSize bufferSize = rect.size() * scale;
+        edgesSize += qsizetype(bufferSize.width()) * 4 * bufferSize.height() + pageSize;
+    }
+    m_poolSize = qsizetype(MaxBuffers) * 2 * edgesSize;
+
+    for (int i = 0; i < 4; ++i)
+        m_edges[i]->update(this, edgeRects[i], dirty);
+}
+
+}
+
+QT_END_NAMESPACE
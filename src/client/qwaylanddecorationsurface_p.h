@@ -0,0 +1,64 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QWAYLANDDECORATIONSURFACE_P_H
+#define QWAYLANDDECORATIONSURFACE_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtWaylandClient/private/qwaylandsurface_p.h>
+
+#include <QtCore/QPoint>
+#include <QtCore/QRect>
+
+#include <memory>
+#include <optional>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWaylandClient {
+
+class QWaylandShmBuffer;
+class QWaylandShmPool;
+
+// Shows the client-side decoration of a window in four synchronized subsurfaces,
+// one per edge, placed below the window's own wl_surface. The decoration is then
+// neither part of the window's buffers nor needs buffers the size of the window.
+// Only used from the GUI thread.
+class QWaylandDecorationSurface
+{
+public:
+    explicit QWaylandDecorationSurface(QWaylandWindow *window);
+    ~QWaylandDecorationSurface();
+
+    static bool isSupported(QWaylandDisplay *display);
+
+    std::optional<QPoint> surfacePosition(::wl_surface *surface) const;
+
+    void update();
+
+private:
+    class Edge;
+
+    QWaylandShmBuffer *createBuffer(const QSize &size);
+
+    QWaylandWindow *m_window = nullptr;
+    std::unique_ptr<QWaylandShmPool> m_pool; // Outlives the buffers of the edges
+    std::unique_ptr<Edge> m_edges[4];
+    qsizetype m_poolSize = 0;
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDDECORATIONSURFACE_P_H
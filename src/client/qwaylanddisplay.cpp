@@ -35,6 +35,7 @@
 #include "qwaylandclientbufferintegration_p.h"
 
 #include "qwaylandpointergestures_p.h"
+#include "qwaylandpresentation_p.h"
 #include "qwaylandsubsurface_p.h"
 #include "qwaylandtouch_p.h"
 #if QT_CONFIG(tabletevent)
@@ -49,6 +50,7 @@
 #include <QtWaylandClient/private/qwayland-qt-text-input-method-unstable-v1.h>
 #include <QtWaylandClient/private/qwayland-fractional-scale-v1.h>
 #include <QtWaylandClient/private/qwayland-viewporter.h>
+#include <QtWaylandClient/private/qwayland-single-pixel-buffer-v1.h>
 #include <QtWaylandClient/private/qwayland-cursor-shape-v1.h>
 #include <QtWaylandClient/private/qwayland-xdg-system-bell-v1.h>
 #include <QtWaylandClient/private/qwayland-xdg-toplevel-drag-v1.h>
@@ -764,10 +766,16 @@ void QWaylandDisplay::registry_global(uint32_t id, const QString &interface, uin
         mGlobals.fractionalScaleManager.reset(
                 new WithDestructor<QtWayland::wp_fractional_scale_manager_v1,
                                    wp_fractional_scale_manager_v1_destroy>(registry, id, 1));
+    } else if (interface == QLatin1String(QWaylandPresentation::interface()->name)) {
+        mGlobals.presentation.reset(new QWaylandPresentation(registry, id, 1));
     } else if (interface == QLatin1String("wp_viewporter")) {
         mGlobals.viewporter.reset(
                 new WithDestructor<QtWayland::wp_viewporter, wp_viewporter_destroy>(
                         registry, id, qMin(1u, version)));
+    } else if (interface == QLatin1String(QtWayland::wp_single_pixel_buffer_manager_v1::interface()->name)) {
+        mGlobals.singlePixelBufferManager.reset(
+                new WithDestructor<QtWayland::wp_single_pixel_buffer_manager_v1,
+                                   wp_single_pixel_buffer_manager_v1_destroy>(registry, id, 1));
     } else if (interface == QLatin1String(QtWayland::wp_cursor_shape_manager_v1::interface()->name)) {
         mGlobals.cursorShapeManager.reset(new WithDestructor<QtWayland::wp_cursor_shape_manager_v1,
                                                              wp_cursor_shape_manager_v1_destroy>(
@@ -54,6 +54,7 @@ namespace QtWayland {
     class qt_text_input_method_manager_v1;
     class wp_cursor_shape_manager_v1;
     class wp_fractional_scale_manager_v1;
+    class wp_single_pixel_buffer_manager_v1;
     class wp_viewporter;
     class xdg_system_bell_v1;
     class xdg_toplevel_drag_manager_v1;
@@ -77,6 +78,7 @@ class QWaylandPrimarySelectionDeviceManagerV1;
 class QWaylandTabletManagerV2;
 #endif
 class QWaylandPointerGestures;
+class QWaylandPresentation;
 class QWaylandTouchExtension;
 class QWaylandQtKeyExtension;
 class QWaylandWindow;
@@ -195,10 +197,22 @@ public:
     {
         return mGlobals.fractionalScaleManager.get();
     }
+    QWaylandPresentation *presentation() const
+    {
+        return mGlobals.presentation.get();
+    }
     QtWayland::wp_viewporter *viewporter() const
     {
         return mGlobals.viewporter.get();
     }
+    QtWayland::wp_single_pixel_buffer_manager_v1 *singlePixelBufferManager() const
+    {
+        return mGlobals.singlePixelBufferManager.get();
+    }
+    QtWayland::wl_subcompositor *subCompositor() const
+    {
+        return mGlobals.subCompositor.get();
+    }
     QtWayland::wp_cursor_shape_manager_v1 *cursorShapeManager() const
     {
         return mGlobals.cursorShapeManager.get();
@@ -340,7 +354,9 @@ private:
         std::unique_ptr<QWaylandHardwareIntegration> hardwareIntegration;
         std::unique_ptr<QWaylandXdgOutputManagerV1> xdgOutputManager;
         std::unique_ptr<QtWayland::wp_viewporter> viewporter;
+        std::unique_ptr<QtWayland::wp_single_pixel_buffer_manager_v1> singlePixelBufferManager;
         std::unique_ptr<QtWayland::wp_fractional_scale_manager_v1> fractionalScaleManager;
+        std::unique_ptr<QWaylandPresentation> presentation;
         std::unique_ptr<QtWayland::wp_cursor_shape_manager_v1> cursorShapeManager;
         std::unique_ptr<QtWayland::xdg_system_bell_v1> systemBell;
         std::unique_ptr<QtWayland::xdg_toplevel_drag_manager_v1> xdgToplevelDragManager;
@@ -127,6 +127,7 @@ QWaylandInputDevice::Pointer::Pointer(QWaylandInputDevice *seat)
     : mParent(seat)
 {
     init(seat->get_pointer());
+    mCoalesceMotion = qEnvironmentVariableIntValue("QT_WAYLAND_COALESCE_POINTER_MOTION") > 0;
 #if QT_CONFIG(cursor)
     if (auto cursorShapeManager = seat->mQDisplay->cursorShapeManager()) {
         mCursor.shape.reset(new QWaylandCursorShape(cursorShapeManager->get_pointer(object())));
@@ -652,11 +653,13 @@ void QWaylandInputDevice::Pointer::pointer_enter(uint32_t serial, struct wl_surf
     mFocus = window->waylandSurface();
     connect(mFocus.data(), &QObject::destroyed, this, &Pointer::handleFocusDestroyed);
 
-    mSurfacePos = QPointF(wl_fixed_to_double(sx), wl_fixed_to_double(sy));
+    mFocusSurfacePosition = window->surfacePosition(surface);
+    mSurfacePos = QPointF(wl_fixed_to_double(sx), wl_fixed_to_double(sy)) + mFocusSurfacePosition;
     mGlobalPos = window->mapToGlobalF(mSurfacePos);
 
     mParent->mSerial = serial;
     mEnterSerial = serial;
+    mMotionHistoryCount = 0;
 
 #if QT_CONFIG(cursor)
     // Depends on mEnterSerial being updated
@@ -665,7 +668,7 @@ void QWaylandInputDevice::Pointer::pointer_enter(uint32_t serial, struct wl_surf
 
     QWaylandWindow *grab = QWaylandWindow::mouseGrab();
     if (!grab)
-        setFrameEvent(new EnterEvent(window, mSurfacePos, mGlobalPos));
+        setFrameEvent(EnterEvent(window, mSurfacePos, mGlobalPos));
 }
 
 class LeaveEvent : public QWaylandPointerEvent
@@ -694,7 +697,7 @@ void QWaylandInputDevice::Pointer::pointer_leave(uint32_t serial, struct wl_surf
         return; // Ignore foreign surfaces
 
     if (!QWaylandWindow::mouseGrab())
-        setFrameEvent(new LeaveEvent(window, mSurfacePos, mGlobalPos));
+        setFrameEvent(LeaveEvent(window, mSurfacePos, mGlobalPos));
 }
 
 class MotionEvent : public QWaylandPointerEvent
@@ -717,7 +720,7 @@ void QWaylandInputDevice::Pointer::pointer_motion(uint32_t time, wl_fixed_t surf
         return;
     }
 
-    QPointF pos(wl_fixed_to_double(surface_x), wl_fixed_to_double(surface_y));
+    QPointF pos = QPointF(wl_fixed_to_double(surface_x), wl_fixed_to_double(surface_y)) + mFocusSurfacePosition;
     QPointF global = window->mapToGlobalF(pos);
 
     mSurfacePos = pos;
@@ -731,8 +734,12 @@ void QWaylandInputDevice::Pointer::pointer_motion(uint32_t time, wl_fixed_t surf
         pos = QPointF(-1, -1);
         global = grab->mapToGlobalF(pos);
         window = grab;
+    } else {
+        mMotionHistory[mMotionHistoryNext] = { time, pos, global };
+        mMotionHistoryNext = (mMotionHistoryNext + 1) % qsizetype(mMotionHistory.size());
+        mMotionHistoryCount = qMin(mMotionHistoryCount + 1, qsizetype(mMotionHistory.size()));
     }
-    setFrameEvent(new MotionEvent(window, time, pos, global, mButtons, mParent->modifiers()));
+    setFrameEvent(MotionEvent(window, time, pos, global, mButtons, mParent->modifiers()));
 }
 
 class PressEvent : public QWaylandPointerEvent
@@ -817,9 +824,9 @@ void QWaylandInputDevice::Pointer::pointer_button(uint32_t serial, uint32_t time
     }
 
     if (state)
-        setFrameEvent(new PressEvent(window, time, pos, global, mButtons, qt_button, mParent->modifiers()));
+        setFrameEvent(PressEvent(window, time, pos, global, mButtons, qt_button, mParent->modifiers()));
     else
-        setFrameEvent(new ReleaseEvent(window, time, pos, global, mButtons, qt_button, mParent->modifiers()));
+        setFrameEvent(ReleaseEvent(window, time, pos, global, mButtons, qt_button, mParent->modifiers()));
 }
 
 void QWaylandInputDevice::Pointer::invalidateFocus()
@@ -833,11 +840,12 @@ void QWaylandInputDevice::Pointer::invalidateFocus()
 
 void QWaylandInputDevice::Pointer::releaseButtons()
 {
-    setFrameEvent(new ReleaseEvent(nullptr, mParent->mTime, mSurfacePos, mGlobalPos, Qt::NoButton, Qt::NoButton, mParent->modifiers()));
+    setFrameEvent(ReleaseEvent(nullptr, mParent->mTime, mSurfacePos, mGlobalPos, Qt::NoButton, Qt::NoButton, mParent->modifiers()));
 }
 
 void QWaylandInputDevice::Pointer::leavePointers()
 {
+    flushCoalescedMotion();
     if (auto *window = focusWindow()) {
         LeaveEvent e(focusWindow(), mSurfacePos, mGlobalPos);
         window->handleMouse(mParent, e);
@@ -1013,10 +1021,10 @@ void QWaylandInputDevice::Pointer::pointer_axis_relative_direction(uint32_t axis
     }
 }
 
-void QWaylandInputDevice::Pointer::setFrameEvent(QWaylandPointerEvent *event)
+void QWaylandInputDevice::Pointer::setFrameEvent(const QWaylandPointerEvent &event)
 {
-    qCDebug(lcQpaWaylandInput) << "Setting frame event " << event->type;
-    if (mFrameData.event && mFrameData.event->type != event->type) {
+    qCDebug(lcQpaWaylandInput) << "Setting frame event " << event.type;
+    if (mFrameData.event && mFrameData.event->type != event.type) {
         qCDebug(lcQpaWaylandInput) << "Flushing; previous was " << mFrameData.event->type;
         flushFrameEvent();
     }
@@ -1108,6 +1116,8 @@ void QWaylandInputDevice::Pointer::flushScrollEvent()
 
     // Angle delta is required for Qt wheel events, so don't try to send events if it's zero
     if (!angleDelta.isNull()) {
+        flushCoalescedMotion();
+
         QWaylandWindow *target = QWaylandWindow::mouseGrab();
         if (!target)
             target = focusWindow();
@@ -1140,25 +1150,65 @@ void QWaylandInputDevice::Pointer::flushScrollEvent()
 
 void QWaylandInputDevice::Pointer::flushFrameEvent()
 {
-    if (auto *event = mFrameData.event) {
-        if (auto window = event->surface) {
-            window->handleMouse(mParent, *event);
-        } else if (mFrameData.event->type == QEvent::MouseButtonRelease) {
-            // If the window has been destroyed, we still need to report an up event, but it can't
-            // be handled by the destroyed window (obviously), so send the event here instead.
-            QWindowSystemInterface::handleMouseEvent(nullptr, event->timestamp, event->local,
-                                 event->global, event->buttons,
-                                 event->button, event->type,
-                                 event->modifiers);// , Qt::MouseEventSource source = Qt::MouseEventNotSynthesized);
+    if (mFrameData.event) {
+        if (mCoalesceMotion && mFrameData.event->type == QEvent::MouseMove) {
+            // Only the latest position is delivered, the others stay in the motion history
+            mCoalescedMotion = std::move(mFrameData.event);
+            if (!mCoalescedMotionFlushScheduled) {
+                mCoalescedMotionFlushScheduled = true;
+                QMetaObject::invokeMethod(this, &Pointer::flushCoalescedMotion, Qt::QueuedConnection);
+            }
+        } else {
+            flushCoalescedMotion();
+            deliverFrameEvent(*mFrameData.event);
         }
-        delete mFrameData.event;
-        mFrameData.event = nullptr;
+        mFrameData.event.reset();
     }
 
     //TODO: do modifiers get passed correctly here?
     flushScrollEvent();
 }
 
+void QWaylandInputDevice::Pointer::flushCoalescedMotion()
+{
+    mCoalescedMotionFlushScheduled = false;
+    if (mCoalescedMotion) {
+        deliverFrameEvent(*mCoalescedMotion);
+        mCoalescedMotion.reset();
+    }
+}
+
+void QWaylandInputDevice::Pointer::deliverFrameEvent(const QWaylandPointerEvent &event)
+{
+    if (auto window = event.surface) {
+        window->handleMouse(mParent, event);
+    } else if (event.type == QEvent::MouseButtonRelease) {
+        // If the window has been destroyed, we still need to report an up event, but it can't
+        // be handled by the destroyed window (obviously), so send the event here instead.
+        QWindowSystemInterface::handleMouseEvent(nullptr, event.timestamp, event.local,
+                             event.global, event.buttons,
+                             event.button, event.type,
+                             event.modifiers);// , Qt::MouseEventSource source = Qt::MouseEventNotSynthesized);
+    }
+}
+
+// Oldest first, as maps with the timestamp and the local and global position
+QVariantList QWaylandInputDevice::Pointer::motionHistory() const
+{
+    QVariantList history;
+    history.reserve(mMotionHistoryCount);
+    const qsizetype capacity = qsizetype(mMotionHistory.size());
+    for (qsizetype i = mMotionHistoryCount; i > 0; --i) {
+        const MotionSample &sample = mMotionHistory[(mMotionHistoryNext - i + capacity) % capacity];
+        history.append(QVariantMap {
+            { QStringLiteral("timestamp"), QVariant::fromValue(sample.timestamp) },
+            { QStringLiteral("position"), sample.local },
+            { QStringLiteral("globalPosition"), sample.global },
+        });
+    }
+    return history;
+}
+
 bool QWaylandInputDevice::Pointer::isDefinitelyTerminated(QtWayland::wl_pointer::axis_source source) const
 {
     return source == axis_source_finger;
@@ -1394,8 +1444,9 @@ void QWaylandInputDevice::Touch::touch_down(uint32_t serial,
     mParent->mTime = time;
     mParent->mSerial = serial;
     mFocus = window;
+    mFocusSurfacePosition = window->surfacePosition(surface);
     mParent->mQDisplay->setLastInputDevice(mParent, serial, mFocus);
-    QPointF position(wl_fixed_to_double(x), wl_fixed_to_double(y));
+    QPointF position = QPointF(wl_fixed_to_double(x), wl_fixed_to_double(y)) + mFocusSurfacePosition;
     mParent->handleTouchPoint(id, QEventPoint::Pressed, position);
 }
 
@@ -1421,7 +1472,7 @@ void QWaylandInputDevice::Touch::touch_up(uint32_t serial, uint32_t time, int32_
 
 void QWaylandInputDevice::Touch::touch_motion(uint32_t time, int32_t id, wl_fixed_t x, wl_fixed_t y)
 {
-    QPointF position(wl_fixed_to_double(x), wl_fixed_to_double(y));
+    QPointF position = QPointF(wl_fixed_to_double(x), wl_fixed_to_double(y)) + mFocusSurfacePosition;
     mParent->mTime = time;
     mParent->handleTouchPoint(id, QEventPoint::Updated, position);
 }
@@ -37,6 +37,9 @@
 #include <QtCore/QElapsedTimer>
 #include <QtCore/QPointer>
 
+#include <array>
+#include <optional>
+
 #if QT_CONFIG(cursor)
 struct wl_cursor_image;
 #endif
@@ -206,6 +209,56 @@ inline uint32_t QWaylandInputDevice::serial() const
     return mSerial;
 }
 
+class QWaylandPointerEvent
+{
+    Q_GADGET
+public:
+    inline QWaylandPointerEvent(QEvent::Type type, Qt::ScrollPhase phase, QWaylandWindow *surface,
+                                ulong timestamp, const QPointF &localPos, const QPointF &globalPos,
+                                Qt::MouseButtons buttons, Qt::MouseButton button,
+                                Qt::KeyboardModifiers modifiers)
+        : type(type)
+        , phase(phase)
+        , timestamp(timestamp)
+        , local(localPos)
+        , global(globalPos)
+        , buttons(buttons)
+        , button(button)
+        , modifiers(modifiers)
+        , surface(surface)
+    {}
+    inline QWaylandPointerEvent(QEvent::Type type, Qt::ScrollPhase phase, QWaylandWindow *surface,
+                                ulong timestamp, const QPointF &local, const QPointF &global,
+                                const QPoint &pixelDelta, const QPoint &angleDelta,
+                                Qt::MouseEventSource source,
+                                Qt::KeyboardModifiers modifiers, bool inverted)
+        : type(type)
+        , phase(phase)
+        , timestamp(timestamp)
+        , local(local)
+        , global(global)
+        , modifiers(modifiers)
+        , pixelDelta(pixelDelta)
+        , angleDelta(angleDelta)
+        , source(source)
+        , surface(surface)
+        , inverted(inverted)
+    {}
+
+    QEvent::Type type = QEvent::None;
+    Qt::ScrollPhase phase = Qt::NoScrollPhase;
+    ulong timestamp = 0;
+    QPointF local;
+    QPointF global;
+    Qt::MouseButtons buttons;
+    Qt::MouseButton button = Qt::NoButton; // Button that caused the event (QMouseEvent::button)
+    Qt::KeyboardModifiers modifiers;
+    QPoint pixelDelta;
+    QPoint angleDelta;
+    Qt::MouseEventSource source = Qt::MouseEventNotSynthesized;
+    QPointer<QWaylandWindow> surface;
+    bool inverted = false;
+};
 
 class Q_WAYLANDCLIENT_EXPORT QWaylandInputDevice::Keyboard : public QObject, public QtWayland::wl_keyboard
 {
@@ -345,11 +398,13 @@ public:
 #endif
     QPointF mSurfacePos;
     QPointF mGlobalPos;
+    QPoint mFocusSurfacePosition; // of the entered surface in the focus window
     Qt::MouseButtons mButtons = Qt::NoButton;
     Qt::MouseButton mLastButton = Qt::NoButton;
 
     struct FrameData {
-        QWaylandPointerEvent *event = nullptr;
+        // Stored in place, a new event is started for every wl_pointer frame
+        std::optional<QWaylandPointerEvent> event;
 
         QPointF delta;
         QPoint delta120;
@@ -368,9 +423,28 @@ public:
     bool mScrollBeginSent = false;
     QPointF mScrollDeltaRemainder;
 
-    void setFrameEvent(QWaylandPointerEvent *event);
+    // Opt-in with QT_WAYLAND_COALESCE_POINTER_MOTION: consecutive motion frames are
+    // delivered as one event per pass of the event loop
+    bool mCoalesceMotion = false;
+    bool mCoalescedMotionFlushScheduled = false;
+    std::optional<QWaylandPointerEvent> mCoalescedMotion;
+
+    struct MotionSample {
+        ulong timestamp = 0;
+        QPointF local;
+        QPointF global;
+    };
+    // The latest motion of the focus window, including coalesced frames
+    std::array<MotionSample, 32> mMotionHistory;
+    qsizetype mMotionHistoryCount = 0;
+    qsizetype mMotionHistoryNext = 0;
+    QVariantList motionHistory() const;
+
+    void setFrameEvent(const QWaylandPointerEvent &event);
     void flushScrollEvent();
     void flushFrameEvent();
+    void flushCoalescedMotion();
+    void deliverFrameEvent(const QWaylandPointerEvent &event);
 private: //TODO: should other methods be private as well?
     bool isDefinitelyTerminated(axis_source source) const;
 };
@@ -404,60 +478,10 @@ public:
 
     QWaylandInputDevice *mParent = nullptr;
     QPointer<QWaylandWindow> mFocus;
+    QPoint mFocusSurfacePosition; // of the touched surface in the focus window
     QList<QWindowSystemInterface::TouchPoint> mPendingTouchPoints;
 };
 
-class QWaylandPointerEvent
-{
-    Q_GADGET
-public:
-    inline QWaylandPointerEvent(QEvent::Type type, Qt::ScrollPhase phase, QWaylandWindow *surface,
-                                ulong timestamp, const QPointF &localPos, const QPointF &globalPos,
-                                Qt::MouseButtons buttons, Qt::MouseButton button,
-                                Qt::KeyboardModifiers modifiers)
-        : type(type)
-        , phase(phase)
-        , timestamp(timestamp)
-        , local(localPos)
-        , global(globalPos)
-        , buttons(buttons)
-        , button(button)
-        , modifiers(modifiers)
-        , surface(surface)
-    {}
-    inline QWaylandPointerEvent(QEvent::Type type, Qt::ScrollPhase phase, QWaylandWindow *surface,
-                                ulong timestamp, const QPointF &local, const QPointF &global,
-                                const QPoint &pixelDelta, const QPoint &angleDelta,
-                                Qt::MouseEventSource source,
-                                Qt::KeyboardModifiers modifiers, bool inverted)
-        : type(type)
-        , phase(phase)
-        , timestamp(timestamp)
-        , local(local)
-        , global(global)
-        , modifiers(modifiers)
-        , pixelDelta(pixelDelta)
-        , angleDelta(angleDelta)
-        , source(source)
-        , surface(surface)
-        , inverted(inverted)
-    {}
-
-    QEvent::Type type = QEvent::None;
-    Qt::ScrollPhase phase = Qt::NoScrollPhase;
-    ulong timestamp = 0;
-    QPointF local;
-    QPointF global;
-    Qt::MouseButtons buttons;
-    Qt::MouseButton button = Qt::NoButton; // Button that caused the event (QMouseEvent::button)
-    Qt::KeyboardModifiers modifiers;
-    QPoint pixelDelta;
-    QPoint angleDelta;
-    Qt::MouseEventSource source = Qt::MouseEventNotSynthesized;
-    QPointer<QWaylandWindow> surface;
-    bool inverted = false;
-};
-
 #ifndef QT_NO_GESTURES
 class QWaylandPointerGestureSwipeEvent
 {
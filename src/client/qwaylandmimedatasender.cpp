@@ -0,0 +1,139 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qwaylandmimedatasender_p.h"
+#include "qwaylandmimehelper_p.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QSocketNotifier>
+#include <QtCore/QTimer>
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <fcntl.h>
+#include <signal.h>
+
+using namespace std::chrono_literals;
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWaylandClient {
+
+// A target that does not read anything for this long is given up on
+static constexpr auto WriteTimeout = 5s;
+
+// Ignores SIGPIPE while in scope, or clients may be forced to terminate
+// if the pipe is closed in the other end.
+class SigPipeIgnorer
+{
+public:
+    SigPipeIgnorer()
+    {
+        struct sigaction action;
+        action.sa_handler = SIG_IGN;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = 0;
+        sigaction(SIGPIPE, &action, &m_oldAction);
+    }
+    ~SigPipeIgnorer() { sigaction(SIGPIPE, &m_oldAction, nullptr); }
+
+private:
+    struct sigaction m_oldAction;
+};
+
+// Writes data to a file descriptor whenever it can take more, and deletes itself when done
+class QWaylandMimeDataTransfer : public QObject
+{
+public:
+    QWaylandMimeDataTransfer(int fd, const QByteArray &data, QObject *parent)
+        : QObject(parent)
+        , m_fd(fd)
+        , m_data(data)
+        , m_notifier(fd, QSocketNotifier::Write)
+    {
+        // Some compositors (e.g., mutter) already create the fd with O_NONBLOCK
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+        m_timeout.setSingleShot(true);
+        m_timeout.setInterval(WriteTimeout);
+        QObject::connect(&m_timeout, &QTimer::timeout, this, [this] {
+            qWarning("QWaylandMimeDataSender: timeout writing to pipe");
+            finish();
+        });
+        QObject::connect(&m_notifier, &QSocketNotifier::activated, this, [this] { writeAvailable(); });
+    }
+
+    ~QWaylandMimeDataTransfer() override
+    {
+        m_notifier.setEnabled(false);
+        if (m_fd != -1)
+            qt_safe_close(m_fd);
+    }
+
+    void writeAvailable()
+    {
+        SigPipeIgnorer sigPipeIgnorer;
+        while (m_written < m_data.size()) {
+            const qsizetype n = ::write(m_fd, m_data.constData() + m_written, m_data.size() - m_written);
+            if (n > 0) {
+                m_written += n;
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                m_timeout.start();
+                return;
+            } else {
+                break; // The target went away
+            }
+        }
+        finish();
+    }
+
+private:
+    void finish()
+    {
+        m_notifier.setEnabled(false);
+        m_timeout.stop();
+        qt_safe_close(std::exchange(m_fd, -1));
+        deleteLater();
+    }
+
+    int m_fd = -1;
+    QByteArray m_data;
+    qsizetype m_written = 0;
+    QSocketNotifier m_notifier;
+    QTimer m_timeout;
+};
+
+QWaylandMimeDataSender::QWaylandMimeDataSender(QMimeData *mimeData, QObject *parent)
+    : QObject(parent)
+    , m_mimeData(mimeData)
+{
+}
+
+QWaylandMimeDataSender::~QWaylandMimeDataSender()
+{
+    // Transfers in progress own a copy of their data, let them complete even
+    // if the selection changed in the meantime.
+    const QObjectList transfers = children();
+    for (QObject *transfer : transfers)
+        transfer->setParent(QCoreApplication::instance());
+}
+
+void QWaylandMimeDataSender::send(const QString &mimeType, int fd)
+{
+    auto it = m_cache.constFind(mimeType);
+    if (it == m_cache.constEnd())
+        it = m_cache.insert(mimeType, m_mimeData ? QWaylandMimeHelper::getByteArray(m_mimeData, mimeType) : QByteArray());
+
+    if (it->isEmpty()) {
+        qt_safe_close(fd);
+        return;
+    }
+
+    // Most payloads fit into the pipe right away, the rest is written from the event loop
+    (new QWaylandMimeDataTransfer(fd, *it, this))->writeAvailable();
+}
+
+}
+
+QT_END_NAMESPACE
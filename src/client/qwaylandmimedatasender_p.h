@@ -0,0 +1,56 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QWAYLANDMIMEDATASENDER_P_H
+#define QWAYLANDMIMEDATASENDER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtWaylandClient/private/qtwaylandclientglobal_p.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+
+QT_BEGIN_NAMESPACE
+
+class QMimeData;
+
+namespace QtWaylandClient {
+
+/*
+    Sends the contents of a QMimeData to the file descriptors handed out by
+    data sources (wl_data_source, zwp_primary_selection_source_v1 etc.).
+
+    The writes are non-blocking and driven by the event loop, so that a slowly
+    reading paste target does not stall the application, and any number of
+    transfers can run at the same time. The serialized data is cached per mime
+    type, as encoding e.g. an image can be expensive.
+*/
+class Q_WAYLANDCLIENT_EXPORT QWaylandMimeDataSender : public QObject
+{
+public:
+    explicit QWaylandMimeDataSender(QMimeData *mimeData, QObject *parent = nullptr);
+    ~QWaylandMimeDataSender() override;
+
+    // Takes ownership of fd
+    void send(const QString &mimeType, int fd);
+
+private:
+    QMimeData *m_mimeData = nullptr;
+    QHash<QString, QByteArray> m_cache;
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDMIMEDATASENDER_P_H
@@ -11,6 +11,9 @@
 #include "qwaylandwindowmanagerintegration_p.h"
 #include "qwaylandscreen_p.h"
 #include "qwaylandinputdevice_p.h"
+#if QT_CONFIG(clipboard)
+#include "qwaylandclipboard_p.h"
+#endif
 #include <QtCore/private/qnativeinterface_p.h>
 #include <QtGui/private/qguiapplication_p.h>
 #include <QtGui/QScreen>
@@ -190,6 +193,24 @@ void *QWaylandNativeInterface::nativeResourceForContext(const QByteArray &resour
 }
 #endif  // opengl
 
+/*
+    "retrieveClipboardDataAsync" is a QFuture<QByteArray> (*)(const QString &mimeType,
+    QClipboard::Mode mode) that receives the clipboard data without blocking the event
+    loop, for applications that can wait for it.
+*/
+QPlatformNativeInterface::NativeResourceForIntegrationFunction QWaylandNativeInterface::nativeResourceFunctionForIntegration(const QByteArray &resource)
+{
+    QByteArray lowerCaseResource = resource.toLower();
+
+#if QT_CONFIG(clipboard)
+    if (lowerCaseResource == "retrieveclipboarddataasync") {
+        return NativeResourceForIntegrationFunction(reinterpret_cast<void *>(retrieveClipboardDataAsync));
+    }
+#endif
+
+    return nullptr;
+}
+
 QPlatformNativeInterface::NativeResourceForWindowFunction QWaylandNativeInterface::nativeResourceFunctionForWindow(const QByteArray &resource)
 {
     QByteArray lowerCaseResource = resource.toLower();
@@ -210,18 +231,31 @@ QVariantMap QWaylandNativeInterface::windowProperties(QPlatformWindow *window) c
 QVariant QWaylandNativeInterface::windowProperty(QPlatformWindow *window, const QString &name) const
 {
     QWaylandWindow *waylandWindow = static_cast<QWaylandWindow *>(window);
+    if (name == QLatin1StringView("presentationFeedback"))
+        return waylandWindow->presentationFeedback();
+    if (name == QLatin1StringView("pointerMotionHistory"))
+        return waylandWindow->pointerMotionHistory();
     return waylandWindow->property(name);
 }
 
 QVariant QWaylandNativeInterface::windowProperty(QPlatformWindow *window, const QString &name, const QVariant &defaultValue) const
 {
     QWaylandWindow *waylandWindow = static_cast<QWaylandWindow *>(window);
+    if (name == QLatin1StringView("presentationFeedback"))
+        return waylandWindow->presentationFeedback();
+    if (name == QLatin1StringView("pointerMotionHistory"))
+        return waylandWindow->pointerMotionHistory();
     return waylandWindow->property(name, defaultValue);
 }
 
 void QWaylandNativeInterface::setWindowProperty(QPlatformWindow *window, const QString &name, const QVariant &value)
 {
     QWaylandWindow *wlWindow = static_cast<QWaylandWindow*>(window);
+    if (name == QLatin1StringView("solidColor")) {
+        if (wlWindow->setSolidColor(value.value<QColor>()))
+            wlWindow->setProperty(name, wlWindow->solidColor());
+        return;
+    }
     wlWindow->sendProperty(name, value);
 }
 
@@ -236,6 +270,14 @@ void QWaylandNativeInterface::setWindowMargins(QWindow *window, const QMargins &
     wlWindow->setCustomMargins(margins);
 }
 
+#if QT_CONFIG(clipboard)
+QFuture<QByteArray> QWaylandNativeInterface::retrieveClipboardDataAsync(const QString &mimeType, QClipboard::Mode mode)
+{
+    auto *integration = static_cast<QWaylandIntegration *>(QGuiApplicationPrivate::platformIntegration());
+    return static_cast<QWaylandClipboard *>(integration->clipboard())->retrieveDataAsync(mimeType, mode);
+}
+#endif
+
 }
 
 QT_END_NAMESPACE
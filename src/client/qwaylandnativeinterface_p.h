@@ -22,6 +22,9 @@
 #include <QtCore/private/qglobal_p.h>
 #include <QtCore/qhash.h>
 #include <QtGui/qguiapplication_platform.h>
+#if QT_CONFIG(clipboard)
+#include <QtGui/qclipboard.h>
+#endif
 
 QT_BEGIN_NAMESPACE
 
@@ -45,6 +48,7 @@ public:
 #if QT_CONFIG(opengl)
     void *nativeResourceForContext(const QByteArray &resource, QOpenGLContext *context) override;
 #endif
+    NativeResourceForIntegrationFunction nativeResourceFunctionForIntegration(const QByteArray &resource) override;
     NativeResourceForWindowFunction nativeResourceFunctionForWindow(const QByteArray &resource) override;
     QVariantMap windowProperties(QPlatformWindow *window) const override;
     QVariant windowProperty(QPlatformWindow *window, const QString &name) const override;
@@ -65,6 +69,9 @@ public:
 
 private:
     static void setWindowMargins(QWindow *window, const QMargins &margins);
+#if QT_CONFIG(clipboard)
+    static QFuture<QByteArray> retrieveClipboardDataAsync(const QString &mimeType, QClipboard::Mode mode);
+#endif
 
     QWaylandIntegration *m_integration = nullptr;
     QHash<QPlatformWindow*, QVariantMap> m_windowProperties;
@@ -0,0 +1,44 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qwaylandpresentation_p.h"
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWaylandClient {
+
+QWaylandPresentation::QWaylandPresentation(struct ::wl_registry *registry, uint32_t id, int version)
+    : QtWayland::wp_presentation(registry, id, version)
+{
+}
+
+QWaylandPresentation::~QWaylandPresentation()
+{
+    destroy();
+}
+
+qint64 QWaylandPresentation::currentTime() const
+{
+    timespec ts;
+    clock_gettime(mClockId, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+struct ::wp_presentation_feedback *QWaylandPresentation::createFeedback(struct ::wl_surface *surface, struct ::wl_event_queue *queue)
+{
+    // The events are delivered on the frame event queue, like frame callbacks
+    auto *wrapper = static_cast<struct ::wp_presentation *>(wl_proxy_create_wrapper(object()));
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy *>(wrapper), queue);
+    struct ::wp_presentation_feedback *feedback = wp_presentation_feedback(wrapper, surface);
+    wl_proxy_wrapper_destroy(wrapper);
+    return feedback;
+}
+
+void QWaylandPresentation::wp_presentation_clock_id(uint32_t clockId)
+{
+    mClockId = clockid_t(clockId);
+}
+
+}
+
+QT_END_NAMESPACE
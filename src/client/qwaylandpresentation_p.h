@@ -0,0 +1,50 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QWAYLANDPRESENTATION_P_H
+#define QWAYLANDPRESENTATION_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtWaylandClient/private/qwayland-presentation-time.h>
+#include <QtWaylandClient/qtwaylandclientglobal.h>
+
+#include <time.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QtWaylandClient {
+
+class QWaylandPresentation : public QtWayland::wp_presentation
+{
+public:
+    QWaylandPresentation(struct ::wl_registry *registry, uint32_t id, int version);
+    ~QWaylandPresentation() override;
+
+    // The current time in the clock presentation timestamps are given in, in nanoseconds
+    qint64 currentTime() const;
+
+    // Creates a feedback object for the next commit of surface, dispatched on queue
+    struct ::wp_presentation_feedback *createFeedback(struct ::wl_surface *surface, struct ::wl_event_queue *queue);
+
+protected:
+    void wp_presentation_clock_id(uint32_t clockId) override;
+
+private:
+    clockid_t mClockId = CLOCK_MONOTONIC;
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDPRESENTATION_P_H
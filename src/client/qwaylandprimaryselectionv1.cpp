@@ -4,7 +4,6 @@
 #include "qwaylandprimaryselectionv1_p.h"
 #include "qwaylandinputdevice_p.h"
 #include "qwaylanddisplay_p.h"
-#include "qwaylandmimehelper_p.h"
 
 #include <QtGui/private/qguiapplication_p.h>
 
@@ -100,6 +99,7 @@ void QWaylandPrimarySelectionDeviceV1::zwp_primary_selection_device_v1_selection
 QWaylandPrimarySelectionSourceV1::QWaylandPrimarySelectionSourceV1(QWaylandPrimarySelectionDeviceManagerV1 *manager, QMimeData *mimeData)
     : QtWayland::zwp_primary_selection_source_v1(manager->create_source())
     , m_mimeData(mimeData)
+    , m_sender(mimeData)
 {
     if (!mimeData)
         return;
@@ -114,21 +114,7 @@ QWaylandPrimarySelectionSourceV1::~QWaylandPrimarySelectionSourceV1()
 
 void QWaylandPrimarySelectionSourceV1::zwp_primary_selection_source_v1_send(const QString &mime_type, int32_t fd)
 {
-    QByteArray content = QWaylandMimeHelper::getByteArray(m_mimeData, mime_type);
-    if (!content.isEmpty()) {
-        // Create a sigpipe handler that does nothing, or clients may be forced to terminate
-        // if the pipe is closed in the other end.
-        struct sigaction action, oldAction;
-        action.sa_handler = SIG_IGN;
-        sigemptyset (&action.sa_mask);
-        action.sa_flags = 0;
-
-        sigaction(SIGPIPE, &action, &oldAction);
-        ssize_t unused = write(fd, content.constData(), size_t(content.size()));
-        Q_UNUSED(unused);
-        sigaction(SIGPIPE, &oldAction, nullptr);
-    }
-    close(fd);
+    m_sender.send(mime_type, fd);
 }
 
 } // namespace QtWaylandClient
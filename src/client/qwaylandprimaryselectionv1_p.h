@@ -19,6 +19,7 @@
 
 #include <QtWaylandClient/private/qtwaylandclientglobal_p.h>
 #include <QtWaylandClient/private/qwaylanddataoffer_p.h>
+#include <QtWaylandClient/private/qwaylandmimedatasender_p.h>
 
 #include <QtCore/QObject>
 
@@ -79,6 +80,7 @@ protected:
 
 private:
     QMimeData *m_mimeData = nullptr;
+    QWaylandMimeDataSender m_sender;
 };
 
 class QWaylandPrimarySelectionDeviceV1 : public QObject, public QtWayland::zwp_primary_selection_device_v1
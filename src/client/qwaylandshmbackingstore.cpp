@@ -11,7 +11,6 @@
 #include <QtCore/qstandardpaths.h>
 #include <QtCore/qtemporaryfile.h>
 #include <QtGui/QPainter>
-#include <QtGui/QTransform>
 #include <QMutexLocker>
 
 #include <QtWaylandClient/private/wayland-wayland-client-protocol.h>
@@ -45,12 +44,8 @@ QT_BEGIN_NAMESPACE
 
 namespace QtWaylandClient {
 
-QWaylandShmBuffer::QWaylandShmBuffer(QWaylandDisplay *display,
-                     const QSize &size, QImage::Format format, qreal scale)
-    : mDirtyRegion(QRect(QPoint(0, 0), size / scale))
+static QFile *createShmFile()
 {
-    int stride = size.width() * 4;
-    int alloc = stride * size.height();
     int fd = -1;
 
 #ifdef SYS_memfd_create
@@ -59,24 +54,176 @@ QWaylandShmBuffer::QWaylandShmBuffer(QWaylandDisplay *display,
         fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL);
 #endif
 
-    QScopedPointer<QFile> filePointer;
-
     if (fd == -1) {
         auto tmpFile = new QTemporaryFile (QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation) +
                                        QLatin1String("/wayland-shm-XXXXXX"));
         tmpFile->open();
-        filePointer.reset(tmpFile);
-    } else {
-        auto file = new QFile;
-        file->open(fd, QIODevice::ReadWrite | QIODevice::Unbuffered, QFile::AutoCloseHandle);
-        filePointer.reset(file);
+        return tmpFile;
+    }
+
+    auto file = new QFile;
+    file->open(fd, QIODevice::ReadWrite | QIODevice::Unbuffered, QFile::AutoCloseHandle);
+    return file;
+}
+
+/*
+    A wl_shm_pool that buffers are sub-allocated from, so that creating a buffer
+    does not need a new file, mapping and pool every time.
+
+    The whole \a reservedSize is mapped up front, even though the file only grows
+    on demand, so that the addresses of existing buffers stay valid when the pool
+    grows with wl_shm_pool.resize. The memory of released blocks is given back to
+    the system, so that the pool only holds on to what buffers actually use.
+*/
+QWaylandShmPool::QWaylandShmPool(QWaylandDisplay *display, qsizetype reservedSize)
+    : mFile(createShmFile())
+{
+    if (!mFile->isOpen()) {
+        qWarning("QWaylandShmPool: failed: %s", qUtf8Printable(mFile->errorString()));
+        return;
     }
+
+    mReservedSize = reservedSize;
+    mData = static_cast<uchar *>(mmap(nullptr, mReservedSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                      mFile->handle(), 0));
+    if (mData == static_cast<uchar *>(MAP_FAILED)) {
+        qErrnoWarning("QWaylandShmPool: mmap failed");
+        mData = nullptr;
+        return;
+    }
+
+    // wl_shm_create_pool requires a non-empty pool
+    static const qsizetype initialSize = 4096;
+    if (!mFile->resize(initialSize)) {
+        qWarning("QWaylandShmPool: failed: %s", qUtf8Printable(mFile->errorString()));
+        return;
+    }
+    mSize = initialSize;
+    mPool = wl_shm_create_pool(display->shm()->object(), mFile->handle(), mSize);
+}
+
+QWaylandShmPool::~QWaylandShmPool()
+{
+    if (mPool)
+        wl_shm_pool_destroy(mPool);
+    if (mData)
+        munmap(mData, mReservedSize);
+}
+
+bool QWaylandShmPool::grow(qsizetype size)
+{
+    // NOTE beginPaint assumes a new buffer be all zeroes, which QFile::resize does.
+    if (!mFile->resize(size)) {
+        qWarning("QWaylandShmPool: failed to grow: %s", qUtf8Printable(mFile->errorString()));
+        return false;
+    }
+    mSize = size;
+    wl_shm_pool_resize(mPool, mSize);
+    return true;
+}
+
+/*
+    Returns the offset of a block of at least \a size bytes in the pool, or -1 if
+    the pool cannot hold it. \a recycled is set if the block has been used by an
+    earlier buffer, i.e. if it is not cleared.
+*/
+qsizetype QWaylandShmPool::allocate(qsizetype size, bool *recycled)
+{
+    static const qsizetype alignment = 4096;
+    size = (size + alignment - 1) & ~(alignment - 1);
+
+    // Best fit among the blocks of released buffers, so large blocks stay available
+    auto best = mFreeBlocks.end();
+    for (auto it = mFreeBlocks.begin(); it != mFreeBlocks.end(); ++it) {
+        if (it->second >= size && (best == mFreeBlocks.end() || it->second < best->second))
+            best = it;
+    }
+    if (best != mFreeBlocks.end()) {
+        const qsizetype offset = best->first;
+        const qsizetype remaining = best->second - size;
+        mFreeBlocks.erase(best);
+        if (remaining > 0)
+            mFreeBlocks.emplace(offset + size, remaining);
+        mUsedBlocks.emplace(offset, size);
+        *recycled = !mFreeBlocksCleared;
+        return offset;
+    }
+
+    // Otherwise take memory that was never handed out, growing the pool if needed
+    if (mUnusedOffset + size > mReservedSize)
+        return -1;
+    if (mUnusedOffset + size > mSize) {
+        const qsizetype newSize = qMin(mReservedSize, qMax(mUnusedOffset + size, mSize + mSize / 2));
+        if (!grow(newSize))
+            return -1;
+    }
+    const qsizetype offset = mUnusedOffset;
+    mUnusedOffset += size;
+    mUsedBlocks.emplace(offset, size);
+    *recycled = false;
+    return offset;
+}
+
+void QWaylandShmPool::release(qsizetype offset)
+{
+    auto used = mUsedBlocks.find(offset);
+    Q_ASSERT(used != mUsedBlocks.end());
+    qsizetype size = used->second;
+    mUsedBlocks.erase(used);
+
+    // Released blocks read as zeroes, unless the system could not take the memory back
+    if (mFreeBlocksCleared && !releaseMemory(offset, size))
+        mFreeBlocksCleared = false;
+
+    // Merge with the neighboring free blocks
+    auto next = mFreeBlocks.lower_bound(offset);
+    if (next != mFreeBlocks.end() && next->first == offset + size) {
+        size += next->second;
+        next = mFreeBlocks.erase(next);
+    }
+    if (next != mFreeBlocks.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            offset = previous->first;
+            size += previous->second;
+            mFreeBlocks.erase(previous);
+        }
+    }
+
+    // Memory that was never handed out is expected to be clear
+    if (offset + size == mUnusedOffset && mFreeBlocksCleared)
+        mUnusedOffset = offset;
+    else
+        mFreeBlocks.emplace(offset, size);
+}
+
+bool QWaylandShmPool::releaseMemory(qsizetype offset, qsizetype size)
+{
+#if defined(FALLOC_FL_PUNCH_HOLE) && defined(FALLOC_FL_KEEP_SIZE)
+    if (fallocate(mFile->handle(), FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, size) == 0)
+        return true;
+#endif
+#ifdef MADV_REMOVE
+    if (madvise(mData + offset, size, MADV_REMOVE) == 0)
+        return true;
+#endif
+    return false;
+}
+
+QWaylandShmBuffer::QWaylandShmBuffer(QWaylandDisplay *display,
+                     const QSize &size, QImage::Format format, qreal scale)
+    : mDirtyRegion(QRect(QPoint(0, 0), size / scale))
+{
+    int stride = size.width() * 4;
+    int alloc = stride * size.height();
+
+    QScopedPointer<QFile> filePointer(createShmFile());
     // NOTE beginPaint assumes a new buffer be all zeroes, which QFile::resize does.
     if (!filePointer->isOpen() || !filePointer->resize(alloc)) {
         qWarning("QWaylandShmBuffer: failed: %s", qUtf8Printable(filePointer->errorString()));
         return;
     }
-    fd = filePointer->handle();
+    int fd = filePointer->handle();
 
     // map ourselves: QFile::map() will unmap when the object is destroyed,
     // but we want this mapping to persist (unmapping in destructor)
@@ -97,13 +244,61 @@ QWaylandShmBuffer::QWaylandShmBuffer(QWaylandDisplay *display,
                                        stride, wl_format));
 }
 
+/*
+    Creates a buffer inside \a pool, which must outlive the buffer. If the pool
+    cannot hold the buffer, the buffer is left without an image.
+*/
+QWaylandShmBuffer::QWaylandShmBuffer(QWaylandDisplay *display, QWaylandShmPool *pool,
+                                     const QSize &size, QImage::Format format, qreal scale)
+    : mDirtyRegion(QRect(QPoint(0, 0), size / scale))
+{
+    int stride = size.width() * 4;
+    int alloc = stride * size.height();
+
+    bool recycled = false;
+    const qsizetype offset = pool->allocate(alloc, &recycled);
+    if (offset < 0)
+        return;
+    mPool = pool;
+    mPoolOffset = offset;
+
+    uchar *data = pool->data() + offset;
+    // NOTE beginPaint assumes a new buffer be all zeroes, only fresh pool memory is.
+    if (recycled)
+        memset(data, 0, alloc);
+
+    wl_shm_format wl_format = display->shm()->formatFrom(format);
+    mImage = QImage(data, size.width(), size.height(), stride, format);
+    mImage.setDevicePixelRatio(scale);
+
+    init(wl_shm_pool_create_buffer(pool->object(), offset, size.width(), size.height(),
+                                   stride, wl_format));
+}
+
+/*
+    Creates a buffer in ordinary memory that can be painted into but not be
+    attached to a surface, its contents must be copied into a shm buffer first.
+*/
+QWaylandShmBuffer::QWaylandShmBuffer(const QSize &size, QImage::Format format, qreal scale)
+    : mImage(size, format)
+    , mDirtyRegion(QRect(QPoint(0, 0), size / scale))
+{
+    // NOTE beginPaint assumes a new buffer be all zeroes
+    mImage.fill(0);
+    mImage.setDevicePixelRatio(scale);
+}
+
 QWaylandShmBuffer::~QWaylandShmBuffer(void)
 {
     delete mMarginsImage;
-    if (mImage.constBits())
+    if (mPool) {
+        mPool->release(mPoolOffset);
+        return;
+    }
+    if (mShmPool) {
         munmap((void *) mImage.constBits(), mImage.sizeInBytes());
-    if (mShmPool)
         wl_shm_pool_destroy(mShmPool);
+    }
 }
 
 QImage *QWaylandShmBuffer::imageInsideMargins(const QMargins &marginsIn)
@@ -138,13 +333,23 @@ QWaylandShmBackingStore::QWaylandShmBackingStore(QWindow *window, QWaylandDispla
     : QPlatformBackingStore(window)
     , mDisplay(display)
 {
+    const int maxBuffers = qEnvironmentVariableIntValue("QT_WAYLAND_SHM_MAX_BUFFERS");
+    if (maxBuffers > 0)
+        mMaxBuffers = size_t(maxBuffers);
+    mNonBlocking = qEnvironmentVariableIntValue("QT_WAYLAND_SHM_NONBLOCKING") != 0;
+
     QObject::connect(mDisplay, &QWaylandDisplay::connected, window, [this]() {
         auto copy = mBuffers;
+        // The old buffers still live in the old pool, which belongs to the old connection
+        std::unique_ptr<QWaylandShmPool> oldPool = std::move(mPool);
         // clear available buffers so we create new ones
         // actual deletion is deferred till after resize call so we can copy
         // contents from the back buffer
         mBuffers.clear();
         mFrontBuffer = nullptr;
+        // the deferred buffer may still be needed as copy source as well
+        std::unique_ptr<QWaylandShmBuffer> oldDeferredBuffer = std::move(mDeferredBuffer);
+        mDeferredRegion = QRegion();
         // recreateBackBufferIfNeeded always resets mBackBuffer
         if (mRequestedSize.isValid() && waylandWindow())
             recreateBackBufferIfNeeded();
@@ -160,7 +365,10 @@ QWaylandShmBackingStore::~QWaylandShmBackingStore()
 //    if (mFrontBuffer == waylandWindow()->attached())
 //        waylandWindow()->attach(0);
 
+    // Buffers return their memory to the pool, so they must go first
     qDeleteAll(mBuffers);
+    mDeferredBuffer.reset();
+    mPool.reset();
 }
 
 QPaintDevice *QWaylandShmBackingStore::paintDevice()
@@ -176,6 +384,8 @@ void QWaylandShmBackingStore::updateDirtyStates(const QRegion &region)
         if (b != mBackBuffer)
             b->dirtyRegion() += region;
     }
+    if (mDeferredBuffer && mDeferredBuffer.get() != mBackBuffer)
+        mDeferredBuffer->dirtyRegion() += region;
 }
 
 void QWaylandShmBackingStore::beginPaint(const QRegion &region)
@@ -238,12 +448,45 @@ void QWaylandShmBackingStore::flush(QWindow *window, const QRegion &region, cons
     if (windowDecoration() && windowDecoration()->isDirty())
         updateDecorations();
 
+    QMargins margins = windowDecorationMargins();
+
+    // The deferred buffer cannot be attached, it is committed once a buffer was released
+    if (mBackBuffer == mDeferredBuffer.get()) {
+        mDeferredRegion |= region.translated(margins.left(), margins.top());
+        flushDeferred();
+        return;
+    }
+
     mFrontBuffer = mBackBuffer;
 
-    QMargins margins = windowDecorationMargins();
     waylandWindow()->safeCommit(mFrontBuffer, region.translated(margins.left(), margins.top()));
 }
 
+void QWaylandShmBackingStore::flushDeferred()
+{
+    if (mPainting || mDeferredRegion.isEmpty() || mBackBuffer != mDeferredBuffer.get() || !waylandWindow())
+        return;
+
+    bool bufferWasRecreated = false;
+    QWaylandShmBuffer *buffer = getBuffer(mDeferredBuffer->size(), bufferWasRecreated);
+    if (!buffer)
+        return;
+
+    qCDebug(lcWaylandBackingstore, "QWaylandShmBackingStore: committing deferred contents");
+
+    copyDirtyContents(mDeferredBuffer.get(), buffer);
+    buffer->dirtyRegion() = QRegion();
+
+    mBackBuffer = buffer;
+    mFrontBuffer = buffer;
+    if (mBuffers.front() != buffer) {
+        mBuffers.remove(buffer);
+        mBuffers.push_front(buffer);
+    }
+
+    waylandWindow()->safeCommit(buffer, std::exchange(mDeferredRegion, QRegion()));
+}
+
 void QWaylandShmBackingStore::resize(const QSize &size, const QRegion &)
 {
     mRequestedSize = size;
@@ -267,10 +510,10 @@ QWaylandShmBuffer *QWaylandShmBackingStore::getBuffer(const QSize &size, bool &b
         }
     }
 
-    static const size_t MAX_BUFFERS = 5;
-    if (mBuffers.size() < MAX_BUFFERS) {
+    if (mBuffers.size() < mMaxBuffers) {
         QImage::Format format = QPlatformScreen::platformScreenForWindow(window())->format();
-        QWaylandShmBuffer *b = new QWaylandShmBuffer(mDisplay, size, format, waylandWindow()->scale());
+        QWaylandShmBuffer *b = createBuffer(size, format);
+        b->setReleaseCallback([this] { flushDeferred(); });
         bufferWasRecreated = true;
         mBuffers.push_front(b);
         return b;
@@ -278,6 +521,73 @@ QWaylandShmBuffer *QWaylandShmBackingStore::getBuffer(const QSize &size, bool &b
     return nullptr;
 }
 
+QWaylandShmBuffer *QWaylandShmBackingStore::createBuffer(const QSize &size, QImage::Format format)
+{
+    const qsizetype bufferSize = qsizetype(size.width()) * 4 * size.height();
+    // Only address space is reserved, memory is allocated as the pool grows. Keep room
+    // for all buffers at up to twice the size, to grow into during interactive resizing.
+    static const qsizetype pageSize = 4096;
+    const qsizetype reservedSize = qsizetype(mMaxBuffers) * 2 * (bufferSize + pageSize);
+
+    // Start over with a pool that fits the window once the old one is no longer used
+    if (mPool && mPool->isEmpty()
+        && (mPool->reservedSize() < reservedSize || mPool->reservedSize() > 4 * reservedSize)) {
+        mPool.reset();
+    }
+
+    if (!mPool) {
+        mPool.reset(new QWaylandShmPool(mDisplay, reservedSize));
+        if (!mPool->isValid())
+            mPool.reset();
+    }
+
+    if (mPool) {
+        auto *buffer = new QWaylandShmBuffer(mDisplay, mPool.get(), size, format, waylandWindow()->scale());
+        if (buffer->buffer())
+            return buffer;
+        delete buffer;
+    }
+
+    // The pool is exhausted, fall back to a buffer with its own pool
+    return new QWaylandShmBuffer(mDisplay, size, format, waylandWindow()->scale());
+}
+
+QWaylandShmBuffer *QWaylandShmBackingStore::deferredBuffer(const QSize &size, bool &bufferWasRecreated)
+{
+    bufferWasRecreated = false;
+    if (!mDeferredBuffer || mDeferredBuffer->size() != size) {
+        if (mBackBuffer == mDeferredBuffer.get())
+            mBackBuffer = nullptr;
+        QImage::Format format = QPlatformScreen::platformScreenForWindow(window())->format();
+        mDeferredBuffer.reset(new QWaylandShmBuffer(size, format, waylandWindow()->scale()));
+        mDeferredRegion = QRegion();
+        bufferWasRecreated = true;
+    }
+    return mDeferredBuffer.get();
+}
+
+void QWaylandShmBackingStore::copyDirtyContents(QWaylandShmBuffer *source, QWaylandShmBuffer *target)
+{
+    const QImage *sourceImage = source->image();
+    QImage *targetImage = target->image();
+
+    QPainter painter(targetImage);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+
+    // Let painter operate in device pixels, to make it easier to compare coordinates
+    const qreal sourceDevicePixelRatio = sourceImage->devicePixelRatio();
+    const qreal targetDevicePixelRatio = painter.device()->devicePixelRatio();
+    painter.scale(1.0 / targetDevicePixelRatio, 1.0 / targetDevicePixelRatio);
+
+    for (const QRect &rect : target->dirtyRegion()) {
+        QRectF sourceRect(QPointF(rect.topLeft()) * sourceDevicePixelRatio,
+                          QSizeF(rect.size()) * sourceDevicePixelRatio);
+        QRectF targetRect(QPointF(rect.topLeft()) * targetDevicePixelRatio,
+                          QSizeF(rect.size()) * targetDevicePixelRatio);
+        painter.drawImage(targetRect, *sourceImage, sourceRect);
+    }
+}
+
 bool QWaylandShmBackingStore::recreateBackBufferIfNeeded()
 {
     bool bufferWasRecreated = false;
@@ -294,6 +604,11 @@ bool QWaylandShmBackingStore::recreateBackBufferIfNeeded()
     // pixman renderer. With the gl renderer release events are sent early so we can effectively
     // run single buffered, while with the pixman renderer we have to use two.
     QWaylandShmBuffer *buffer = getBuffer(sizeWithMargins, bufferWasRecreated);
+
+    // Rather than stalling, paint into memory and commit once the compositor released a buffer
+    if (!buffer && mNonBlocking)
+        buffer = deferredBuffer(sizeWithMargins, bufferWasRecreated);
+
     while (!buffer) {
         qCDebug(lcWaylandBackingstore, "QWaylandShmBackingStore: stalling waiting for a buffer to be released from the compositor...");
 
@@ -307,31 +622,14 @@ bool QWaylandShmBackingStore::recreateBackBufferIfNeeded()
     // mBackBuffer may have been deleted here but if so it means its size was different so we wouldn't copy it anyway
     if (mBackBuffer != buffer && oldSizeInBytes == newSizeInBytes) {
         Q_ASSERT(mBackBuffer);
-        const QImage *sourceImage = mBackBuffer->image();
-        QImage *targetImage = buffer->image();
-
-        QPainter painter(targetImage);
-        painter.setCompositionMode(QPainter::CompositionMode_Source);
-
-        // Let painter operate in device pixels, to make it easier to compare coordinates
-        const qreal sourceDevicePixelRatio = sourceImage->devicePixelRatio();
-        const qreal targetDevicePixelRatio = painter.device()->devicePixelRatio();
-        painter.scale(1.0 / targetDevicePixelRatio, 1.0 / targetDevicePixelRatio);
-
-        for (const QRect &rect : buffer->dirtyRegion()) {
-            QRectF sourceRect(QPointF(rect.topLeft()) * sourceDevicePixelRatio,
-                              QSizeF(rect.size()) * sourceDevicePixelRatio);
-            QRectF targetRect(QPointF(rect.topLeft()) * targetDevicePixelRatio,
-                              QSizeF(rect.size()) * targetDevicePixelRatio);
-            painter.drawImage(targetRect, *sourceImage, sourceRect);
-        }
+        copyDirtyContents(mBackBuffer, buffer);
     }
 
     mBackBuffer = buffer;
 
     // ensure the new buffer is at the beginning of the list so next time getBuffer() will pick
     // it if possible
-    if (mBuffers.front() != buffer) {
+    if (buffer != mDeferredBuffer.get() && mBuffers.front() != buffer) {
         mBuffers.remove(buffer);
         mBuffers.push_front(buffer);
     }
@@ -358,49 +656,19 @@ void QWaylandShmBackingStore::updateDecorations()
 {
     QPainter decorationPainter(entireSurface());
     decorationPainter.setCompositionMode(QPainter::CompositionMode_Source);
-    QImage sourceImage = windowDecoration()->contentImage();
-
-    qreal dp = sourceImage.devicePixelRatio();
-    int dpWidth = int(sourceImage.width() / dp);
-    int dpHeight = int(sourceImage.height() / dp);
-    QTransform sourceMatrix;
-    sourceMatrix.scale(dp, dp);
-    QRect target; // needs to be in device independent pixels
-    QRegion dirtyRegion;
-
-    //Top
-    target.setX(0);
-    target.setY(0);
-    target.setWidth(dpWidth);
-    target.setHeight(windowDecorationMargins().top());
-    decorationPainter.drawImage(target, sourceImage, sourceMatrix.mapRect(target));
-    dirtyRegion += target;
-
-    //Left
-    target.setWidth(windowDecorationMargins().left());
-    target.setHeight(dpHeight);
-    decorationPainter.drawImage(target, sourceImage, sourceMatrix.mapRect(target));
-    dirtyRegion += target;
-
-    //Right
-    target.setX(dpWidth - windowDecorationMargins().right());
-    target.setWidth(windowDecorationMargins().right());
-    decorationPainter.drawImage(target, sourceImage, sourceMatrix.mapRect(target));
-    dirtyRegion += target;
-
-    //Bottom
-    target.setX(0);
-    target.setY(dpHeight - windowDecorationMargins().bottom());
-    target.setWidth(dpWidth);
-    target.setHeight(windowDecorationMargins().bottom());
-    decorationPainter.drawImage(target, sourceImage, sourceMatrix.mapRect(target));
-    dirtyRegion += target;
+    const QRegion dirtyRegion = windowDecoration()->paintDirtyMargins(&decorationPainter);
+    decorationPainter.end();
 
+    for (const QRect &rect : dirtyRegion)
+        waylandWindow()->damage(rect);
     updateDirtyStates(dirtyRegion);
 }
 
 QWaylandAbstractDecoration *QWaylandShmBackingStore::windowDecoration() const
 {
+    // A decoration in its own subsurface is not part of the backing store's buffers
+    if (waylandWindow()->hasDecorationSurface())
+        return nullptr;
     return waylandWindow()->decoration();
 }
 
@@ -23,19 +23,57 @@
 #include <QMutex>
 
 #include <list>
+#include <map>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
+class QFile;
+
 namespace QtWaylandClient {
 
 class QWaylandDisplay;
 class QWaylandAbstractDecoration;
 class QWaylandWindow;
 
+class QWaylandShmPool {
+public:
+    QWaylandShmPool(QWaylandDisplay *display, qsizetype reservedSize);
+    ~QWaylandShmPool();
+
+    bool isValid() const { return mPool; }
+    bool isEmpty() const { return mUsedBlocks.empty(); }
+    qsizetype size() const { return mSize; }
+    qsizetype reservedSize() const { return mReservedSize; }
+
+    qsizetype allocate(qsizetype size, bool *recycled);
+    void release(qsizetype offset);
+
+    uchar *data() const { return mData; }
+    struct wl_shm_pool *object() const { return mPool; }
+
+private:
+    bool grow(qsizetype size);
+    bool releaseMemory(qsizetype offset, qsizetype size);
+
+    QScopedPointer<QFile> mFile;
+    uchar *mData = nullptr;
+    qsizetype mReservedSize = 0;
+    qsizetype mSize = 0;
+    qsizetype mUnusedOffset = 0;
+    struct wl_shm_pool *mPool = nullptr;
+    bool mFreeBlocksCleared = true;
+    std::map<qsizetype, qsizetype> mFreeBlocks; // offset -> size
+    std::map<qsizetype, qsizetype> mUsedBlocks; // offset -> size
+};
+
 class Q_WAYLANDCLIENT_EXPORT QWaylandShmBuffer : public QWaylandBuffer {
 public:
     QWaylandShmBuffer(QWaylandDisplay *display,
            const QSize &size, QImage::Format format, qreal scale = 1);
+    QWaylandShmBuffer(QWaylandDisplay *display, QWaylandShmPool *pool,
+           const QSize &size, QImage::Format format, qreal scale = 1);
+    QWaylandShmBuffer(const QSize &size, QImage::Format format, qreal scale = 1);
     ~QWaylandShmBuffer() override;
     QSize size() const override { return mImage.size(); }
     int scale() const override { return int(mImage.devicePixelRatio()); }
@@ -47,6 +85,8 @@ public:
 private:
     QImage mImage;
     struct wl_shm_pool *mShmPool = nullptr;
+    QWaylandShmPool *mPool = nullptr;
+    qsizetype mPoolOffset = -1;
     QMargins mMargins;
     QImage *mMarginsImage = nullptr;
     QRegion mDirtyRegion;
@@ -82,14 +122,25 @@ private:
     void updateDirtyStates(const QRegion &region);
     void updateDecorations();
     QWaylandShmBuffer *getBuffer(const QSize &size, bool &bufferWasRecreated);
+    QWaylandShmBuffer *createBuffer(const QSize &size, QImage::Format format);
+    QWaylandShmBuffer *deferredBuffer(const QSize &size, bool &bufferWasRecreated);
+    void copyDirtyContents(QWaylandShmBuffer *source, QWaylandShmBuffer *target);
+    void flushDeferred();
 
     QWaylandDisplay *mDisplay = nullptr;
+    std::unique_ptr<QWaylandShmPool> mPool;
     std::list<QWaylandShmBuffer *> mBuffers;
     QWaylandShmBuffer *mFrontBuffer = nullptr;
     QWaylandShmBuffer *mBackBuffer = nullptr;
     bool mPainting = false;
     bool mPendingFlush = false;
     QRegion mPendingRegion;
+
+    // Painted into when all buffers are busy in non-blocking mode, committed on release
+    std::unique_ptr<QWaylandShmBuffer> mDeferredBuffer;
+    QRegion mDeferredRegion;
+    size_t mMaxBuffers = 5;
+    bool mNonBlocking = false;
     QMutex mMutex;
 
     QSize mRequestedSize;
@@ -462,6 +462,10 @@ void QWaylandTabletToolV2::zwp_tablet_tool_v2_up()
 void QWaylandTabletToolV2::zwp_tablet_tool_v2_motion(wl_fixed_t x, wl_fixed_t y)
 {
     m_pending.surfacePosition = QPointF(wl_fixed_to_double(x), wl_fixed_to_double(y));
+    if (m_pending.proximitySurface) {
+        if (QWaylandWindow *window = m_pending.proximitySurface->waylandWindow())
+            m_pending.surfacePosition += window->surfacePosition(m_pending.proximitySurface->object());
+    }
 }
 
 void QWaylandTabletToolV2::zwp_tablet_tool_v2_pressure(uint32_t pressure)
@@ -129,7 +129,7 @@ void QWaylandTextInputv1::updateState(Qt::InputMethodQueries queries, uint32_t f
         const QRect &cRect = event.value(Qt::ImCursorRectangle).toRect();
         const QRect &windowRect = QGuiApplication::inputMethod()->inputItemTransform().mapRect(cRect);
         const QRect &nativeRect = QHighDpi::toNativePixels(windowRect, QGuiApplication::focusWindow());
-        const QMargins margins = window->clientSideMargins();
+        const QMargins margins = window->bufferMargins();
         const QRect &surfaceRect = nativeRect.translated(margins.left(), margins.top());
         set_cursor_rectangle(surfaceRect.x(), surfaceRect.y(), surfaceRect.width(), surfaceRect.height());
     }
@@ -72,26 +72,26 @@ void QWaylandTextInputv3::zwp_text_input_v3_leave(struct ::wl_surface *surface)
     qCDebug(qLcQpaWaylandTextInput) << Q_FUNC_INFO << "Done";
 }
 
-void QWaylandTextInputv3::zwp_text_input_v3_preedit_string(const QString &text, int32_t cursorBegin, int32_t cursorEnd)
+void QWaylandTextInputv3::zwp_text_input_v3_preedit_string(QUtf8StringView text, int32_t cursorBegin, int32_t cursorEnd)
 {
     qCDebug(qLcQpaWaylandTextInput) << Q_FUNC_INFO << text << cursorBegin << cursorEnd;
 
     if (!QGuiApplication::focusObject())
         return;
 
-    m_pendingPreeditString.text = text;
+    m_pendingPreeditString.text = text.toString();
     m_pendingPreeditString.cursorBegin = QWaylandInputMethodEventBuilder::indexFromWayland(text, cursorBegin);
     m_pendingPreeditString.cursorEnd = QWaylandInputMethodEventBuilder::indexFromWayland(text, cursorEnd);
 }
 
-void QWaylandTextInputv3::zwp_text_input_v3_commit_string(const QString &text)
+void QWaylandTextInputv3::zwp_text_input_v3_commit_string(QUtf8StringView text)
 {
     qCDebug(qLcQpaWaylandTextInput) << Q_FUNC_INFO << text;
 
     if (!QGuiApplication::focusObject())
         return;
 
-    m_pendingCommitString = text;
+    m_pendingCommitString = text.toString();
 }
 
 void QWaylandTextInputv3::zwp_text_input_v3_delete_surrounding_text(uint32_t beforeText, uint32_t afterText)
@@ -241,7 +241,7 @@ void QWaylandTextInputv3::updateState(Qt::InputMethodQueries queries, uint32_t f
         const QRect &cRect = event.value(Qt::ImCursorRectangle).toRect();
         const QRect &windowRect = QGuiApplication::inputMethod()->inputItemTransform().mapRect(cRect);
         const QRect &nativeRect = QHighDpi::toNativePixels(windowRect, QGuiApplication::focusWindow());
-        const QMargins margins = window->clientSideMargins();
+        const QMargins margins = window->bufferMargins();
         const QRect &surfaceRect = nativeRect.translated(margins.left(), margins.top());
         if (surfaceRect != m_cursorRect) {
             set_cursor_rectangle(surfaceRect.x(), surfaceRect.y(), surfaceRect.width(), surfaceRect.height());
@@ -56,8 +56,8 @@ public:
 protected:
     void zwp_text_input_v3_enter(struct ::wl_surface *surface) override;
     void zwp_text_input_v3_leave(struct ::wl_surface *surface) override;
-    void zwp_text_input_v3_preedit_string(const QString &text, int32_t cursor_begin, int32_t cursor_end) override;
-    void zwp_text_input_v3_commit_string(const QString &text) override;
+    void zwp_text_input_v3_preedit_string(QUtf8StringView text, int32_t cursor_begin, int32_t cursor_end) override;
+    void zwp_text_input_v3_commit_string(QUtf8StringView text) override;
     void zwp_text_input_v3_delete_surrounding_text(uint32_t before_length, uint32_t after_length) override;
     void zwp_text_input_v3_done(uint32_t serial) override;
 
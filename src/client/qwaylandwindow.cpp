@@ -18,10 +18,13 @@
 #include "qwaylandshmbackingstore_p.h"
 #include "qwaylandshellintegration_p.h"
 #include "qwaylandviewport_p.h"
+#include "qwaylanddecorationsurface_p.h"
+#include "qwaylandpresentation_p.h"
 
 #include <QtCore/QFileInfo>
 #include <QtCore/QPointer>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QTimer>
 #include <QtGui/QWindow>
 
 #include <QGuiApplication>
@@ -34,6 +37,10 @@
 #include <QtCore/private/qthread_p.h>
 
 #include <QtWaylandClient/private/qwayland-fractional-scale-v1.h>
+#include <QtWaylandClient/private/qwayland-single-pixel-buffer-v1.h>
+
+#include <algorithm>
+#include <limits>
 
 QT_BEGIN_NAMESPACE
 
@@ -58,6 +65,10 @@ QWaylandWindow::QWaylandWindow(QWindow *window, QWaylandDisplay *display)
         int frameCallbackTimeout = qEnvironmentVariableIntValue("QT_WAYLAND_FRAME_CALLBACK_TIMEOUT", &ok);
         if (ok)
             mFrameCallbackTimeout = frameCallbackTimeout;
+
+        int presentationDeadline = qEnvironmentVariableIntValue("QT_WAYLAND_PRESENTATION_DEADLINE", &ok);
+        if (ok && presentationDeadline >= 0)
+            mPresentationDeadline = presentationDeadline;
     }
 
     initializeWlSurface();
@@ -289,8 +300,13 @@ void QWaylandWindow::reset()
         {
             QWriteLocker lock(&mSurfaceLock);
             invalidateSurface();
+            mDecorationSurface.reset();
+            for (struct ::wl_buffer *buffer : std::as_const(mSolidColorBuffers))
+                wl_buffer_destroy(buffer);
+            mSolidColorBuffers.clear();
             mSurface.reset();
             mViewport.reset();
+            mSolidColorViewport.reset();
             mFractionalScale.reset();
         }
         emit wlSurfaceDestroyed();
@@ -328,6 +344,10 @@ void QWaylandWindow::resetSurfaceRole()
         }
         mFrameCallbackElapsedTimer.invalidate();
         mWaitingForFrameCallback = false;
+        for (const PendingPresentationFeedback &pending : std::as_const(mPresentationFeedbacks))
+            wp_presentation_feedback_destroy(pending.feedback);
+        mPresentationFeedbacks.clear();
+        mUpdateDeliveryTime = 0;
     }
     if (mFrameCallbackCheckIntervalTimerId != -1) {
         killTimer(mFrameCallbackCheckIntervalTimerId);
@@ -398,8 +418,9 @@ void QWaylandWindow::setWindowTitle(const QString &title)
     if (mShellSurface)
         mShellSurface->setTitle(mWindowTitle);
 
+    // Title and icon are part of the title bar
     if (mWindowDecorationEnabled && window()->isVisible())
-        mWindowDecoration->update();
+        mWindowDecoration->update(QRect(0, 0, surfaceSize().width(), mWindowDecoration->margins().top()));
 }
 
 void QWaylandWindow::setWindowIcon(const QIcon &icon)
@@ -407,7 +428,7 @@ void QWaylandWindow::setWindowIcon(const QIcon &icon)
     mWindowIcon = icon;
 
     if (mWindowDecorationEnabled && window()->isVisible())
-        mWindowDecoration->update();
+        mWindowDecoration->update(QRect(0, 0, surfaceSize().width(), mWindowDecoration->margins().top()));
 }
 
 QRect QWaylandWindow::defaultGeometry() const
@@ -422,7 +443,7 @@ void QWaylandWindow::setGeometry_helper(const QRect &rect)
         updateViewport();
 
     if (mSubSurfaceWindow) {
-        QMargins m = static_cast<QWaylandWindow *>(QPlatformWindow::parent())->clientSideMargins();
+        QMargins m = static_cast<QWaylandWindow *>(QPlatformWindow::parent())->bufferMargins();
         mSubSurfaceWindow->set_position(rect.x() + m.left(), rect.y() + m.top());
 
         QWaylandWindow *parentWindow = mSubSurfaceWindow->parent();
@@ -469,7 +490,7 @@ void QWaylandWindow::setGeometry(const QRect &r)
         sendExposeEvent(exposeGeometry);
 
     if (mShellSurface)
-        mShellSurface->setContentGeometry(windowContentGeometry());
+        mShellSurface->setContentGeometry(shellWindowGeometry());
 
     if (isOpaque() && mMask.isEmpty())
         setOpaqueArea(QRect(QPoint(0, 0), rect.size()));
@@ -503,8 +524,82 @@ void QWaylandWindow::updateInputRegion()
 
 void QWaylandWindow::updateViewport()
 {
-    if (!surfaceSize().isEmpty())
-        mViewport->setDestination(surfaceSize());
+    const QSize size = surfaceSize().shrunkBy(clientSideMargins() - bufferMargins());
+    if (!size.isEmpty())
+        mViewport->setDestination(size);
+}
+
+/*!
+    Makes the window show \a color instead of the contents rendered into it, using a single
+    pixel buffer that the compositor scales to the window size. Nothing needs to be allocated
+    or painted for that, so this is the cheapest way to show a plain background or a placeholder.
+    Pass an invalid color to show the rendered contents again.
+
+    Returns false if the compositor lacks \c wp_single_pixel_buffer_manager_v1 or
+    \c wp_viewporter, or if the window is not a raster window. OpenGL and Vulkan
+    swaps attach their own buffers, which would replace the single pixel buffer.
+*/
+bool QWaylandWindow::setSolidColor(const QColor &color)
+{
+    if (color.isValid() && (!mDisplay->singlePixelBufferManager() || !mDisplay->viewporter()))
+        return false;
+
+    if (color.isValid() && window()->surfaceType() != QSurface::RasterSurface)
+        return false;
+
+    mSolidColor = color;
+    if (!mSolidColor.isValid()) {
+        // The single pixel buffer and its viewport stay until the next buffer from the
+        // backing store replaces them, so have the contents painted again
+        if (!isOpaque())
+            setOpaqueArea(QRegion());
+        else
+            setOpaqueArea(mMask.isEmpty() ? QRegion(QRect(QPoint(), geometry().size())) : mMask);
+        if (isExposed())
+            sendExposeEvent(QRect(QPoint(), geometry().size()));
+        return true;
+    }
+
+    if (isExposed())
+        commitSolidColor();
+    return true;
+}
+
+void QWaylandWindow::commitSolidColor()
+{
+    QReadLocker locker(&mSurfaceLock);
+    if (!mSurface)
+        return;
+
+    const QSize size = surfaceSize().shrunkBy(clientSideMargins() - bufferMargins());
+    if (size.isEmpty())
+        return;
+
+    // The protocol takes premultiplied channels. The previous buffer is destroyed once released.
+    constexpr qreal max = std::numeric_limits<uint32_t>::max();
+    const qreal alpha = mSolidColor.alphaF();
+    struct ::wl_buffer *buffer = mDisplay->singlePixelBufferManager()->create_u32_rgba_buffer(
+            uint32_t(mSolidColor.redF() * alpha * max), uint32_t(mSolidColor.greenF() * alpha * max),
+            uint32_t(mSolidColor.blueF() * alpha * max), uint32_t(alpha * max));
+    wl_buffer_add_listener(buffer, &solidColorBufferListener, this);
+    mSolidColorBuffers.append(buffer);
+
+    QWaylandViewport *viewport = mViewport.data();
+    if (!viewport) {
+        if (!mSolidColorViewport)
+            mSolidColorViewport.reset(new QWaylandViewport(mDisplay->viewporter()->get_viewport(mSurface->object())));
+        viewport = mSolidColorViewport.data();
+    }
+    viewport->setDestination(size);
+
+    mSurface->attach(buffer, 0, 0);
+    if (mSurface->version() >= 4)
+        mSurface->damage_buffer(0, 0, 1, 1);
+    else
+        mSurface->damage(0, 0, size.width(), size.height());
+    // A translucent color makes the whole window translucent, whatever its format
+    setOpaqueArea(mSolidColor.alpha() == 255 ? QRegion(QRect(QPoint(), size)) : QRegion());
+    mSurface->commit();
 }
 
 void QWaylandWindow::setGeometryFromApplyConfigure(const QPoint &globalPosition, const QSize &sizeWithMargins)
@@ -551,6 +646,9 @@ void QWaylandWindow::sendExposeEvent(const QRect &rect)
     if (!(mShellSurface && mShellSurface->handleExpose(rect))) {
         QWindowSystemInterface::handleExposeEvent(window(), rect);
         mLastExposeGeometry = rect;
+        // Follow the new size, there is no backing store that would commit it
+        if (mSolidColor.isValid() && !rect.isEmpty())
+            commitSolidColor();
     }
     else
         qCDebug(lcQpaWayland) << "sendExposeEvent: intercepted by shell extension, not sending";
@@ -766,6 +864,11 @@ void QWaylandWindow::safeCommit(QWaylandBuffer *buffer, const QRegion &damage)
 void QWaylandWindow::commit(QWaylandBuffer *buffer, const QRegion &damage)
 {
     Q_ASSERT(isExposed());
+    if (mSolidColor.isValid()) {
+        // The single pixel buffer is shown instead
+        buffer->setBusy(false);
+        return;
+    }
     if (buffer->committed()) {
         qCDebug(lcWaylandBackingstore) << "Buffer already committed, ignoring.";
         return;
@@ -776,6 +879,8 @@ void QWaylandWindow::commit(QWaylandBuffer *buffer, const QRegion &damage)
         return;
 
     attachOffset(buffer);
+    // The viewport that scaled the single pixel buffer goes with it
+    mSolidColorViewport.reset();
     if (mSurface->version() >= 4) {
         const qreal s = scale();
         for (const QRect &rect : damage) {
@@ -801,6 +906,14 @@ void QWaylandWindow::commit()
         mSurface->commit();
 }
 
+const wl_buffer_listener QWaylandWindow::solidColorBufferListener = {
+    [](void *data, wl_buffer *buffer) {
+        auto *window = static_cast<QWaylandWindow *>(data);
+        window->mSolidColorBuffers.removeOne(buffer);
+        wl_buffer_destroy(buffer);
+    }
+};
+
 const wl_callback_listener QWaylandWindow::callbackListener = {
     [](void *data, wl_callback *callback, uint32_t time) {
         Q_UNUSED(time);
@@ -840,9 +953,147 @@ void QWaylandWindow::doHandleFrameCallback()
     mFrameCallbackTimedOut = false;
     // Did setting mFrameCallbackTimedOut make the window exposed?
     updateExposure();
-    if (wasExposed && hasPendingUpdateRequest())
+    if (!wasExposed || !hasPendingUpdateRequest())
+        return;
+
+    const int delay = updateRequestDelay();
+    if (delay <= 0) {
         deliverUpdateRequest();
+    } else if (!std::exchange(mUpdateRequestScheduled, true)) {
+        QTimer::singleShot(delay, Qt::PreciseTimer, this, [this] {
+            mUpdateRequestScheduled = false;
+            if (isExposed() && hasPendingUpdateRequest())
+                deliverUpdateRequest();
+        });
+    }
+}
+
+const wp_presentation_feedback_listener QWaylandWindow::presentationFeedbackListener = {
+    [](void *data, wp_presentation_feedback *feedback, wl_output *output) {
+        Q_UNUSED(data);
+        Q_UNUSED(feedback);
+        Q_UNUSED(output);
+    },
+    [](void *data, wp_presentation_feedback *feedback, uint32_t tvSecHi, uint32_t tvSecLo,
+       uint32_t tvNsec, uint32_t refresh, uint32_t seqHi, uint32_t seqLo, uint32_t flags) {
+        PresentationStatistics presented;
+        presented.presentationTime = qint64((quint64(tvSecHi) << 32) | tvSecLo) * 1000000000 + tvNsec;
+        presented.refresh = refresh;
+        presented.sequence = (quint64(seqHi) << 32) | seqLo;
+        presented.flags = flags;
+        static_cast<QWaylandWindow *>(data)->handlePresentationFeedback(feedback, &presented);
+    },
+    [](void *data, wp_presentation_feedback *feedback) {
+        static_cast<QWaylandWindow *>(data)->handlePresentationFeedback(feedback, nullptr);
+    }
+};
 
+// Runs on the frame event thread, presented is null if the frame was discarded
+void QWaylandWindow::handlePresentationFeedback(wp_presentation_feedback *feedback, const PresentationStatistics *presented)
+{
+    QMutexLocker locker(&mFrameSyncMutex);
+    const auto it = std::find_if(mPresentationFeedbacks.cbegin(), mPresentationFeedbacks.cend(),
+                                 [feedback](const PendingPresentationFeedback &pending) {
+                                     return pending.feedback == feedback;
+                                 });
+    if (it == mPresentationFeedbacks.cend()) {
+        // Already destroyed by QWaylandWindow::resetSurfaceRole
+        return;
+    }
+    const qint64 commitTime = it->commitTime;
+    mPresentationFeedbacks.erase(it);
+    wp_presentation_feedback_destroy(feedback);
+
+    if (presented) {
+        const quint64 presentedFrames = mPresentationStatistics.presentedFrames + 1;
+        const quint64 discardedFrames = mPresentationStatistics.discardedFrames;
+        mPresentationStatistics = *presented;
+        mPresentationStatistics.latency = presented->presentationTime - commitTime;
+        mPresentationStatistics.presentedFrames = presentedFrames;
+        mPresentationStatistics.discardedFrames = discardedFrames;
+    } else {
+        ++mPresentationStatistics.discardedFrames;
+    }
+
+    QMetaObject::invokeMethod(this, [this] {
+        auto *nativeInterface = static_cast<QWaylandNativeInterface *>(
+                QGuiApplication::platformNativeInterface());
+        nativeInterface->emitWindowPropertyChanged(this, u"presentationFeedback"_s);
+    }, Qt::QueuedConnection);
+}
+
+// Returns when and how the last frame of the window was presented, if the compositor
+// supports wp_presentation. Times are in nanoseconds in the clock the compositor
+// announced with wp_presentation.clock_id, and the refresh duration is 0 if unknown.
+// The latency is the time from the commit to the presentation of the frame.
+QVariantMap QWaylandWindow::presentationFeedback()
+{
+    QMutexLocker locker(&mFrameSyncMutex);
+    const PresentationStatistics &statistics = mPresentationStatistics;
+    return {
+        { u"presentationTime"_s, statistics.presentationTime },
+        { u"refresh"_s, statistics.refresh },
+        { u"sequence"_s, statistics.sequence },
+        { u"flags"_s, statistics.flags },
+        { u"latency"_s, statistics.latency },
+        { u"presentedFrames"_s, statistics.presentedFrames },
+        { u"discardedFrames"_s, statistics.discardedFrames },
+    };
+}
+
+// Returns the latest pointer motion over the window, including the frames that were
+// coalesced into a single mouse move event with QT_WAYLAND_COALESCE_POINTER_MOTION
+QVariantList QWaylandWindow::pointerMotionHistory() const
+{
+    const auto inputDevices = mDisplay->inputDevices();
+    for (QWaylandInputDevice *inputDevice : inputDevices) {
+        auto *pointer = inputDevice->pointer();
+        if (pointer && pointer->focusWindow() == this)
+            return pointer->motionHistory();
+    }
+    return {};
+}
+
+// Returns how many milliseconds to hold back an update request driven by a frame
+// callback, so that the frame is rendered just in time to be committed
+// QT_WAYLAND_PRESENTATION_DEADLINE milliseconds before the next vblank. This keeps
+// the latency from input to display low, instead of rendering right after the
+// compositor repainted and having the frame wait for most of a refresh cycle.
+int QWaylandWindow::updateRequestDelay()
+{
+    QWaylandPresentation *presentation = mDisplay->presentation();
+    if (mPresentationDeadline < 0 || !presentation)
+        return 0;
+
+    QMutexLocker locker(&mFrameSyncMutex);
+    const qint64 refresh = mPresentationStatistics.refresh;
+    const qint64 lastPresentation = mPresentationStatistics.presentationTime;
+    const qint64 now = presentation->currentTime();
+    if (refresh <= 0 || lastPresentation <= 0 || now < lastPresentation)
+        return 0;
+
+    const qint64 nextVblank = lastPresentation + ((now - lastPresentation) / refresh + 1) * refresh;
+    const qint64 deliveryTime = nextVblank - qint64(mPresentationDeadline) * 1000000 - mRenderTime;
+    return deliveryTime > now ? int((deliveryTime - now) / 1000000) : 0;
+}
+
+// Has to be called with mFrameSyncMutex locked, before the commit the feedback is for
+void QWaylandWindow::requestPresentationFeedback()
+{
+    QWaylandPresentation *presentation = mDisplay->presentation();
+    if (!presentation)
+        return;
+
+    auto *feedback = presentation->createFeedback(mSurface->object(), mDisplay->frameEventQueue());
+    wp_presentation_feedback_add_listener(feedback, &QWaylandWindow::presentationFeedbackListener, this);
+    const qint64 now = presentation->currentTime();
+    mPresentationFeedbacks.append({ feedback, now });
+
+    if (mUpdateDeliveryTime > 0) {
+        // Follow a longer render time right away, and a shorter one slowly
+        const qint64 renderTime = now - std::exchange(mUpdateDeliveryTime, 0);
+        mRenderTime = qMax(renderTime, mRenderTime - mRenderTime / 16);
+    }
 }
 
 bool QWaylandWindow::waitForFrameSync(int timeout)
@@ -877,6 +1128,15 @@ QMargins QWaylandWindow::clientSideMargins() const
     return mWindowDecorationEnabled ? mWindowDecoration->margins() : QMargins{};
 }
 
+/*!
+ * The part of clientSideMargins() that is drawn into the buffers of the window's own
+ * wl_surface. That is none when the decorations are shown in a subsurface of their own.
+ */
+QMargins QWaylandWindow::bufferMargins() const
+{
+    return mDecorationSurface ? QMargins{} : clientSideMargins();
+}
+
 void QWaylandWindow::setCustomMargins(const QMargins &margins) {
     const QMargins oldMargins = mCustomMargins;
     mCustomMargins = margins;
@@ -915,6 +1175,31 @@ QRect QWaylandWindow::windowContentGeometry() const
     return QRect(QPoint(margins.left(), margins.top()), surfaceSize().shrunkBy(margins));
 }
 
+/*!
+ * Window geometry in the coordinates of the window's own wl_surface, which
+ * does not start at the decorations when those are shown in a subsurface.
+ */
+QRect QWaylandWindow::shellWindowGeometry() const
+{
+    const QMargins margins = clientSideMargins() - bufferMargins();
+    return windowContentGeometry().translated(-margins.left(), -margins.top());
+}
+
+/*!
+ * Position of \a surface, which is either the window's own wl_surface or the
+ * subsurface showing the decorations, in wl_surface coordinates. Input events
+ * are reported relative to the surface they are received for.
+ */
+QPoint QWaylandWindow::surfacePosition(::wl_surface *surface) const
+{
+    if (!mDecorationSurface)
+        return QPoint();
+    if (const auto position = mDecorationSurface->surfacePosition(surface))
+        return *position;
+    const QMargins margins = clientSideMargins();
+    return QPoint(margins.left(), margins.top());
+}
+
 /*!
  * Converts from wl_surface coordinates to Qt window coordinates. Qt window
  * coordinates start inside (not including) the window decorations, while
@@ -1122,10 +1407,18 @@ bool QWaylandWindow::createDecoration()
         mWindowDecorationEnabled = false;
     }
 
+    const bool decorationSurface = mWindowDecorationEnabled && mSurface
+            && QWaylandDecorationSurface::isSupported(mDisplay);
+    if (decorationSurface != hasDecorationSurface()) {
+        auto *surface = decorationSurface ? new QWaylandDecorationSurface(this) : nullptr;
+        QWriteLocker lock(&mSurfaceLock);
+        mDecorationSurface.reset(surface);
+    }
+
     if (hadDecoration != mWindowDecorationEnabled) {
         for (QWaylandSubSurface *subsurf : std::as_const(mChildren)) {
             QPoint pos = subsurf->window()->geometry().topLeft();
-            QMargins m = frameMargins();
+            QMargins m = bufferMargins();
             subsurf->set_position(pos.x() + m.left(), pos.y() + m.top());
         }
         setGeometry(geometry());
@@ -1695,6 +1988,10 @@ void QWaylandWindow::requestUpdate()
             return;
     }
 
+    // Same if the update request is already scheduled for the next vblank
+    if (mUpdateRequestScheduled)
+        return;
+
     // If we've already called deliverUpdateRequest(), but haven't seen any attach+commit/swap yet
     // This is a somewhat redundant behavior and might indicate a bug in the calling code, so log
     // here so we can get this information when debugging update/frame callback issues.
@@ -1728,7 +2025,17 @@ void QWaylandWindow::handleUpdate()
     if (!mSurface)
         return;
 
+    // The decoration surfaces belong to the GUI thread, and as they are synchronized
+    // the update is applied together with the next commit of the window
+    if (mDecorationSurface) {
+        if (QThread::currentThread() == thread())
+            mDecorationSurface->update();
+        else
+            QMetaObject::invokeMethod(this, &QWaylandWindow::updateDecorationSurface, Qt::QueuedConnection);
+    }
+
     QMutexLocker locker(&mFrameSyncMutex);
+    requestPresentationFeedback();
     if (mWaitingForFrameCallback)
         return;
 
@@ -1754,10 +2061,23 @@ void QWaylandWindow::handleUpdate()
     }
 }
 
+void QWaylandWindow::updateDecorationSurface()
+{
+    QReadLocker lock(&mSurfaceLock);
+    if (mDecorationSurface)
+        mDecorationSurface->update();
+}
+
 void QWaylandWindow::deliverUpdateRequest()
 {
     qCDebug(lcWaylandBackingstore) << "deliverUpdateRequest";
+    // Lets decoration changes be applied with the frame that is about to be rendered
+    updateDecorationSurface();
     mWaitingForUpdate = true;
+    if (QWaylandPresentation *presentation = mDisplay->presentation()) {
+        QMutexLocker locker(&mFrameSyncMutex);
+        mUpdateDeliveryTime = presentation->currentTime();
+    }
     QPlatformWindow::deliverUpdateRequest();
 }
 
@@ -1799,7 +2119,7 @@ bool QWaylandWindow::isOpaque() const
 
 void QWaylandWindow::setOpaqueArea(const QRegion &opaqueArea)
 {
-    const QRegion translatedOpaqueArea = opaqueArea.translated(clientSideMargins().left(), clientSideMargins().top());
+    const QRegion translatedOpaqueArea = opaqueArea.translated(bufferMargins().left(), bufferMargins().top());
 
     if (translatedOpaqueArea == mOpaqueArea || !mSurface)
         return;
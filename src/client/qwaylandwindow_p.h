@@ -20,6 +20,7 @@
 #include <QtCore/QReadWriteLock>
 
 #include <QtGui/QIcon>
+#include <QtGui/QColor>
 #include <QtGui/QEventPoint>
 #include <QtCore/QVariant>
 #include <QtCore/QLoggingCategory>
@@ -38,6 +39,8 @@
 #include <QtCore/qpointer.h>
 
 struct wl_egl_window;
+struct wp_presentation_feedback;
+struct wp_presentation_feedback_listener;
 
 QT_BEGIN_NAMESPACE
 
@@ -50,6 +53,7 @@ class QWaylandBuffer;
 class QWaylandShellSurface;
 class QWaylandSubSurface;
 class QWaylandAbstractDecoration;
+class QWaylandDecorationSurface;
 class QWaylandInputDevice;
 class QWaylandScreen;
 class QWaylandShellIntegration;
@@ -121,11 +125,15 @@ public:
 
     QMargins frameMargins() const override;
     QMargins clientSideMargins() const;
+    QMargins bufferMargins() const;
     void setCustomMargins(const QMargins &margins) override;
     QSize surfaceSize() const;
     QMargins windowContentMargins() const;
     QRect windowContentGeometry() const;
+    QRect shellWindowGeometry() const;
     QPointF mapFromWlSurface(const QPointF &surfacePosition) const;
+    QPoint surfacePosition(::wl_surface *surface) const;
+    bool hasDecorationSurface() const { return !mDecorationSurface.isNull(); }
 
     QWaylandSurface *waylandSurface() const { return mSurface.data(); }
     ::wl_surface *wlSurface() const;
@@ -206,6 +214,14 @@ public:
     QVariant property(const QString &name);
     QVariant property(const QString &name, const QVariant &defaultValue);
 
+    // Timing of the last presented frame, see wp_presentation_feedback
+    QVariantMap presentationFeedback();
+    QVariantList pointerMotionHistory() const;
+
+    // Shows a single color instead of the rendered contents, see wp_single_pixel_buffer_v1
+    bool setSolidColor(const QColor &color);
+    QColor solidColor() const { return mSolidColor; }
+
 #ifdef QT_PLATFORM_WINDOW_HAS_VIRTUAL_SET_BACKING_STORE
     void setBackingStore(QPlatformBackingStore *store) override;
 #else
@@ -267,6 +283,9 @@ protected:
     QScopedPointer<QWaylandSurface> mSurface;
     QScopedPointer<QWaylandFractionalScale> mFractionalScale;
     QScopedPointer<QWaylandViewport> mViewport;
+    QScopedPointer<QWaylandViewport> mSolidColorViewport; // Only if mViewport is not there
+    QList<struct ::wl_buffer *> mSolidColorBuffers; // Until the compositor releases them
+    QColor mSolidColor;
 
     QWaylandShellIntegration *mShellIntegration = nullptr;
     QWaylandShellSurface *mShellSurface = nullptr;
@@ -274,6 +293,7 @@ protected:
     QList<QWaylandSubSurface *> mChildren;
 
     std::unique_ptr<QWaylandAbstractDecoration> mWindowDecoration;
+    QScopedPointer<QWaylandDecorationSurface> mDecorationSurface;
     bool mWindowDecorationEnabled = false;
     bool mMouseEventsInContentArea = false;
     Qt::MouseButtons mMousePressedInContentArea = Qt::NoButton;
@@ -305,6 +325,26 @@ protected:
     QMutex mFrameSyncMutex;
     QWaitCondition mFrameSyncWait;
 
+    struct PendingPresentationFeedback {
+        struct ::wp_presentation_feedback *feedback = nullptr;
+        qint64 commitTime = 0;
+    };
+    struct PresentationStatistics {
+        qint64 presentationTime = 0; // In nanoseconds in the presentation clock
+        qint64 refresh = 0; // In nanoseconds, 0 if unknown
+        quint64 sequence = 0;
+        uint flags = 0;
+        qint64 latency = 0; // From commit to presentation
+        quint64 presentedFrames = 0;
+        quint64 discardedFrames = 0;
+    };
+    QList<PendingPresentationFeedback> mPresentationFeedbacks; // Protected by mFrameSyncMutex
+    PresentationStatistics mPresentationStatistics; // Protected by mFrameSyncMutex
+    qint64 mUpdateDeliveryTime = 0; // Protected by mFrameSyncMutex
+    qint64 mRenderTime = 0; // Protected by mFrameSyncMutex
+    int mPresentationDeadline = -1; // Update requests are delivered as they come when negative
+    bool mUpdateRequestScheduled = false;
+
     // True when we have called deliverRequestUpdate, but the client has not yet attached a new buffer
     bool mWaitingForUpdate = false;
     bool mExposed = false;
@@ -359,6 +399,8 @@ private:
     bool isOpaque() const;
     void updateInputRegion();
     void updateViewport();
+    void commitSolidColor();
+    void updateDecorationSurface();
     bool calculateExposure() const;
 
     void handleMouseEventWithDecoration(QWaylandInputDevice *inputDevice, const QWaylandPointerEvent &e);
@@ -377,6 +419,13 @@ private:
     static const wl_callback_listener callbackListener;
     void handleFrameCallback(struct ::wl_callback* callback);
 
+    static const wl_buffer_listener solidColorBufferListener;
+
+    static const wp_presentation_feedback_listener presentationFeedbackListener;
+    void handlePresentationFeedback(struct ::wp_presentation_feedback *feedback, const PresentationStatistics *presented);
+    void requestPresentationFeedback();
+    int updateRequestDelay();
+
     static QWaylandWindow *mMouseGrab;
     static QWaylandWindow *mTopPopup;
 
@@ -2,7 +2,7 @@
 # SPDX-License-Identifier: BSD-3-Clause
 
 function(qt6_generate_wayland_protocol_server_sources target)
-    cmake_parse_arguments(arg "PUBLIC_CODE;PRIVATE_CODE" "__QT_INTERNAL_WAYLAND_INCLUDE_DIR" "FILES" ${ARGN})
+    cmake_parse_arguments(arg "PUBLIC_CODE;PRIVATE_CODE;STRING_VIEWS" "__QT_INTERNAL_WAYLAND_INCLUDE_DIR" "FILES" ${ARGN})
     if(DEFINED arg_UNPARSED_ARGUMENTS)
         message(FATAL_ERROR "Unknown arguments were passed to qt6_generate_wayland_protocol_server_sources: (${arg_UNPARSED_ARGUMENTS}).")
     endif()
@@ -28,6 +28,11 @@ function(qt6_generate_wayland_protocol_server_sources target)
         set(wayland_scanner_code_option "public-code")
     endif()
 
+    set(qtwaylandscanner_extra_args "")
+    if(arg_STRING_VIEWS)
+        list(APPEND qtwaylandscanner_extra_args "--string-views")
+    endif()
+
     foreach(protocol_file IN LISTS arg_FILES)
         get_filename_component(protocol_name "${protocol_file}" NAME_WLE)
 
@@ -67,6 +72,7 @@ function(qt6_generate_wayland_protocol_server_sources target)
                 "${protocol_file}"
                 --build-macro=${build_macro}
                 --header-path='${wayland_include_dir}'
+                ${qtwaylandscanner_extra_args}
                 > "${qtwaylandscanner_header_output}"
             DEPENDS ${protocol_file} Qt6::qtwaylandscanner
         )
@@ -77,6 +83,7 @@ function(qt6_generate_wayland_protocol_server_sources target)
                 "${protocol_file}"
                 --build-macro=${build_macro}
                 --header-path='${wayland_include_dir}'
+                ${qtwaylandscanner_extra_args}
                 > "${qtwaylandscanner_code_output}"
             DEPENDS ${protocol_file} Qt6::qtwaylandscanner
         )
@@ -265,10 +265,29 @@ QImage QWaylandBufferRef::image() const
     return d->buffer->image();
 }
 
+/*!
+ * Returns the color of the buffer if it is known to be filled with a single color, such as
+ * buffers created with \c wp_single_pixel_buffer_manager_v1. Otherwise returns an invalid QColor.
+ *
+ * Such buffers can be drawn as plain rectangles instead of being uploaded as textures.
+ *
+ * \since 6.9
+ */
+QColor QWaylandBufferRef::solidColor() const
+{
+    if (d->nullOrDestroyed())
+        return QColor();
+
+    return d->buffer->solidColor();
+}
+
 #if QT_CONFIG(opengl)
 /*!
  * Returns an OpenGL texture for the buffer. \a plane is the index for multi-plane formats, such as YUV.
  *
+ * Like the buffers clients attach, the texture has premultiplied alpha, so it should be
+ * blended with \c{glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA)}.
+ *
  * The returned texture is owned by the buffer. The texture is only valid for as
  * long as the buffer reference exists. The caller of this function must not delete the texture, and must
  * keep a reference to the buffer for as long as the texture is being used.
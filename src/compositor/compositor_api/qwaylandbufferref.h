@@ -6,6 +6,7 @@
 
 #include <QtWaylandCompositor/qtwaylandcompositorglobal.h>
 #include <QtGui/QImage>
+#include <QtGui/QColor>
 
 #if QT_CONFIG(opengl)
 #include <QtGui/qopengl.h>
@@ -68,6 +69,7 @@ public:
 
     bool isSharedMemory() const;
     QImage image() const;
+    QColor solidColor() const;
 
 #if QT_CONFIG(opengl)
     QOpenGLTexture *toOpenGLTexture(int plane = 0) const;
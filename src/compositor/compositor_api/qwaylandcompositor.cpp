@@ -281,8 +281,19 @@ void QWaylandCompositorPrivate::destroySurface(QWaylandSurface *surface)
 
 void QWaylandCompositorPrivate::unregisterSurface(QWaylandSurface *surface)
 {
-    if (!all_surfaces.removeOne(surface))
+    const auto it = surface_indexes.constFind(surface);
+    if (it == surface_indexes.constEnd()) {
         qWarning("%s Unexpected state. Cant find registered surface\n", Q_FUNC_INFO);
+        return;
+    }
+
+    const qsizetype index = *it;
+    surface_indexes.erase(it);
+    QWaylandSurface *last = all_surfaces.takeLast();
+    if (last != surface) {
+        all_surfaces[index] = last;
+        surface_indexes[last] = index;
+    }
 }
 
 void QWaylandCompositorPrivate::feedRetainedSelectionData(QMimeData *data)
@@ -329,6 +340,7 @@ void QWaylandCompositorPrivate::compositor_create_surface(wl_compositor::Resourc
         surface->initialize(q, client, id, resource->version());
     }
     Q_ASSERT(surface);
+    surface_indexes.insert(surface, all_surfaces.size());
     all_surfaces.append(surface);
     emit q->surfaceCreated(surface);
 }
@@ -19,6 +19,7 @@
 #include <QtWaylandCompositor/private/qtwaylandcompositorglobal_p.h>
 #include <QtWaylandCompositor/QWaylandCompositor>
 #include <QtCore/private/qobject_p.h>
+#include <QtCore/QHash>
 #include <QtCore/QSet>
 #include <QtCore/QElapsedTimer>
 
@@ -64,6 +65,7 @@ public:
     void unregisterSurface(QWaylandSurface *surface);
 
     QWaylandOutput *defaultOutput() const { return outputs.size() ? outputs.first() : nullptr; }
+    const QList<QWaylandSeat *> &seatList() const { return seats; }
 
     inline const QList<QtWayland::ClientBufferIntegration *> clientBufferIntegrations() const;
     inline QtWayland::ServerBufferIntegration *serverBufferIntegration() const;
@@ -117,7 +119,10 @@ protected:
     QList<QWaylandSeat *> seats;
     QList<QWaylandOutput *> outputs;
 
+    // Surfaces are removed by moving the last one into their slot, so that
+    // surface churn does not have to scan the list.
     QList<QWaylandSurface *> all_surfaces;
+    QHash<QWaylandSurface *, qsizetype> surface_indexes;
 
 #if QT_CONFIG(wayland_datadevice)
     QtWayland::DataDeviceManager *data_device_manager = nullptr;
@@ -27,6 +27,7 @@
 #include <QtWaylandCompositor/qwaylandtextinputmanagerv3.h>
 #include <QtWaylandCompositor/qwaylandqttextinputmethodmanager.h>
 #include <QtWaylandCompositor/qwaylandidleinhibitv1.h>
+#include <QtWaylandCompositor/qwaylandcursorshapev1.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -88,6 +89,8 @@ Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_NAMED_ELEMENT(QWaylandTextInputManagerV3, T
                                                    1, 0)
 Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_NAMED_ELEMENT(QWaylandQtTextInputMethodManager,
                                                    QtTextInputMethodManager, 1, 0)
+Q_COMPOSITOR_DECLARE_QUICK_EXTENSION_NAMED_ELEMENT(QWaylandCursorShapeManagerV1,
+                                                   CursorShapeManagerV1, 6, 9)
 
 QT_END_NAMESPACE
 
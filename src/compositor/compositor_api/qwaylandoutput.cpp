@@ -6,6 +6,7 @@
 #include "qwaylandoutput_p.h"
 
 #include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/QWaylandSeat>
 #include <QtWaylandCompositor/QWaylandView>
 
 #include <QtWaylandCompositor/private/qwaylandsurface_p.h>
@@ -13,14 +14,18 @@
 #include <QtWaylandCompositor/private/qwaylandview_p.h>
 #include <QtWaylandCompositor/private/qwaylandutils_p.h>
 #include <QtWaylandCompositor/private/qwaylandxdgoutputv1_p.h>
+#include <QtWaylandCompositor/private/qwaylandfractionalscalev1_p.h>
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QtMath>
+#include <QtCore/QTimer>
 #include <QtGui/QWindow>
 #include <QtGui/QExposeEvent>
 #include <QtGui/QScreen>
 #include <private/qobject_p.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 static QtWaylandServer::wl_output::subpixel toWlSubpixel(const QWaylandOutput::Subpixel &value)
@@ -122,7 +127,7 @@ void QWaylandOutputPrivate::sendGeometry(const Resource *resource)
 
 void QWaylandOutputPrivate::sendGeometryInfo()
 {
-    for (const Resource *resource : resourceMap().values()) {
+    for (const Resource *resource : resources()) {
         sendGeometry(resource);
         if (resource->version() >= 2)
             send_done(resource->handle);
@@ -147,7 +152,7 @@ void QWaylandOutputPrivate::sendMode(const Resource *resource, const QWaylandOut
 
 void QWaylandOutputPrivate::sendModesInfo()
 {
-    for (const Resource *resource : resourceMap().values()) {
+    for (const Resource *resource : resources()) {
         for (const QWaylandOutputMode &mode : modes)
             sendMode(resource, mode);
         if (resource->version() >= 2)
@@ -187,33 +192,88 @@ void QWaylandOutputPrivate::handleWindowPixelSizeChanged()
 
 void QWaylandOutputPrivate::addView(QWaylandView *view, QWaylandSurface *surface)
 {
-    for (int i = 0; i < surfaceViews.size(); i++) {
-        if (surface == surfaceViews.at(i).surface) {
-            if (!surfaceViews.at(i).views.contains(view)) {
-                surfaceViews[i].views.append(view);
-            }
-            return;
-        }
+    if (QWaylandSurfaceViewMapper *mapper = mapperForSurface(surface)) {
+        if (!mapper->views.contains(view))
+            mapper->views.append(view);
+        return;
     }
 
+    surfaceViewIndexes.insert(surface, surfaceViews.size());
     surfaceViews.append(QWaylandSurfaceViewMapper(surface,view));
+    scheduleFrame(surface);
 }
 
 void QWaylandOutputPrivate::removeView(QWaylandView *view, QWaylandSurface *surface)
 {
     Q_Q(QWaylandOutput);
-    for (int i = 0; i < surfaceViews.size(); i++) {
-        if (surface == surfaceViews.at(i).surface) {
-            bool removed = surfaceViews[i].views.removeOne(view);
-            if (surfaceViews.at(i).views.isEmpty() && removed) {
-                if (surfaceViews.at(i).has_entered)
-                    q->surfaceLeave(surface);
-                surfaceViews.remove(i);
-            }
-            return;
-        }
+    const auto it = surfaceViewIndexes.constFind(surface);
+    if (it == surfaceViewIndexes.constEnd()) {
+        qWarning("%s Could not find view %p for surface %p to remove. Possible invalid state", Q_FUNC_INFO, view, surface);
+        return;
+    }
+
+    const qsizetype i = *it;
+    bool removed = surfaceViews[i].views.removeOne(view);
+    if (!surfaceViews.at(i).views.isEmpty() || !removed)
+        return;
+
+    const bool hasEntered = surfaceViews.at(i).has_entered;
+    // Move the last mapper into the free slot, entries in frameSurfaces are
+    // looked up again when visited.
+    surfaceViewIndexes.erase(it);
+    if (i != surfaceViews.size() - 1) {
+        surfaceViews[i] = std::move(surfaceViews.last());
+        surfaceViewIndexes[surfaceViews.at(i).surface] = i;
     }
-    qWarning("%s Could not find view %p for surface %p to remove. Possible invalid state", Q_FUNC_INFO, view, surface);
+    surfaceViews.removeLast();
+
+    if (hasEntered)
+        q->surfaceLeave(surface);
+}
+
+void QWaylandOutputPrivate::updatePreferredScales()
+{
+    for (const QWaylandSurfaceViewMapper &mapper : std::as_const(surfaceViews)) {
+        if (!mapper.has_entered)
+            continue;
+        if (auto *fractionalScale = QWaylandSurfacePrivate::get(mapper.surface)->fractionalScale)
+            fractionalScale->updatePreferredScale();
+    }
+}
+
+QWaylandSurfaceViewMapper *QWaylandOutputPrivate::mapperForSurface(QWaylandSurface *surface)
+{
+    const auto it = surfaceViewIndexes.constFind(surface);
+    return it != surfaceViewIndexes.constEnd() ? &surfaceViews[*it] : nullptr;
+}
+
+/*
+    Returns the minimum interval in milliseconds at which surfaces that are
+    completely occluded on an output still get frame callbacks, or 0 if frame
+    callbacks are never withheld. Set with QT_WAYLAND_OCCLUDED_FRAME_CALLBACK_INTERVAL,
+    a negative value withholds them until the surface becomes visible.
+*/
+int QWaylandOutputPrivate::occludedFrameCallbackInterval()
+{
+    static const int interval = [] {
+        bool ok = false;
+        const int value = qEnvironmentVariableIntValue("QT_WAYLAND_OCCLUDED_FRAME_CALLBACK_INTERVAL", &ok);
+        return ok ? value : 1000;
+    }();
+    return interval;
+}
+
+/*
+    Makes sure that \a surface is visited by frameStarted() and
+    sendFrameCallbacks(), called when it has committed new state.
+*/
+void QWaylandOutputPrivate::scheduleFrame(QWaylandSurface *surface)
+{
+    QWaylandSurfaceViewMapper *mapper = mapperForSurface(surface);
+    if (!mapper || mapper->frame_pending)
+        return;
+    mapper->frame_pending = true;
+    frameSurfaces.append(surface);
 }
 
 QWaylandOutput::QWaylandOutput()
@@ -819,6 +879,67 @@ void QWaylandOutput::setScaleFactor(int scale)
 
     if (d->xdgOutput)
         QWaylandXdgOutputV1Private::get(d->xdgOutput)->sendDone();
+
+    if (d->fractionalScaleFactor <= 0) {
+        d->updatePreferredScales();
+        Q_EMIT fractionalScaleFactorChanged();
+    }
+}
+
+/*!
+ * \qmlproperty real QtWayland.Compositor::WaylandOutput::fractionalScaleFactor
+ * \since 6.9
+ *
+ * This property holds the exact factor by which the WaylandCompositor scales surfaces
+ * before they are displayed, for outputs where it is not an integer. Clients that support
+ * the \c wp_fractional_scale_v1 extension are told to render at this scale, while other
+ * clients render at \l scaleFactor, which should be set to this value rounded up.
+ *
+ * By default, it follows \l scaleFactor. Set it to \c undefined to restore the default.
+ */
+
+/*!
+ * \property QWaylandOutput::fractionalScaleFactor
+ * \since 6.9
+ *
+ * This property holds the exact factor by which the QWaylandCompositor scales surfaces
+ * before they are displayed, for outputs where it is not an integer. Clients that support
+ * the \c wp_fractional_scale_v1 extension are told to render at this scale by
+ * QWaylandFractionalScaleManagerV1, while other clients render at \l scaleFactor, which
+ * should be set to this value rounded up.
+ *
+ * By default, it follows \l scaleFactor.
+ */
+qreal QWaylandOutput::fractionalScaleFactor() const
+{
+    Q_D(const QWaylandOutput);
+    return d->fractionalScaleFactor > 0 ? d->fractionalScaleFactor : d->scaleFactor;
+}
+
+void QWaylandOutput::setFractionalScaleFactor(qreal scale)
+{
+    Q_D(QWaylandOutput);
+    if (scale <= 0) {
+        qWarning("QWaylandOutput::setFractionalScaleFactor: scale must be positive");
+        return;
+    }
+    if (qFuzzyCompare(d->fractionalScaleFactor, scale))
+        return;
+
+    d->fractionalScaleFactor = scale;
+    d->updatePreferredScales();
+    Q_EMIT fractionalScaleFactorChanged();
+}
+
+void QWaylandOutput::resetFractionalScaleFactor()
+{
+    Q_D(QWaylandOutput);
+    if (d->fractionalScaleFactor <= 0)
+        return;
+
+    d->fractionalScaleFactor = 0;
+    d->updatePreferredScales();
+    Q_EMIT fractionalScaleFactorChanged();
 }
 
 /*!
@@ -893,36 +1014,91 @@ void QWaylandOutput::setWindow(QWindow *window)
 
 /*!
  * Informs QWaylandOutput that a frame has started.
+ *
+ * This also sends the input motion that seats with
+ * QWaylandSeat::motionBatchingEnabled set have merged since the last frame.
  */
 void QWaylandOutput::frameStarted()
 {
     Q_D(QWaylandOutput);
-    for (int i = 0; i < d->surfaceViews.size(); i++) {
-        QWaylandSurfaceViewMapper &surfacemapper = d->surfaceViews[i];
-        if (surfacemapper.maybePrimaryView())
-            surfacemapper.surface->frameStarted();
+    for (QWaylandSeat *seat : QWaylandCompositorPrivate::get(d->compositor)->seatList())
+        seat->sendPendingMotionEvents();
+
+    for (QWaylandSurface *surface : std::as_const(d->frameSurfaces)) {
+        QWaylandSurfaceViewMapper *surfacemapper = d->mapperForSurface(surface);
+        if (surfacemapper && surfacemapper->frame_pending && surfacemapper->maybePrimaryView())
+            surface->frameStarted();
     }
 }
 
 /*!
  * Sends pending frame callbacks.
+ *
+ * Surfaces whose views on this output are all occluded, as determined by
+ * WaylandQuickOutput before each frame, only get frame callbacks once a
+ * second. The interval in milliseconds can be changed with the
+ * \c QT_WAYLAND_OCCLUDED_FRAME_CALLBACK_INTERVAL environment variable, where
+ * \c 0 disables the throttling and a negative value withholds the frame
+ * callbacks until the surface becomes visible.
  */
 void QWaylandOutput::sendFrameCallbacks()
 {
     Q_D(QWaylandOutput);
-    for (int i = 0; i < d->surfaceViews.size(); i++) {
-        const QWaylandSurfaceViewMapper &surfacemapper = d->surfaceViews.at(i);
-        if (surfacemapper.surface && surfacemapper.surface->hasContent()) {
-            if (!surfacemapper.has_entered) {
-                surfaceEnter(surfacemapper.surface);
-                d->surfaceViews[i].has_entered = true;
-            }
-            if (auto primaryView = surfacemapper.maybePrimaryView()) {
-                if (!QWaylandViewPrivate::get(primaryView)->independentFrameCallback)
-                    surfacemapper.surface->sendFrameCallbacks();
+    // Only surfaces that committed something since they were last visited
+    // are scheduled, surfaces that are just sitting there cost nothing.
+    const QList<QWaylandSurface *> surfaces = std::exchange(d->frameSurfaces, {});
+    const int occludedInterval = QWaylandOutputPrivate::occludedFrameCallbackInterval();
+    const uint time = d->compositor->currentTimeMsecs();
+    bool withheld = false;
+    for (QWaylandSurface *surface : surfaces) {
+        QWaylandSurfaceViewMapper *surfacemapper = d->mapperForSurface(surface);
+        if (!surfacemapper || !surfacemapper->frame_pending)
+            continue;
+        surfacemapper->frame_pending = false;
+        if (!surface->hasContent())
+            continue;
+
+        if (!surfacemapper->has_entered) {
+            surfacemapper->has_entered = true;
+            surfaceEnter(surface);
+            // Handlers may have added or removed views
+            surfacemapper = d->mapperForSurface(surface);
+            if (!surfacemapper)
+                continue;
+        }
+
+        if (auto primaryView = surfacemapper->maybePrimaryView()) {
+            if (QWaylandViewPrivate::get(primaryView)->independentFrameCallback)
+                continue;
+
+            // Nobody sees the frames of occluded surfaces, so only let them
+            // render at a low rate
+            const bool occluded = occludedInterval != 0
+                    && std::all_of(surfacemapper->views.cbegin(), surfacemapper->views.cend(), [](QWaylandView *view) {
+                           return QWaylandViewPrivate::get(view)->occluded;
+                       });
+            if (occluded && (occludedInterval < 0 || time - surfacemapper->lastFrameCallbackTime < uint(occludedInterval))) {
+                withheld = true;
+            } else {
+                surfacemapper->lastFrameCallbackTime = time;
+                surface->sendFrameCallbacks();
             }
         }
+
+        // Callbacks committed after frameStarted() go out with the next frame
+        if (QWaylandSurfacePrivate::get(surface)->hasFrameCallbacks())
+            d->scheduleFrame(surface);
+    }
+
+    // Make sure there is another frame to send the withheld callbacks with
+    if (withheld && occludedInterval > 0 && !d->occludedFrameUpdateScheduled) {
+        d->occludedFrameUpdateScheduled = true;
+        QTimer::singleShot(occludedInterval, this, [this] {
+            d_func()->occludedFrameUpdateScheduled = false;
+            update();
+        });
     }
+
     wl_display_flush_clients(d->compositor->display());
 }
 
@@ -937,6 +1113,9 @@ void QWaylandOutput::surfaceEnter(QWaylandSurface *surface)
     auto clientResource = resourceForClient(surface->client());
     if (clientResource)
         QWaylandSurfacePrivate::get(surface)->send_enter(clientResource);
+
+    if (auto *fractionalScale = QWaylandSurfacePrivate::get(surface)->fractionalScale)
+        fractionalScale->updatePreferredScale();
 }
 
 /*!
@@ -950,6 +1129,9 @@ void QWaylandOutput::surfaceLeave(QWaylandSurface *surface)
     auto *clientResource = resourceForClient(surface->client());
     if (clientResource)
         QWaylandSurfacePrivate::get(surface)->send_leave(clientResource);
+
+    if (auto *fractionalScale = QWaylandSurfacePrivate::get(surface)->fractionalScale)
+        fractionalScale->updatePreferredScale();
 }
 
 /*!
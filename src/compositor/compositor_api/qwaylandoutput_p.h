@@ -25,6 +25,7 @@
 
 #include <QtWaylandCompositor/private/qwayland-server-wayland.h>
 
+#include <QtCore/QHash>
 #include <QtCore/QList>
 #include <QtCore/QRect>
 
@@ -55,6 +56,8 @@ struct QWaylandSurfaceViewMapper
     QWaylandSurface *surface = nullptr;
     QList<QWaylandView *> views;
     bool has_entered = false;
+    bool frame_pending = false;
+    uint lastFrameCallbackTime = 0;
 };
 
 class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandOutputPrivate : public QObjectPrivate, public QtWaylandServer::wl_output
@@ -69,6 +72,9 @@ public:
 
     void addView(QWaylandView *view, QWaylandSurface *surface);
     void removeView(QWaylandView *view, QWaylandSurface *surface);
+    QWaylandSurfaceViewMapper *mapperForSurface(QWaylandSurface *surface);
+    void scheduleFrame(QWaylandSurface *surface);
+    static int occludedFrameCallbackInterval();
 
     void sendGeometry(const Resource *resource);
     void sendGeometryInfo();
@@ -77,6 +83,7 @@ public:
     void sendModesInfo();
 
     void handleWindowPixelSizeChanged();
+    void updatePreferredScales();
 
     QPointer<QWaylandXdgOutputV1> xdgOutput;
 
@@ -97,10 +104,16 @@ private:
     int preferredMode = -1;
     QRect availableGeometry;
     QList<QWaylandSurfaceViewMapper> surfaceViews;
+    QHash<QWaylandSurface *, qsizetype> surfaceViewIndexes;
+    // Surfaces that have to be visited on the next frame, i.e. with frame
+    // callbacks or that have not been entered yet
+    QList<QWaylandSurface *> frameSurfaces;
+    bool occludedFrameUpdateScheduled = false;
     QSize physicalSize;
     QWaylandOutput::Subpixel subpixel = QWaylandOutput::SubpixelUnknown;
     QWaylandOutput::Transform transform = QWaylandOutput::TransformNormal;
     int scaleFactor = 1;
+    qreal fractionalScaleFactor = 0; // 0 follows scaleFactor
     bool sizeFollowsWindow = false;
     bool initialized = false;
     QSize windowPixelSize;
@@ -5,6 +5,11 @@
 #include "qwaylandpointer_p.h"
 #include <QtWaylandCompositor/QWaylandClient>
 #include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/QWaylandOutput>
+#include <QtWaylandCompositor/private/qwaylandseat_p.h>
+#include <QtWaylandCompositor/private/qwaylandutils_p.h>
+
+#include <utility>
 
 QT_BEGIN_NAMESPACE
 
@@ -22,10 +27,11 @@ uint QWaylandPointerPrivate::sendButton(Qt::MouseButton button, uint32_t state)
     if (!q->mouseFocus() || !q->mouseFocus()->surface())
         return 0;
 
+    sendMergedMotion();
     wl_client *client = q->mouseFocus()->surface()->waylandClient();
     uint32_t time = compositor()->currentTimeMsecs();
     uint32_t serial = compositor()->nextSerial();
-    for (auto resource : resourceMap().values(client))
+    for (auto resource : resources(client))
         send_button(resource->handle, serial, time, q->toWaylandButton(button), state);
     return serial;
 }
@@ -36,10 +42,42 @@ void QWaylandPointerPrivate::sendMotion()
     uint32_t time = compositor()->currentTimeMsecs();
     wl_fixed_t x = wl_fixed_from_double(localPosition.x());
     wl_fixed_t y = wl_fixed_from_double(localPosition.y());
-    for (auto resource : resourceMap().values(enteredSurface->waylandClient()))
+    for (auto resource : resources(enteredSurface->waylandClient()))
         wl_pointer_send_motion(resource->handle, time, x, y);
 }
 
+void QWaylandPointerPrivate::sendFrame()
+{
+    Q_ASSERT(enteredSurface);
+    for (auto resource : resources(enteredSurface->waylandClient())) {
+        if (resource->version() >= WL_POINTER_FRAME_SINCE_VERSION)
+            send_frame(resource->handle);
+    }
+}
+
+/*
+    Sends the motion merged since the last output frame ahead of a button or axis
+    event, so that the client gets the events in the order they happened.
+*/
+void QWaylandPointerPrivate::sendMergedMotion()
+{
+    if (!std::exchange(motionPending, false) || !enteredSurface)
+        return;
+    sendMotion();
+}
+
+/*
+    Sends the motion merged since the last output frame, if any, as a single
+    motion event followed by a frame event.
+*/
+void QWaylandPointerPrivate::sendPendingMotion()
+{
+    if (!std::exchange(motionPending, false) || !enteredSurface)
+        return;
+    sendMotion();
+    sendFrame();
+}
+
 void QWaylandPointerPrivate::sendEnter(QWaylandSurface *surface)
 {
     Q_ASSERT(surface && !enteredSurface);
@@ -51,7 +89,7 @@ void QWaylandPointerPrivate::sendEnter(QWaylandSurface *surface)
 
     wl_fixed_t x = wl_fixed_from_double(localPosition.x());
     wl_fixed_t y = wl_fixed_from_double(localPosition.y());
-    for (auto resource : resourceMap().values(surface->waylandClient()))
+    for (auto resource : resources(surface->waylandClient()))
         send_enter(resource->handle, enterSerial, surface->resource(), x, y);
 
     enteredSurface = surface;
@@ -62,9 +100,10 @@ void QWaylandPointerPrivate::sendLeave()
 {
     Q_ASSERT(enteredSurface);
     uint32_t serial = compositor()->nextSerial();
-    for (auto resource : resourceMap().values(enteredSurface->waylandClient()))
+    for (auto resource : resources(enteredSurface->waylandClient()))
         send_leave(resource->handle, serial, enteredSurface->resource());
     localPosition = QPointF();
+    motionPending = false;
     enteredSurfaceDestroyListener.reset();
     enteredSurface = nullptr;
 }
@@ -110,6 +149,23 @@ void QWaylandPointerPrivate::pointer_set_cursor(wl_pointer::Resource *resource,
     }
 }
 
+QWaylandPointer *QWaylandPointerPrivate::fromResource(wl_resource *resource)
+{
+    if (auto *d = QtWayland::fromResource<QWaylandPointerPrivate *>(resource))
+        return d->q_func();
+    return nullptr;
+}
+
+/*
+    Returns whether the pointer is on a surface of client, and serial is the one
+    of the enter event that was sent for it.
+*/
+bool QWaylandPointerPrivate::hasEnterSerial(wl_client *client, uint32_t serial) const
+{
+    return enteredSurface && enteredSurface->client() && enteredSurface->client()->client() == client
+            && enterSerial == serial;
+}
+
 /*!
  * \class QWaylandPointer
  * \inmodule QtWaylandCompositor
@@ -222,11 +278,22 @@ void QWaylandPointer::sendMouseMoveEvent(QWaylandView *view, const QPointF &loca
         if (d->localPosition.y() == size.height())
             d->localPosition.ry() -= 0.01;
 
+        const bool entering = d->enteredSurface != view->surface();
         d->ensureEntered(view->surface());
-        d->sendMotion();
 
-        if (view->output())
-            setOutput(view->output());
+        // When batching, only the latest position is sent when the output starts
+        // its next frame. Motion that enters a surface still goes out right away.
+        QWaylandOutput *output = view->output();
+        if (!entering && output && QWaylandSeatPrivate::get(d->seat)->motionBatchingEnabled()) {
+            if (!std::exchange(d->motionPending, true))
+                output->update();
+        } else {
+            d->motionPending = false;
+            d->sendMotion();
+        }
+
+        if (output)
+            setOutput(output);
     }
 }
 
@@ -239,11 +306,12 @@ void QWaylandPointer::sendMouseWheelEvent(Qt::Orientation orientation, int delta
     if (!d->enteredSurface)
         return;
 
+    d->sendMergedMotion();
     uint32_t time = d->compositor()->currentTimeMsecs();
     uint32_t axis = orientation == Qt::Horizontal ? WL_POINTER_AXIS_HORIZONTAL_SCROLL
                                                   : WL_POINTER_AXIS_VERTICAL_SCROLL;
 
-    for (auto resource : d->resourceMap().values(d->enteredSurface->waylandClient()))
+    for (auto resource : d->resources(d->enteredSurface->waylandClient()))
         d->send_axis(resource->handle, time, axis, wl_fixed_from_int(-delta / 12));
 }
 
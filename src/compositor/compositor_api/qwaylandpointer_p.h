@@ -47,6 +47,11 @@ public:
 
     QWaylandCompositor *compositor() const { return seat->compositor(); }
 
+    static QWaylandPointerPrivate *get(QWaylandPointer *pointer) { return pointer->d_func(); }
+    static QWaylandPointer *fromResource(wl_resource *resource);
+    bool hasEnterSerial(wl_client *client, uint32_t serial) const;
+    void sendPendingMotion();
+
 protected:
     void pointer_set_cursor(Resource *resource, uint32_t serial, wl_resource *surface, int32_t hotspot_x, int32_t hotspot_y) override;
     void pointer_release(Resource *resource) override;
@@ -54,6 +59,8 @@ protected:
 private:
     uint sendButton(Qt::MouseButton button, uint32_t state);
     void sendMotion();
+    void sendFrame();
+    void sendMergedMotion();
     void sendEnter(QWaylandSurface *surface);
     void sendLeave();
     void ensureEntered(QWaylandSurface *surface);
@@ -68,6 +75,7 @@ private:
     uint enterSerial = 0;
 
     int buttonCount = 0;
+    bool motionPending = false;
 
     QWaylandDestroyListener enteredSurfaceDestroyListener;
 
@@ -20,6 +20,8 @@
 #include "qwaylandoutput.h"
 #include <QtWaylandCompositor/private/qwaylandcompositor_p.h>
 #include <QtWaylandCompositor/QWaylandViewporter>
+#include <QtWaylandCompositor/QWaylandFractionalScaleManagerV1>
+#include <QtWaylandCompositor/QWaylandSinglePixelBufferManagerV1>
 #include "qwaylandsurfacegrabber.h"
 
 QT_BEGIN_NAMESPACE
@@ -30,6 +32,8 @@ public:
     explicit QWaylandQuickCompositorPrivate(QWaylandCompositor *compositor)
         : QWaylandCompositorPrivate(compositor)
         , m_viewporter(new QWaylandViewporter(compositor))
+        , m_fractionalScaleManager(new QWaylandFractionalScaleManagerV1(compositor))
+        , m_singlePixelBufferManager(new QWaylandSinglePixelBufferManagerV1(compositor))
     {
     }
 protected:
@@ -39,6 +43,8 @@ protected:
     }
 private:
     QScopedPointer<QWaylandViewporter> m_viewporter;
+    QScopedPointer<QWaylandFractionalScaleManagerV1> m_fractionalScaleManager;
+    QScopedPointer<QWaylandSinglePixelBufferManagerV1> m_singlePixelBufferManager;
 };
 
 QWaylandQuickCompositor::QWaylandQuickCompositor(QObject *parent)
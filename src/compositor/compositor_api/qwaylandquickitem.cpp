@@ -17,6 +17,7 @@
 #endif
 #include <QtWaylandCompositor/private/qwlclientbufferintegration_p.h>
 #include <QtWaylandCompositor/private/qwaylandsurface_p.h>
+#include <QtWaylandCompositor/private/qwaylandview_p.h>
 
 #if QT_CONFIG(opengl)
 #  include <QtOpenGL/QOpenGLTexture>
@@ -26,11 +27,16 @@
 #include <QtGui/QKeyEvent>
 #include <QtGui/QGuiApplication>
 #include <QtGui/QScreen>
+#include <QtGui/QTransform>
 
-#include <QtQuick/QSGSimpleTextureNode>
+#include <QtQuick/QSGGeometryNode>
+#include <QtQuick/QSGRectangleNode>
+#include <QtQuick/QSGTextureMaterial>
 #include <QtQuick/QQuickWindow>
 #include <QtQuick/qsgtexture.h>
 
+#include <rhi/qrhi.h>
+
 #include <QtCore/QFile>
 #include <QtCore/QMutexLocker>
 #include <QtCore/QMutex>
@@ -368,6 +374,116 @@ void QWaylandBufferMaterial::setBufferRef(QWaylandQuickItem *surfaceItem, const
 
 QMutex *QWaylandQuickItemPrivate::mutex = nullptr;
 
+QWaylandSharedMemoryTexture::~QWaylandSharedMemoryTexture()
+{
+    delete m_texture;
+}
+
+qint64 QWaylandSharedMemoryTexture::comparisonKey() const
+{
+    if (m_texture)
+        return qint64(qintptr(m_texture));
+    return qint64(qintptr(this));
+}
+
+QRhiTexture *QWaylandSharedMemoryTexture::rhiTexture() const
+{
+    return m_texture;
+}
+
+QSize QWaylandSharedMemoryTexture::textureSize() const
+{
+    return m_image.size();
+}
+
+bool QWaylandSharedMemoryTexture::hasAlphaChannel() const
+{
+    return m_image.hasAlphaChannel();
+}
+
+bool QWaylandSharedMemoryTexture::hasMipmaps() const
+{
+    return false;
+}
+
+void QWaylandSharedMemoryTexture::setImage(const QImage &image, const QRegion &damage)
+{
+    if (image.size() != m_image.size() || image.format() != m_image.format())
+        m_fullUploadNeeded = true;
+    m_image = image;
+    m_dirtyRegion |= damage;
+}
+
+void QWaylandSharedMemoryTexture::commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates)
+{
+    if (m_image.isNull())
+        return;
+
+    QImage::Format uploadFormat = QImage::Format_RGBA8888_Premultiplied;
+    QRhiTexture::Format textureFormat = QRhiTexture::RGBA8;
+    switch (m_image.format()) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        if (rhi->isTextureFormatSupported(QRhiTexture::BGRA8)) {
+            uploadFormat = m_image.format();
+            textureFormat = QRhiTexture::BGRA8;
+        }
+        break;
+#endif
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+        uploadFormat = m_image.format();
+        break;
+    default:
+        break;
+    }
+
+    if (!m_texture || m_texture->pixelSize() != m_image.size() || m_texture->format() != textureFormat) {
+        delete m_texture;
+        m_texture = rhi->newTexture(textureFormat, m_image.size());
+        if (!m_texture->create()) {
+            qCWarning(qLcWaylandCompositor) << "Failed to create texture for shared memory buffer of size" << m_image.size();
+            delete m_texture;
+            m_texture = nullptr;
+            return;
+        }
+        m_fullUploadNeeded = true;
+    }
+
+    const QRect imageRect = m_image.rect();
+    if (m_fullUploadNeeded || m_dirtyRegion.boundingRect().contains(imageRect)) {
+        const QImage image = m_image.format() == uploadFormat ? m_image : m_image.convertToFormat(uploadFormat);
+        resourceUpdates->uploadTexture(m_texture, image);
+    } else if (!m_dirtyRegion.isEmpty()) {
+        QVarLengthArray<QRhiTextureUploadEntry, 8> entries;
+        for (const QRect &r : m_dirtyRegion) {
+            const QRect rect = r.intersected(imageRect);
+            if (rect.isEmpty())
+                continue;
+            QRhiTextureSubresourceUploadDescription description;
+            if (m_image.format() == uploadFormat) {
+                // Reference the shared memory directly, only the damaged rectangle is copied
+                description.setImage(m_image);
+                description.setSourceTopLeft(rect.topLeft());
+            } else {
+                description.setImage(m_image.copy(rect).convertToFormat(uploadFormat));
+            }
+            description.setSourceSize(rect.size());
+            description.setDestinationTopLeft(rect.topLeft());
+            entries.append(QRhiTextureUploadEntry(0, 0, description));
+        }
+        if (!entries.isEmpty()) {
+            QRhiTextureUploadDescription uploadDescription;
+            uploadDescription.setEntries(entries.cbegin(), entries.cend());
+            resourceUpdates->uploadTexture(m_texture, uploadDescription);
+        }
+    }
+
+    m_fullUploadNeeded = false;
+    m_dirtyRegion = QRegion();
+}
+
 class QWaylandSurfaceTextureProvider : public QSGTextureProvider
 {
 public:
@@ -380,15 +496,32 @@ public:
         delete m_sgTex;
     }
 
-    void setBufferRef(QWaylandQuickItem *surfaceItem, const QWaylandBufferRef &buffer)
+    void setBufferRef(QWaylandQuickItem *surfaceItem, const QWaylandBufferRef &buffer, const QRegion &damage)
     {
         Q_ASSERT(QThread::currentThread() == thread());
         m_ref = buffer;
+        const bool surfaceChanged = m_surface != surfaceItem->surface();
+        m_surface = surfaceItem->surface();
+        const bool isRhiBased = QSGRendererInterface::isApiRhiBased(surfaceItem->window()->rendererInterface()->graphicsApi());
+        if (m_ref.hasBuffer() && buffer.isSharedMemory() && isRhiBased && m_sharedMemoryTexture && !surfaceChanged) {
+            // Reuse the existing texture and only upload what has changed
+            m_sharedMemoryTexture->setImage(buffer.image(), damage);
+            emit textureChanged();
+            return;
+        }
+
         delete m_sgTex;
         m_sgTex = nullptr;
+        m_sharedMemoryTexture = nullptr;
         if (m_ref.hasBuffer()) {
             if (buffer.isSharedMemory()) {
-                m_sgTex = surfaceItem->window()->createTextureFromImage(buffer.image());
+                if (isRhiBased) {
+                    m_sharedMemoryTexture = new QWaylandSharedMemoryTexture;
+                    m_sharedMemoryTexture->setImage(buffer.image(), QRegion());
+                    m_sgTex = m_sharedMemoryTexture;
+                } else {
+                    m_sgTex = surfaceItem->window()->createTextureFromImage(buffer.image());
+                }
             } else {
 #if QT_CONFIG(opengl)
                 QQuickWindow::CreateTextureOptions opt;
@@ -420,9 +553,118 @@ public:
 private:
     bool m_smooth = false;
     QSGTexture *m_sgTex = nullptr;
+    QWaylandSharedMemoryTexture *m_sharedMemoryTexture = nullptr;
+    QPointer<QWaylandSurface> m_surface;
     QWaylandBufferRef m_ref;
 };
 
+/*
+    Draws a surface's texture in two parts: the opaque region the client
+    committed without blending, and the rest of the surface with blending.
+    The whole subtree is skipped by the renderer while the view is occluded.
+*/
+QWaylandSurfaceNode::QWaylandSurfaceNode()
+{
+    for (QSGGeometryNode *&part : m_parts) {
+        part = new QSGGeometryNode;
+        auto *geometry = new QSGGeometry(QSGGeometry::defaultAttributes_TexturedPoint2D(), 0);
+        geometry->setDrawingMode(QSGGeometry::DrawTriangles);
+        part->setGeometry(geometry);
+        part->setMaterial(new QSGTextureMaterial);
+        part->setOpaqueMaterial(new QSGOpaqueTextureMaterial);
+        part->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial | QSGNode::OwnsOpaqueMaterial);
+        appendChildNode(part);
+    }
+}
+
+bool QWaylandSurfaceNode::isSubtreeBlocked() const
+{
+    return m_occluded;
+}
+
+void QWaylandSurfaceNode::setOccluded(bool occluded)
+{
+    if (m_occluded == occluded)
+        return;
+    m_occluded = occluded;
+    markDirty(DirtySubtreeBlocked);
+}
+
+void QWaylandSurfaceNode::setFiltering(QSGTexture::Filtering filtering)
+{
+    for (QSGGeometryNode *part : m_parts) {
+        static_cast<QSGTextureMaterial *>(part->material())->setFiltering(filtering);
+        static_cast<QSGOpaqueTextureMaterial *>(part->opaqueMaterial())->setFiltering(filtering);
+    }
+}
+
+void QWaylandSurfaceNode::setTexture(QSGTexture *texture)
+{
+    for (QSGGeometryNode *part : m_parts) {
+        static_cast<QSGTextureMaterial *>(part->material())->setTexture(texture);
+        static_cast<QSGOpaqueTextureMaterial *>(part->opaqueMaterial())->setTexture(texture);
+        part->markDirty(DirtyMaterial);
+    }
+    // The client promised that these pixels are opaque, whatever the texture format
+    m_parts[Opaque]->opaqueMaterial()->setFlag(QSGMaterial::Blending, false);
+    m_parts[Translucent]->opaqueMaterial()->setFlag(QSGMaterial::Blending, texture && texture->hasAlphaChannel());
+    m_texture = texture;
+}
+
+/*
+    Maps the surface's destination area to rect in item coordinates and
+    sourceRect in texture pixels. The opaque region is in surface coordinates.
+    A rect with a negative height draws a texture with a bottom-left origin.
+*/
+void QWaylandSurfaceNode::update(const QRectF &rect, const QRectF &sourceRect, const QSize &destinationSize, const QRegion &opaqueRegion)
+{
+    if (!m_texture || destinationSize.isEmpty())
+        return;
+
+    const QRect destinationRect(QPoint(), destinationSize);
+    QRegion opaque = opaqueRegion & destinationRect;
+    // The rows of the texture are bottom-up then, but the opaque region is top-down
+    if (rect.height() < 0)
+        opaque = QTransform(1, 0, 0, -1, 0, destinationSize.height()).map(opaque);
+    updatePart(Opaque, opaque, rect, sourceRect, destinationSize);
+    updatePart(Translucent, QRegion(destinationRect) - opaque, rect, sourceRect, destinationSize);
+}
+
+void QWaylandSurfaceNode::updatePart(Part part, const QRegion &region, const QRectF &rect, const QRectF &sourceRect, const QSize &destinationSize)
+{
+    QSGGeometry *geometry = m_parts[part]->geometry();
+    if (geometry->vertexCount() != region.rectCount() * 6)
+        geometry->allocate(region.rectCount() * 6);
+
+    const qreal xScale = rect.width() / destinationSize.width();
+    const qreal yScale = rect.height() / destinationSize.height();
+    const qreal sourceXScale = sourceRect.width() / destinationSize.width();
+    const qreal sourceYScale = sourceRect.height() / destinationSize.height();
+    const QSizeF textureSize = m_texture->textureSize();
+    const QRectF subRect = m_texture->normalizedTextureSubRect();
+
+    QSGGeometry::TexturedPoint2D *v = geometry->vertexDataAsTexturedPoint2D();
+    for (const QRect &r : region) {
+        const float x0 = rect.x() + r.x() * xScale;
+        const float y0 = rect.y() + r.y() * yScale;
+        const float x1 = x0 + r.width() * xScale;
+        const float y1 = y0 + r.height() * yScale;
+        const float tx0 = subRect.x() + (sourceRect.x() + r.x() * sourceXScale) / textureSize.width() * subRect.width();
+        const float ty0 = subRect.y() + (sourceRect.y() + r.y() * sourceYScale) / textureSize.height() * subRect.height();
+        const float tx1 = tx0 + r.width() * sourceXScale / textureSize.width() * subRect.width();
+        const float ty1 = ty0 + r.height() * sourceYScale / textureSize.height() * subRect.height();
+
+        v[0].set(x0, y0, tx0, ty0);
+        v[1].set(x1, y0, tx1, ty0);
+        v[2].set(x0, y1, tx0, ty1);
+        v[3].set(x1, y0, tx1, ty0);
+        v[4].set(x1, y1, tx1, ty1);
+        v[5].set(x0, y1, tx0, ty1);
+        v += 6;
+    }
+    m_parts[part]->markDirty(DirtyGeometry);
+}
+
 void QWaylandQuickItemPrivate::handleDragUpdate(QWaylandSeat *seat, const QPointF &globalPosition)
 {
 #if QT_CONFIG(draganddrop)
@@ -1410,12 +1652,12 @@ void QWaylandQuickItem::updateOutput()
         return;
 
     if (d->connectedOutput)
-        disconnect(d->connectedOutput, &QWaylandOutput::scaleFactorChanged, this, &QWaylandQuickItem::updateSize);
+        disconnect(d->connectedOutput, &QWaylandOutput::fractionalScaleFactorChanged, this, &QWaylandQuickItem::updateSize);
 
     d->connectedOutput = d->view->output();
 
     if (d->connectedOutput)
-        connect(d->connectedOutput, &QWaylandOutput::scaleFactorChanged, this, &QWaylandQuickItem::updateSize);
+        connect(d->connectedOutput, &QWaylandOutput::fractionalScaleFactorChanged, this, &QWaylandQuickItem::updateSize);
 
     updateSize();
 }
@@ -1466,14 +1708,50 @@ void QWaylandQuickItem::updateInputMethod(Qt::InputMethodQueries queries)
  * \sa QWaylandQuickItem::bufferLocked
  */
 
+// Shows or hides the content of a node made by updatePaintNode(), as the view is occluded or not
+void QWaylandQuickItemPrivate::updateNodeOcclusion(QSGNode *node)
+{
+    Q_Q(QWaylandQuickItem);
+    const bool occluded = QWaylandViewPrivate::get(view.data())->occluded;
+
+    if (paintSolidColor) {
+        static_cast<QSGRectangleNode *>(node)->setRect(occluded ? QRectF() : QRectF(0, 0, q->width(), q->height()));
+        return;
+    }
+
+#if QT_CONFIG(opengl)
+    if (!paintByProvider) {
+        // The custom material can not be split into opaque and translucent parts,
+        // but nothing needs to be drawn while occluded
+        auto *geometryNode = static_cast<QSGGeometryNode *>(node);
+        QSGGeometry *geometry = geometryNode->geometry();
+        if (occluded) {
+            geometry->allocate(0);
+        } else {
+            if (geometry->vertexCount() != 4)
+                geometry->allocate(4);
+            QSGGeometry::updateTexturedRectGeometry(geometry, geometryRect, geometryTextureRect);
+        }
+        geometryNode->markDirty(QSGNode::DirtyGeometry);
+        return;
+    }
+#endif
+
+    static_cast<QWaylandSurfaceNode *>(node)->setOccluded(occluded);
+}
+
 QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
 {
     Q_D(QWaylandQuickItem);
     d->lastMatrix = data->transformNode->combinedMatrix();
     const bool bufferHasContent = d->view->currentBuffer().hasContent();
 
-    if (d->view->isBufferLocked() && d->paintEnabled)
+    if (d->view->isBufferLocked() && d->paintEnabled) {
+        // The content is kept, but the view may have become occluded or visible again
+        if (oldNode)
+            d->updateNodeOcclusion(oldNode);
         return oldNode;
+    }
 
     if (!bufferHasContent || !d->paintEnabled || !surface()) {
         delete oldNode;
@@ -1485,6 +1763,33 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
     const QRectF rect = invertY ? QRectF(0, height(), width(), -height())
                                 : QRectF(0, 0, width(), height());
 
+    // Single color buffers, typically scaled up with a viewport, need no texture at all
+    const QColor solidColor = ref.solidColor();
+    if (solidColor.isValid()) {
+        if (oldNode && !d->paintSolidColor) {
+            // Need to re-create a node
+            delete oldNode;
+            oldNode = nullptr;
+        }
+        d->paintSolidColor = true;
+
+        QSGRectangleNode *node = static_cast<QSGRectangleNode *>(oldNode);
+        if (!node)
+            node = window()->createRectangleNode();
+
+        d->newTexture = false;
+        d->view->takeBufferDamage();
+        node->setColor(solidColor);
+        d->updateNodeOcclusion(node);
+        return node;
+    }
+
+    if (oldNode && d->paintSolidColor) {
+        delete oldNode;
+        oldNode = nullptr;
+    }
+    d->paintSolidColor = false;
+
     if (ref.isSharedMemory()
 #if QT_CONFIG(opengl)
             || bufferTypes[ref.bufferFormatEgl()].canProvideTexture
@@ -1499,10 +1804,10 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
         d->paintByProvider = true;
 #endif
         // This case could covered by the more general path below, but this is more efficient (especially when using ShaderEffect items).
-        QSGSimpleTextureNode *node = static_cast<QSGSimpleTextureNode *>(oldNode);
+        QWaylandSurfaceNode *node = static_cast<QWaylandSurfaceNode *>(oldNode);
 
         if (!node) {
-            node = new QSGSimpleTextureNode();
+            node = new QWaylandSurfaceNode();
             if (smooth())
                 node->setFiltering(QSGTexture::Linear);
             d->newTexture = true;
@@ -1529,16 +1834,17 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
 
         if (d->newTexture) {
             d->newTexture = false;
-            d->provider->setBufferRef(this, ref);
+            d->provider->setBufferRef(this, ref, d->view->takeBufferDamage());
             node->setTexture(d->provider->texture());
         }
 
         d->provider->setSmooth(smooth());
-        node->setRect(rect);
+        d->updateNodeOcclusion(node);
 
         qreal scale = surface()->bufferScale();
         QRectF source = surface()->sourceGeometry();
-        node->setSourceRect(QRectF(source.topLeft() * scale, source.size() * scale));
+        node->update(rect, QRectF(source.topLeft() * scale, source.size() * scale),
+                     surface()->destinationSize(), QWaylandSurfacePrivate::get(surface())->opaqueRegion);
 
         return node;
     }
@@ -1572,6 +1878,7 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
     if (d->newTexture) {
         d->newTexture = false;
         material->setBufferRef(this, ref);
+        d->view->takeBufferDamage();
     }
 
     const QSize surfaceSize = ref.size() / surface()->bufferScale();
@@ -1584,14 +1891,16 @@ QSGNode *QWaylandQuickItem::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeDat
                      sourceGeometry.height() / surfaceSize.height())
             : QRectF(0, 0, 1, 1);
 
-    QSGGeometry::updateTexturedRectGeometry(geometry, rect, normalizedCoordinates);
-
     node->setGeometry(geometry);
     node->setFlag(QSGNode::OwnsGeometry, true);
 
     node->setMaterial(material);
     node->setFlag(QSGNode::OwnsMaterial, true);
 
+    d->geometryRect = rect;
+    d->geometryTextureRect = normalizedCoordinates;
+    d->updateNodeOcclusion(node);
+
     return node;
 #else
     qCWarning(qLcWaylandCompositor) << "Without OpenGL support only shared memory textures are supported";
@@ -1693,7 +2002,7 @@ void QWaylandQuickItem::handleDragStarted(QWaylandDrag *drag)
 
 qreal QWaylandQuickItemPrivate::scaleFactor() const
 {
-    qreal f = view->output() ? view->output()->scaleFactor() : 1;
+    qreal f = view->output() ? view->output()->fractionalScaleFactor() : 1;
 #if !defined(Q_OS_MACOS)
     if (window)
         f /= window->devicePixelRatio();
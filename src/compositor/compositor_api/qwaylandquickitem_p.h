@@ -18,6 +18,9 @@
 #include <QtQuick/private/qquickitem_p.h>
 #include <QtQuick/QSGMaterialShader>
 #include <QtQuick/QSGMaterial>
+#include <QtQuick/qsgtexture.h>
+#include <QtQuick/qsgnode.h>
+#include <QtGui/QRegion>
 
 #include <QtWaylandCompositor/QWaylandQuickItem>
 #include <QtWaylandCompositor/QWaylandOutput>
@@ -29,6 +32,54 @@ QT_BEGIN_NAMESPACE
 class QWaylandSurfaceTextureProvider;
 class QMutex;
 class QOpenGLTexture;
+class QRhiTexture;
+
+// Keeps the texture of a shared memory buffer alive across commits and only uploads what was
+// damaged since the last commitTextureOperations() call, as long as the size and format of the
+// buffer stay the same. Any other change causes a full upload.
+class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandSharedMemoryTexture : public QSGTexture
+{
+public:
+    ~QWaylandSharedMemoryTexture() override;
+
+    qint64 comparisonKey() const override;
+    QRhiTexture *rhiTexture() const override;
+    QSize textureSize() const override;
+    bool hasAlphaChannel() const override;
+    bool hasMipmaps() const override;
+
+    void setImage(const QImage &image, const QRegion &damage);
+    void commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates) override;
+
+private:
+    QImage m_image;
+    QRegion m_dirtyRegion;
+    QRhiTexture *m_texture = nullptr;
+    bool m_fullUploadNeeded = true;
+};
+
+// Draws the committed opaque region of a surface without blending, and the rest with blending
+class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandSurfaceNode : public QSGNode
+{
+public:
+    QWaylandSurfaceNode();
+
+    bool isSubtreeBlocked() const override;
+    void setOccluded(bool occluded);
+
+    void setFiltering(QSGTexture::Filtering filtering);
+    void setTexture(QSGTexture *texture);
+    void update(const QRectF &rect, const QRectF &sourceRect, const QSize &destinationSize, const QRegion &opaqueRegion);
+
+private:
+    enum Part { Opaque, Translucent, PartCount };
+
+    void updatePart(Part part, const QRegion &region, const QRectF &rect, const QRectF &sourceRect, const QSize &destinationSize);
+
+    QSGGeometryNode *m_parts[PartCount];
+    QSGTexture *m_texture = nullptr;
+    bool m_occluded = false;
+};
 
 #if QT_CONFIG(opengl)
 class QWaylandBufferMaterialShader : public QSGMaterialShader
@@ -133,6 +184,8 @@ public:
     virtual void raise();
     virtual void lower();
 
+    void updateNodeOcclusion(QSGNode *node);
+
     static QMutex *mutex;
 
     QScopedPointer<QWaylandView> view;
@@ -146,8 +199,12 @@ public:
     bool newTexture = false;
     bool focusOnClick = true;
     bool belowParent = false;
+    bool paintSolidColor = false;
 #if QT_CONFIG(opengl)
     bool paintByProvider = false;
+    // Where the custom material node draws, kept to restore it when it is no longer occluded
+    QRectF geometryRect;
+    QRectF geometryTextureRect;
 #endif
     QPointF hoverPos;
     QMatrix4x4 lastMatrix;
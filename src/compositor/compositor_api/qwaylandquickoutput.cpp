@@ -5,6 +5,10 @@
 #include "qwaylandquickoutput.h"
 #include "qwaylandquickcompositor.h"
 #include "qwaylandquickitem_p.h"
+#include "qwaylandsurface_p.h"
+#include "qwaylandview_p.h"
+
+#include <QtCore/QtMath>
 
 QT_BEGIN_NAMESPACE
 
@@ -119,6 +123,77 @@ QQuickItem *QWaylandQuickOutput::pickClickableItem(const QPointF &position)
     return clickableItemAtPosition(quickWindow->contentItem(), position);
 }
 
+// The largest pixel-aligned rectangle inside rect
+static QRect innerRect(const QRectF &rect)
+{
+    const QPoint topLeft(qCeil(rect.left()), qCeil(rect.top()));
+    const QPoint bottomRight(qFloor(rect.right()), qFloor(rect.bottom()));
+    return QRect(topLeft, bottomRight - QPoint(1, 1));
+}
+
+/*
+    Walks the items from top to bottom in paint order, marking the views of
+    items that are hidden, outside of the window, or completely covered by
+    opaque surfaces above them as occluded. Only wayland surfaces count as
+    occluders, and only if they are not rotated and fully opaque, including
+    the opacity of their ancestors. Items that are rendered into textures
+    (layers, ShaderEffectSource) may be shown anywhere, so they are never
+    occluded and never occlude.
+
+    Since occluded items are culled, the occlusion has to be exact: an item only
+    occludes if it draws the buffer that its surface's opaque region was
+    committed with, so not while its buffer is locked or painting is disabled.
+
+    Occluded items are not drawn at all, see QWaylandQuickItem::updatePaintNode.
+*/
+static void updateOcclusion(QQuickItem *item, const QRectF &clip, qreal opacity, bool offscreen, QRegion &opaque)
+{
+    QQuickItemPrivate *itemPrivate = QQuickItemPrivate::get(item);
+    opacity = item->isVisible() ? opacity * item->opacity() : 0;
+    const bool visible = opacity > 0;
+    offscreen = offscreen || (itemPrivate->extra.isAllocated() && itemPrivate->extra->effectRefCount > 0)
+            || (itemPrivate->layer() && itemPrivate->layer()->enabled());
+
+    QRectF itemClip = clip;
+    if (visible && item->clip())
+        itemClip &= item->mapRectToScene(item->clipRect());
+
+    const QList<QQuickItem *> children = itemPrivate->paintOrderChildItems();
+    auto negativeZStart = children.crend();
+    for (auto it = children.crbegin(); it != children.crend(); ++it) {
+        if ((*it)->z() < 0) {
+            negativeZStart = it;
+            break;
+        }
+        updateOcclusion(*it, itemClip, opacity, offscreen, opaque);
+    }
+
+    if (auto *waylandItem = qobject_cast<QWaylandQuickItem *>(item)) {
+        const QRect rect = (item->mapRectToScene(item->boundingRect()) & itemClip).toAlignedRect();
+        const bool occluded = !offscreen && (!visible || rect.isEmpty() || QRegion(rect).subtracted(opaque).isEmpty());
+        QWaylandViewPrivate *viewPrivate = QWaylandViewPrivate::get(waylandItem->view());
+        if (viewPrivate->occluded != occluded) {
+            viewPrivate->occluded = occluded;
+            item->update();
+        }
+
+        QWaylandSurface *surface = waylandItem->surface();
+        const bool axisAligned = itemPrivate->itemToWindowTransform().type() <= QTransform::TxScale;
+        const bool drawsCommittedState = waylandItem->isPaintEnabled() && !waylandItem->view()->isBufferLocked();
+        if (!occluded && !offscreen && visible && surface && surface->hasContent() && drawsCommittedState
+                && axisAligned && opacity >= 1) {
+            for (const QRect &r : QWaylandSurfacePrivate::get(surface)->opaqueRegion) {
+                const QRectF itemRect(waylandItem->mapFromSurface(r.topLeft()),
+                                      waylandItem->mapFromSurface(r.bottomRight() + QPoint(1, 1)));
+                opaque |= innerRect(item->mapRectToScene(itemRect) & itemClip);
+            }
+        }
+    }
+
+    for (auto it = negativeZStart; it != children.crend(); ++it)
+        updateOcclusion(*it, itemClip, opacity, offscreen, opaque);
+}
+
 /*!
  * \internal
  */
@@ -129,6 +204,12 @@ void QWaylandQuickOutput::updateStarted()
     if (!compositor())
         return;
 
+    // The scene graph is synchronizing, so it is safe to look at the items. The
+    // occlusion is used for culling, whether frame callbacks are throttled or not.
+    QQuickWindow *quickWindow = static_cast<QQuickWindow *>(window());
+    QRegion opaque;
+    updateOcclusion(quickWindow->contentItem(), QRectF(QPointF(), quickWindow->size()), 1, false, opaque);
+
     frameStarted();
 }
 
@@ -16,6 +16,8 @@
 #include <QtWaylandCompositor/private/qwaylandseat_p.h>
 #include <QtWaylandCompositor/private/qwaylandcompositor_p.h>
 #include <QtWaylandCompositor/private/qwaylandkeyboard_p.h>
+#include <QtWaylandCompositor/private/qwaylandpointer_p.h>
+#include <QtWaylandCompositor/private/qwaylandtouch_p.h>
 #if QT_CONFIG(wayland_datadevice)
 #include <QtWaylandCompositor/private/qwldatadevice_p.h>
 #endif
@@ -36,6 +38,7 @@ QWaylandSeatPrivate::QWaylandSeatPrivate(QWaylandSeat *seat) :
 #endif
     keymap(new QWaylandKeymap())
 {
+    motionBatching = qEnvironmentVariableIntValue("QT_WAYLAND_BATCH_INPUT_MOTION") != 0;
 }
 
 QWaylandSeatPrivate::~QWaylandSeatPrivate()
@@ -61,10 +64,8 @@ void QWaylandSeatPrivate::setCapabilities(QWaylandSeat::CapabilityFlags caps)
         }
 
         capabilities = caps;
-        QList<Resource *> resources = resourceMap().values();
-        for (int i = 0; i < resources.size(); i++) {
-            wl_seat::send_capabilities(resources.at(i)->handle, (uint32_t)capabilities);
-        }
+        for (Resource *resource : resources())
+            wl_seat::send_capabilities(resource->handle, (uint32_t)capabilities);
 
         if ((changed & caps & QWaylandSeat::Keyboard) && keyboardFocus != nullptr)
             keyboard->setFocus(keyboardFocus);
@@ -783,6 +784,80 @@ bool QWaylandSeat::isOwner(QInputEvent *inputEvent) const
     return true;
 }
 
+/*!
+ * \qmlproperty bool QtWayland.Compositor::WaylandSeat::motionBatchingEnabled
+ * \since 6.9
+ *
+ * This property holds whether pointer and touch motion is sent to clients once per
+ * output frame.
+ *
+ * When enabled, the motion events received between two frames of an output are
+ * merged, and only the latest position of the pointer and of each touch point is
+ * sent, followed by a frame event, when the output starts its next frame. Button,
+ * touch down and touch up events are still sent right away, with any motion merged
+ * before them in front, so clients see the events in the order they happened.
+ *
+ * The default is \c false, unless the \c QT_WAYLAND_BATCH_INPUT_MOTION environment
+ * variable is set to \c 1.
+ */
+
+/*!
+ * \property QWaylandSeat::motionBatchingEnabled
+ * \since 6.9
+ *
+ * This property holds whether pointer and touch motion is sent to clients once per
+ * output frame.
+ *
+ * When enabled, the motion events received between two frames of an output are
+ * merged, and only the latest position of the pointer and of each touch point is
+ * sent, followed by a frame event, when QWaylandOutput::frameStarted() is called.
+ * Button, touch down and touch up events are still sent right away, with any motion
+ * merged before them in front, so clients see the events in the order they happened.
+ * This reduces the number of times clients are woken up by high-rate input devices
+ * to one per frame.
+ *
+ * The default is \c false, unless the \c QT_WAYLAND_BATCH_INPUT_MOTION environment
+ * variable is set to \c 1.
+ *
+ * \sa sendPendingMotionEvents()
+ */
+bool QWaylandSeat::isMotionBatchingEnabled() const
+{
+    Q_D(const QWaylandSeat);
+    return d->motionBatching;
+}
+
+void QWaylandSeat::setMotionBatchingEnabled(bool enabled)
+{
+    Q_D(QWaylandSeat);
+    if (d->motionBatching == enabled)
+        return;
+
+    if (!enabled)
+        sendPendingMotionEvents();
+    d->motionBatching = enabled;
+    emit motionBatchingEnabledChanged();
+}
+
+/*!
+ * \since 6.9
+ *
+ * Sends the pointer and touch motion that has been merged since the last frame,
+ * each followed by a frame event. This is called for every seat of the compositor
+ * from QWaylandOutput::frameStarted(), so it is usually not necessary to call it
+ * manually.
+ *
+ * \sa motionBatchingEnabled
+ */
+void QWaylandSeat::sendPendingMotionEvents()
+{
+    Q_D(QWaylandSeat);
+    if (!d->pointer.isNull())
+        QWaylandPointerPrivate::get(d->pointer.data())->sendPendingMotion();
+    if (!d->touch.isNull())
+        QWaylandTouchPrivate::get(d->touch.data())->sendPendingMotion();
+}
+
 /*!
  * Returns the QWaylandSeat corresponding to the \a resource. The \a resource is expected
  * to have the type wl_seat.
@@ -39,6 +39,7 @@ class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandSeat : public QWaylandObject
     Q_PROPERTY(QWaylandKeymap *keymap READ keymap CONSTANT)
     Q_MOC_INCLUDE("qwaylandkeymap.h")
     Q_MOC_INCLUDE("qwaylandview.h")
+    Q_PROPERTY(bool motionBatchingEnabled READ isMotionBatchingEnabled WRITE setMotionBatchingEnabled NOTIFY motionBatchingEnabledChanged REVISION(6, 9))
 
     QML_NAMED_ELEMENT(WaylandSeat)
     QML_ADDED_IN_VERSION(1, 0)
@@ -106,6 +107,10 @@ public:
 
     virtual bool isOwner(QInputEvent *inputEvent) const;
 
+    bool isMotionBatchingEnabled() const;
+    void setMotionBatchingEnabled(bool enabled);
+    void sendPendingMotionEvents();
+
     static QWaylandSeat *fromSeatResource(struct ::wl_resource *resource);
 
 Q_SIGNALS:
@@ -115,6 +120,7 @@ Q_SIGNALS:
     void cursorSurfaceRequest(QWaylandSurface *surface, int hotspotX, int hotspotY);
 #endif
     void cursorSurfaceRequested(QWaylandSurface *surface, int hotspotX, int hotspotY, QWaylandClient *client);
+    Q_REVISION(6, 9) void motionBatchingEnabledChanged();
 
 private:
     void sendUnicodeKeyEvent(uint unicode, QEvent::Type type);
@@ -60,6 +60,8 @@ public:
 
     static QWaylandSeatPrivate *get(QWaylandSeat *device) { return device->d_func(); }
 
+    bool motionBatchingEnabled() const { return motionBatching; }
+
 #if QT_CONFIG(wayland_datadevice)
     void clientRequestedDataDevice(QtWayland::DataDeviceManager *dndSelection, struct wl_client *client, uint32_t id);
     QtWayland::DataDevice *dataDevice() const { return data_device.data(); }
@@ -83,6 +85,7 @@ private:
     QWaylandView *mouseFocus = nullptr;
     QWaylandSurface *keyboardFocus = nullptr;
     QWaylandSeat::CapabilityFlags capabilities;
+    bool motionBatching = false;
 
     QScopedPointer<QWaylandPointer> pointer;
     QScopedPointer<QWaylandKeyboard> keyboard;
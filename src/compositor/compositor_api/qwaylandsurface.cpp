@@ -21,6 +21,7 @@
 #include <QtWaylandCompositor/QWaylandBufferRef>
 
 #include <QtWaylandCompositor/private/qwaylandcompositor_p.h>
+#include <QtWaylandCompositor/private/qwaylandoutput_p.h>
 #include <QtWaylandCompositor/private/qwaylandview_p.h>
 #include <QtWaylandCompositor/private/qwaylandseat_p.h>
 #include <QtWaylandCompositor/private/qwaylandutils_p.h>
@@ -38,15 +39,13 @@ QT_BEGIN_NAMESPACE
 namespace QtWayland {
 class FrameCallback {
 public:
-    FrameCallback(QWaylandSurface *surf, wl_resource *res)
-        : surface(surf)
-        , resource(res)
+    void init(QWaylandSurface *surf, wl_resource *res)
     {
+        surface = surf;
+        resource = res;
+        canSend = false;
         wl_resource_set_implementation(res, nullptr, this, destroyCallback);
     }
-    ~FrameCallback()
-    {
-    }
     void destroy()
     {
         if (resource)
@@ -63,13 +62,62 @@ public:
     {
         FrameCallback *_this = static_cast<FrameCallback *>(wl_resource_get_user_data(res));
         if (_this->surface)
-            QWaylandSurfacePrivate::get(_this->surface)->removeFrameCallback(_this);
-        delete _this;
+            QWaylandSurfacePrivate::get(_this->surface)->releaseFrameCallback(_this);
+        else
+            delete _this;
     }
     QWaylandSurface *surface = nullptr;
     wl_resource *resource = nullptr;
     bool canSend = false;
+
+    FrameCallbackList *list = nullptr;
+    FrameCallback *prev = nullptr;
+    FrameCallback *next = nullptr;
 };
+
+void FrameCallbackList::append(FrameCallback *callback)
+{
+    Q_ASSERT(!callback->list);
+    callback->list = this;
+    callback->prev = m_last;
+    callback->next = nullptr;
+    if (m_last)
+        m_last->next = callback;
+    else
+        m_first = callback;
+    m_last = callback;
+}
+
+void FrameCallbackList::remove(FrameCallback *callback)
+{
+    Q_ASSERT(callback->list == this);
+    if (callback->prev)
+        callback->prev->next = callback->next;
+    else
+        m_first = callback->next;
+    if (callback->next)
+        callback->next->prev = callback->prev;
+    else
+        m_last = callback->prev;
+    callback->list = nullptr;
+    callback->prev = callback->next = nullptr;
+}
+
+void FrameCallbackList::splice(FrameCallbackList &other)
+{
+    if (other.isEmpty())
+        return;
+    for (FrameCallback *c = other.m_first; c; c = c->next)
+        c->list = this;
+    if (m_last) {
+        m_last->next = other.m_first;
+        other.m_first->prev = m_last;
+    } else {
+        m_first = other.m_first;
+    }
+    m_last = other.m_last;
+    other.m_first = other.m_last = nullptr;
+}
 }
 static QRegion infiniteRegion() {
     return QRegion(QRect(QPoint(std::numeric_limits<int>::min(), std::numeric_limits<int>::min()),
@@ -101,16 +149,44 @@ QWaylandSurfacePrivate::~QWaylandSurfacePrivate()
 
     bufferRef = QWaylandBufferRef();
 
-    for (QtWayland::FrameCallback *c : std::as_const(pendingFrameCallbacks))
-        c->destroy();
-    for (QtWayland::FrameCallback *c : std::as_const(frameCallbacks))
-        c->destroy();
+    for (const QPointer<QWaylandSurface> &child : std::as_const(subsurfaceChildren)) {
+        if (child && get(child)->subsurface)
+            get(child)->subsurface->parentSurface = nullptr;
+    }
+
+    for (QtWayland::FrameCallbackList *list : {&pendingFrameCallbacks, &cachedFrameCallbacks, &frameCallbacks}) {
+        while (QtWayland::FrameCallback *c = list->first()) {
+            list->remove(c);
+            c->surface = nullptr;
+            c->destroy();
+        }
+    }
+    qDeleteAll(unusedFrameCallbacks);
 }
 
-void QWaylandSurfacePrivate::removeFrameCallback(QtWayland::FrameCallback *callback)
+// Most clients have at most a couple of callbacks in flight per surface
+static constexpr qsizetype MaxUnusedFrameCallbacks = 4;
+
+QtWayland::FrameCallback *QWaylandSurfacePrivate::acquireFrameCallback(wl_resource *resource)
 {
-    pendingFrameCallbacks.removeOne(callback);
-    frameCallbacks.removeOne(callback);
+    Q_Q(QWaylandSurface);
+    QtWayland::FrameCallback *callback = unusedFrameCallbacks.isEmpty() ? new QtWayland::FrameCallback
+                                                                        : unusedFrameCallbacks.takeLast();
+    callback->init(q, resource);
+    return callback;
+}
+
+// Called when the callback's resource is destroyed, either after being sent or by the client
+void QWaylandSurfacePrivate::releaseFrameCallback(QtWayland::FrameCallback *callback)
+{
+    if (callback->list)
+        callback->list->remove(callback);
+    callback->surface = nullptr;
+    callback->resource = nullptr;
+    if (unusedFrameCallbacks.size() < MaxUnusedFrameCallbacks)
+        unusedFrameCallbacks.append(callback);
+    else
+        delete callback;
 }
 
 void QWaylandSurfacePrivate::notifyViewsAboutDestruction()
@@ -126,6 +202,30 @@ void QWaylandSurfacePrivate::notifyViewsAboutDestruction()
     }
 }
 
+/*
+    Maps the committed \a surfaceDamage to the buffer coordinate system, taking the
+    buffer scale and the viewport source and destination into account.
+*/
+QRegion QWaylandSurfacePrivate::damageInBufferCoordinates(const QRegion &surfaceDamage) const
+{
+    const QRect bufferRect(QPoint(), bufferSize);
+    if (surfaceDamage.isEmpty() || bufferRect.isEmpty())
+        return QRegion();
+    if (destinationSize.isEmpty())
+        return bufferRect;
+
+    const qreal sx = sourceGeometry.width() / destinationSize.width();
+    const qreal sy = sourceGeometry.height() / destinationSize.height();
+    QRegion result;
+    for (const QRect &r : surfaceDamage) {
+        const QRectF mapped(sourceGeometry.x() + r.x() * sx, sourceGeometry.y() + r.y() * sy,
+                            r.width() * sx, r.height() * sy);
+        const QRectF scaled(mapped.topLeft() * bufferScale, mapped.size() * bufferScale);
+        result |= scaled.toAlignedRect().intersected(bufferRect);
+    }
+    return result;
+}
+
 #ifndef QT_NO_DEBUG
 void QWaylandSurfacePrivate::addUninitializedSurface(QWaylandSurfacePrivate *surface)
 {
@@ -187,9 +287,8 @@ void QWaylandSurfacePrivate::surface_damage_buffer(Resource *, int32_t x, int32_
 
 void QWaylandSurfacePrivate::surface_frame(Resource *resource, uint32_t callback)
 {
-    Q_Q(QWaylandSurface);
     struct wl_resource *frame_callback = wl_resource_create(resource->client(), &wl_callback_interface, wl_callback_interface.version, callback);
-    pendingFrameCallbacks << new QtWayland::FrameCallback(q, frame_callback);
+    pendingFrameCallbacks.append(acquireFrameCallback(frame_callback));
 }
 
 void QWaylandSurfacePrivate::surface_set_opaque_region(Resource *, struct wl_resource *region)
@@ -207,6 +306,67 @@ void QWaylandSurfacePrivate::surface_set_input_region(Resource *, struct wl_reso
 }
 
 void QWaylandSurfacePrivate::surface_commit(Resource *)
+{
+    if (isSubsurface() && isSynchronized()) {
+        // The state is applied together with the parent's state
+        cacheState();
+        return;
+    }
+
+    if (hasCachedState) {
+        // Left over from when the subsurface was synchronized, apply it all at once
+        cacheState();
+        commitState(cached, cachedFrameCallbacks);
+    } else {
+        commitState(pending, pendingFrameCallbacks);
+    }
+}
+
+/*
+    Moves the pending state to the cached state of a synchronized subsurface,
+    merging it with what has already been cached.
+*/
+void QWaylandSurfacePrivate::cacheState()
+{
+    if (pending.buffer.hasBuffer() || pending.newlyAttached) {
+        cached.buffer = pending.buffer;
+        cached.newlyAttached = true;
+    }
+    cached.offset += pending.offset;
+    cached.surfaceDamage |= pending.surfaceDamage;
+    cached.bufferDamage |= pending.bufferDamage;
+    cached.inputRegion = pending.inputRegion;
+    cached.bufferScale = pending.bufferScale;
+    cached.sourceGeometry = pending.sourceGeometry;
+    cached.destinationSize = pending.destinationSize;
+    cached.opaqueRegion = pending.opaqueRegion;
+    cachedFrameCallbacks.splice(pendingFrameCallbacks);
+    hasCachedState = true;
+
+    pending.buffer = QWaylandBufferRef();
+    pending.offset = QPoint();
+    pending.newlyAttached = false;
+    pending.bufferDamage = QRegion();
+    pending.surfaceDamage = QRegion();
+}
+
+/*
+    Applies the cached state of all synchronized subsurfaces. This is done right
+    after the surface's own state has been applied, recursively.
+*/
+void QWaylandSurfacePrivate::commitCachedStateOfChildren()
+{
+    const auto children = subsurfaceChildren;
+    for (const QPointer<QWaylandSurface> &child : children) {
+        if (!child)
+            continue;
+        QWaylandSurfacePrivate *d = get(child);
+        if (d->hasCachedState && d->isSynchronized())
+            d->commitState(d->cached, d->cachedFrameCallbacks);
+    }
+}
+
+void QWaylandSurfacePrivate::commitState(SurfaceState &state, QtWayland::FrameCallbackList &stateFrameCallbacks)
 {
     Q_Q(QWaylandSurface);
 
@@ -216,23 +376,24 @@ void QWaylandSurfacePrivate::surface_commit(Resource *)
     QSize oldDestinationSize = destinationSize;
     bool oldHasContent = hasContent;
     int oldBufferScale = bufferScale;
+    QtWayland::ClientBuffer *oldBuffer = bufferRef.buffer();
 
     // Update all internal state
-    if (pending.buffer.hasBuffer() || pending.newlyAttached)
-        bufferRef = pending.buffer;
-    bufferScale = pending.bufferScale;
+    if (state.buffer.hasBuffer() || state.newlyAttached)
+        bufferRef = state.buffer;
+    bufferScale = state.bufferScale;
     bufferSize = bufferRef.size();
     QSize surfaceSize = bufferSize / bufferScale;
-    sourceGeometry = !pending.sourceGeometry.isValid() ? QRect(QPoint(), surfaceSize) : pending.sourceGeometry;
-    destinationSize = pending.destinationSize.isEmpty() ? sourceGeometry.size().toSize() : pending.destinationSize;
+    sourceGeometry = !state.sourceGeometry.isValid() ? QRect(QPoint(), surfaceSize) : state.sourceGeometry;
+    destinationSize = state.destinationSize.isEmpty() ? sourceGeometry.size().toSize() : state.destinationSize;
     QRect destinationRect(QPoint(), destinationSize);
-    // pending.damage is already in surface coordinates
-    damage = pending.surfaceDamage.intersected(destinationRect);
-    if (!pending.bufferDamage.isNull()) {
+    // state.surfaceDamage is already in surface coordinates
+    damage = state.surfaceDamage.intersected(destinationRect);
+    if (!state.bufferDamage.isNull()) {
         if (bufferScale == 1) {
-            damage |= pending.bufferDamage.intersected(destinationRect); // Already in surface coordinates
+            damage |= state.bufferDamage.intersected(destinationRect); // Already in surface coordinates
         } else {
-            // We must transform pending.damage from buffer coordinate system to surface coordinates
+            // We must transform state.bufferDamage from buffer coordinate system to surface coordinates
             // TODO(QTBUG-85461): Also support wp_viewport setting more complex transformations
             auto xform = [](const QRect &r, int scale) -> QRect {
                 QRect res{
@@ -241,38 +402,47 @@ void QWaylandSurfacePrivate::surface_commit(Resource *)
                 };
                 return res;
             };
-            for (const QRect &r : pending.bufferDamage)
+            for (const QRect &r : state.bufferDamage)
                 damage |= xform(r, bufferScale).intersected(destinationRect);
         }
     }
     hasContent = bufferRef.hasContent();
-    frameCallbacks << pendingFrameCallbacks;
-    inputRegion = pending.inputRegion.intersected(destinationRect);
-    opaqueRegion = pending.opaqueRegion.intersected(destinationRect);
+    frameCallbacks.splice(stateFrameCallbacks);
+    inputRegion = state.inputRegion.intersected(destinationRect);
+    opaqueRegion = state.opaqueRegion.intersected(destinationRect);
     bool becameOpaque = opaqueRegion.boundingRect().contains(destinationRect);
     if (becameOpaque != isOpaque) {
         isOpaque = becameOpaque;
         emit q->isOpaqueChanged();
     }
 
-    QPoint offsetForNextFrame = pending.offset;
+    QPoint offsetForNextFrame = state.offset;
 
     if (viewport)
-        viewport->checkCommittedState();
+        viewport->checkCommittedState(state.destinationSize, state.sourceGeometry);
 
     // Clear per-commit state
-    pending.buffer = QWaylandBufferRef();
-    pending.offset = QPoint();
-    pending.newlyAttached = false;
-    pending.bufferDamage = QRegion();
-    pending.surfaceDamage = QRegion();
-    pendingFrameCallbacks.clear();
+    state.buffer = QWaylandBufferRef();
+    state.offset = QPoint();
+    state.newlyAttached = false;
+    state.bufferDamage = QRegion();
+    state.surfaceDamage = QRegion();
+    hasCachedState = false;
 
     // Notify buffers and views
-    if (auto *buffer = bufferRef.buffer())
+    if (auto *buffer = bufferRef.buffer()) {
+        // The damage only describes the changes to this buffer if it also held the previous contents
+        if (buffer->isSharedMemory()) {
+            buffer->addBufferDamage(buffer == oldBuffer ? damageInBufferCoordinates(damage)
+                                                        : QRegion(QRect(QPoint(), bufferSize)));
+        }
         buffer->setCommitted(damage);
-    for (auto *view : std::as_const(views))
+    }
+    for (auto *view : std::as_const(views)) {
         view->bufferCommitted(bufferRef, damage);
+        if (QWaylandOutput *output = view->output())
+            QWaylandOutputPrivate::get(output)->scheduleFrame(q);
+    }
 
     // Now all double-buffered state has been applied so it's safe to emit general signals
     // i.e. we won't have inconsistensies such as mismatched surface size and buffer scale in
@@ -299,6 +469,8 @@ void QWaylandSurfacePrivate::surface_commit(Resource *)
         emit q->offsetForNextFrame(offsetForNextFrame);
 
     emit q->redraw();
+
+    commitCachedStateOfChildren();
 }
 
 void QWaylandSurfacePrivate::surface_set_buffer_transform(Resource *resource, int32_t orientation)
@@ -700,7 +872,7 @@ QWaylandCompositor *QWaylandSurface::compositor() const
 void QWaylandSurface::frameStarted()
 {
     Q_D(QWaylandSurface);
-    for (QtWayland::FrameCallback *c : std::as_const(d->frameCallbacks))
+    for (QtWayland::FrameCallback *c = d->frameCallbacks.first(); c; c = c->next)
         c->canSend = true;
 }
 
@@ -711,15 +883,12 @@ void QWaylandSurface::sendFrameCallbacks()
 {
     Q_D(QWaylandSurface);
     uint time = d->compositor->currentTimeMsecs();
-    int i = 0;
-    while (i < d->frameCallbacks.size()) {
-        if (d->frameCallbacks.at(i)->canSend) {
-            d->frameCallbacks.at(i)->surface = nullptr;
-            d->frameCallbacks.at(i)->send(time);
-            d->frameCallbacks.removeAt(i);
-        } else {
-            i++;
-        }
+    QtWayland::FrameCallback *c = d->frameCallbacks.first();
+    while (c) {
+        QtWayland::FrameCallback *next = c->next;
+        if (c->canSend)
+            c->send(time); // Unlinks the callback and returns it to the pool
+        c = next;
     }
 }
 
@@ -1063,15 +1232,27 @@ void QWaylandSurfacePrivate::Subsurface::subsurface_place_below(wl_subsurface::R
 void QWaylandSurfacePrivate::Subsurface::subsurface_set_sync(wl_subsurface::Resource *resource)
 {
     Q_UNUSED(resource);
-    // TODO: sync/desync implementation
-    qDebug() << Q_FUNC_INFO;
+    synchronized = true;
 }
 
 void QWaylandSurfacePrivate::Subsurface::subsurface_set_desync(wl_subsurface::Resource *resource)
 {
     Q_UNUSED(resource);
-    // TODO: sync/desync implementation
-    qDebug() << Q_FUNC_INFO;
+    // Any cached state is applied together with the next commit of the surface
+    synchronized = false;
+}
+
+/*
+    A subsurface is effectively synchronized if it, or any of its ancestors,
+    is in synchronized mode.
+*/
+bool QWaylandSurfacePrivate::isSynchronized() const
+{
+    for (const QWaylandSurfacePrivate *s = this; s && s->subsurface; s = s->subsurface->parentSurface) {
+        if (s->subsurface->synchronized)
+            return true;
+    }
+    return false;
 }
 
 /*!
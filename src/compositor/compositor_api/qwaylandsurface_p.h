@@ -26,6 +26,7 @@
 #include <QtWaylandCompositor/private/qwlregion_p.h>
 
 #include <QtCore/QList>
+#include <QtCore/QVarLengthArray>
 #include <QtCore/QRect>
 #include <QtGui/QRegion>
 #include <QtGui/QImage>
@@ -38,6 +39,7 @@
 
 #include <QtWaylandCompositor/private/qwayland-server-wayland.h>
 #include <QtWaylandCompositor/private/qwaylandviewporter_p.h>
+#include <QtWaylandCompositor/private/qwaylandfractionalscalev1_p.h>
 #include <QtWaylandCompositor/private/qwaylandidleinhibitv1_p.h>
 
 #include <QtCore/qpointer.h>
@@ -51,6 +53,23 @@ class QWaylandInputMethodControl;
 
 namespace QtWayland {
 class FrameCallback;
+
+// Intrusive list of frame callbacks, a callback is in at most one list at a time
+class FrameCallbackList
+{
+public:
+    bool isEmpty() const { return !m_first; }
+    FrameCallback *first() const { return m_first; }
+
+    void append(FrameCallback *callback);
+    void remove(FrameCallback *callback);
+    // Moves all callbacks of other to the end of this list
+    void splice(FrameCallbackList &other);
+
+private:
+    FrameCallback *m_first = nullptr;
+    FrameCallback *m_last = nullptr;
+};
 }
 
 class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandSurfacePrivate : public QObjectPrivate, public QtWaylandServer::wl_surface
@@ -69,10 +88,13 @@ public:
 
     using QtWaylandServer::wl_surface::resource;
 
-    void removeFrameCallback(QtWayland::FrameCallback *callback);
+    QtWayland::FrameCallback *acquireFrameCallback(wl_resource *resource);
+    void releaseFrameCallback(QtWayland::FrameCallback *callback);
 
     void notifyViewsAboutDestruction();
 
+    QRegion damageInBufferCoordinates(const QRegion &surfaceDamage) const;
+
 #ifndef QT_NO_DEBUG
     static void addUninitializedSurface(QWaylandSurfacePrivate *surface);
     static void removeUninitializedSurface(QWaylandSurfacePrivate *surface);
@@ -82,6 +104,7 @@ public:
     void initSubsurface(QWaylandSurface *parent, struct ::wl_client *client, int id, int version);
     bool isSubsurface() const { return subsurface; }
     QWaylandSurfacePrivate *parentSurface() const { return subsurface ? subsurface->parentSurface : nullptr; }
+    bool isSynchronized() const;
 
 protected:
     void surface_destroy_resource(Resource *resource) override;
@@ -104,6 +127,11 @@ protected:
 
     QtWayland::ClientBuffer *getBuffer(struct ::wl_resource *buffer);
 
+    void cacheState();
+    void commitState(SurfaceState &state, QtWayland::FrameCallbackList &stateFrameCallbacks);
+    void commitCachedStateOfChildren();
+    bool hasFrameCallbacks() const { return !frameCallbacks.isEmpty(); }
+
 public: //member variables
     QWaylandCompositor *compositor = nullptr;
     int refCount = 1;
@@ -113,8 +141,9 @@ public: //member variables
     QWaylandBufferRef bufferRef;
     QWaylandSurfaceRole *role = nullptr;
     QWaylandViewporterPrivate::Viewport *viewport = nullptr;
+    QWaylandFractionalScaleManagerV1Private::FractionalScale *fractionalScale = nullptr;
 
-    struct {
+    struct SurfaceState {
         QWaylandBufferRef buffer;
         QRegion surfaceDamage;
         QRegion bufferDamage;
@@ -125,13 +154,21 @@ public: //member variables
         QRectF sourceGeometry;
         QSize destinationSize;
         QRegion opaqueRegion;
-    } pending;
+    };
+
+    SurfaceState pending;
+    // State committed by a synchronized subsurface, applied when the parent's state is applied
+    SurfaceState cached;
+    bool hasCachedState = false;
 
     QPoint lastLocalMousePos;
     QPoint lastGlobalMousePos;
 
-    QList<QtWayland::FrameCallback *> pendingFrameCallbacks;
-    QList<QtWayland::FrameCallback *> frameCallbacks;
+    QtWayland::FrameCallbackList pendingFrameCallbacks;
+    QtWayland::FrameCallbackList cachedFrameCallbacks;
+    QtWayland::FrameCallbackList frameCallbacks;
+    // Recycled callbacks, so that clients requesting one per frame cause no allocations
+    QVarLengthArray<QtWayland::FrameCallback *, 4> unusedFrameCallbacks;
 
     QList<QPointer<QWaylandSurface>> subsurfaceChildren;
 
@@ -173,6 +210,7 @@ public: //member variables
         QWaylandSurfacePrivate *surface = nullptr;
         QWaylandSurfacePrivate *parentSurface = nullptr;
         QPoint position;
+        bool synchronized = true;
     };
 
     Subsurface *subsurface = nullptr;
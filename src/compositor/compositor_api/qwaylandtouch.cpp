@@ -8,9 +8,13 @@
 #include <QtWaylandCompositor/QWaylandSeat>
 #include <QtWaylandCompositor/QWaylandView>
 #include <QtWaylandCompositor/QWaylandClient>
+#include <QtWaylandCompositor/QWaylandOutput>
 
+#include <QtWaylandCompositor/private/qwaylandseat_p.h>
 #include <QtWaylandCompositor/private/qwlqttouch_p.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 QWaylandTouchPrivate::QWaylandTouchPrivate(QWaylandTouch *touch, QWaylandSeat *seat)
@@ -31,10 +35,12 @@ uint QWaylandTouchPrivate::sendDown(QWaylandSurface *surface, uint32_t time, int
     if (!focusResource)
         return 0;
 
+    sendMergedMotion(surface->client());
     uint32_t serial = q->compositor()->nextSerial();
 
     wl_touch_send_down(focusResource->handle, serial, time, surface->resource(), touch_id,
                        wl_fixed_from_double(position.x()), wl_fixed_from_double(position.y()));
+    markUnframed(surface->client());
     return serial;
 }
 
@@ -45,9 +51,11 @@ uint QWaylandTouchPrivate::sendUp(QWaylandClient *client, uint32_t time, int tou
     if (!focusResource)
         return 0;
 
+    sendMergedMotion(client);
     uint32_t serial = compositor()->nextSerial();
 
     wl_touch_send_up(focusResource->handle, serial, time, touch_id);
+    markUnframed(client);
     return serial;
 }
 
@@ -60,6 +68,84 @@ void QWaylandTouchPrivate::sendMotion(QWaylandClient *client, uint32_t time, int
 
     wl_touch_send_motion(focusResource->handle, time, touch_id,
                          wl_fixed_from_double(position.x()), wl_fixed_from_double(position.y()));
+    markUnframed(client);
+}
+
+/*
+    Merges the motion of a touch point with the motion it had since the last output
+    frame, returns false when the motion should be sent right away instead.
+*/
+bool QWaylandTouchPrivate::batchMotion(QWaylandSurface *surface, uint32_t time, int touch_id, const QPointF &position)
+{
+    if (!QWaylandSeatPrivate::get(seat)->motionBatchingEnabled())
+        return false;
+
+    QWaylandView *view = surface->primaryView();
+    QWaylandOutput *output = view ? view->output() : nullptr;
+    if (!output)
+        return false;
+
+    QWaylandClient *client = surface->client();
+    for (PendingMotion &motion : pendingMotion) {
+        if (motion.client == client && motion.id == touch_id) {
+            motion.position = position;
+            motion.time = time;
+            return true;
+        }
+    }
+
+    pendingMotion.append({client, touch_id, position, time});
+    output->update();
+    return true;
+}
+
+/*
+    Sends the merged motion of the touch points of client without a frame event,
+    so that it goes out ahead of a touch down, up or frame event.
+*/
+void QWaylandTouchPrivate::sendMergedMotion(QWaylandClient *client)
+{
+    for (auto it = pendingMotion.begin(); it != pendingMotion.end();) {
+        if (!it->client) {
+            it = pendingMotion.erase(it);
+        } else if (it->client == client) {
+            sendMotion(client, it->time, it->id, it->position);
+            it = pendingMotion.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool QWaylandTouchPrivate::hasPendingMotion(QWaylandClient *client) const
+{
+    return std::any_of(pendingMotion.cbegin(), pendingMotion.cend(), [client](const PendingMotion &motion) {
+        return motion.client == client;
+    });
+}
+
+void QWaylandTouchPrivate::markUnframed(QWaylandClient *client)
+{
+    if (QWaylandSeatPrivate::get(seat)->motionBatchingEnabled() && !unframedClients.contains(client->client()))
+        unframedClients.append(client->client());
+}
+
+/*
+    Sends the motion merged since the last output frame, followed by a frame
+    event for each client.
+*/
+void QWaylandTouchPrivate::sendPendingMotion()
+{
+    Q_Q(QWaylandTouch);
+    while (!pendingMotion.isEmpty()) {
+        QPointer<QWaylandClient> client = pendingMotion.constFirst().client;
+        if (!client) {
+            pendingMotion.removeFirst();
+            continue;
+        }
+        sendMergedMotion(client);
+        q->sendFrameEvent(client);
+    }
 }
 
 int QWaylandTouchPrivate::toSequentialWaylandId(int touchId)
@@ -128,7 +214,8 @@ uint QWaylandTouch::sendTouchPointEvent(QWaylandSurface *surface, int id, const
         serial = d->sendDown(surface, time, id, position);
         break;
     case Qt::TouchPointMoved:
-        d->sendMotion(surface->client(), time, id, position);
+        if (!d->batchMotion(surface, time, id, position))
+            d->sendMotion(surface->client(), time, id, position);
         break;
     case Qt::TouchPointReleased:
         serial = d->sendUp(surface->client(), time, id);
@@ -147,10 +234,23 @@ uint QWaylandTouch::sendTouchPointEvent(QWaylandSurface *surface, int id, const
 /*!
  * Sends a touch frame event to the touch device of a \a client. This indicates the end of a
  * contact point list.
+ *
+ * When motion batching is enabled for the seat and the client only got motion since the
+ * last frame event, the frame event is held back and sent with the motion when the output
+ * starts its next frame.
+ *
+ * \sa QWaylandSeat::motionBatchingEnabled
  */
 void QWaylandTouch::sendFrameEvent(QWaylandClient *client)
 {
     Q_D(QWaylandTouch);
+    if (QWaylandSeatPrivate::get(d->seat)->motionBatchingEnabled()) {
+        const bool unframed = d->unframedClients.removeOne(client->client());
+        if (!unframed && d->hasPendingMotion(client))
+            return;
+        d->sendMergedMotion(client);
+    }
+
     auto focusResource = d->resourceMap().value(client->client());
     if (focusResource)
         d->send_frame(focusResource->handle);
@@ -162,6 +262,10 @@ void QWaylandTouch::sendFrameEvent(QWaylandClient *client)
 void QWaylandTouch::sendCancelEvent(QWaylandClient *client)
 {
     Q_D(QWaylandTouch);
+    d->pendingMotion.removeIf([client](const auto &motion) {
+        return motion.client == client;
+    });
+    d->unframedClients.removeOne(client->client());
     auto focusResource = d->resourceMap().value(client->client());
     if (focusResource)
         d->send_cancel(focusResource->handle);
@@ -22,8 +22,11 @@
 #include <QtWaylandCompositor/QWaylandSeat>
 #include <QtWaylandCompositor/QWaylandView>
 #include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/QWaylandClient>
 
+#include <QtCore/QList>
 #include <QtCore/QPoint>
+#include <QtCore/QPointer>
 #include <QtCore/qvarlengtharray.h>
 #include <QtCore/private/qobject_p.h>
 
@@ -39,16 +42,33 @@ public:
 
     QWaylandCompositor *compositor() const { return seat->compositor(); }
 
+    static QWaylandTouchPrivate *get(QWaylandTouch *touch) { return touch->d_func(); }
+
     uint sendDown(QWaylandSurface *surface, uint32_t time, int touch_id, const QPointF &position);
     void sendMotion(QWaylandClient *client, uint32_t time, int touch_id, const QPointF &position);
     uint sendUp(QWaylandClient *client, uint32_t time, int touch_id);
+    void sendPendingMotion();
 
 private:
     void touch_release(Resource *resource) override;
     int toSequentialWaylandId(int touchId);
+    bool batchMotion(QWaylandSurface *surface, uint32_t time, int touch_id, const QPointF &position);
+    void sendMergedMotion(QWaylandClient *client);
+    bool hasPendingMotion(QWaylandClient *client) const;
+    void markUnframed(QWaylandClient *client);
+
+    struct PendingMotion {
+        QPointer<QWaylandClient> client;
+        int id;
+        QPointF position;
+        uint32_t time;
+    };
 
     QWaylandSeat *seat = nullptr;
     QVarLengthArray<int, 10> ids;
+    QList<PendingMotion> pendingMotion;
+    // Clients that got touch events since their last frame event
+    QList<wl_client *> unframedClients;
 };
 
 QT_END_NAMESPACE
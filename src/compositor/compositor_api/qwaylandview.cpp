@@ -116,6 +116,8 @@ void QWaylandViewPrivate::setSurface(QWaylandSurface *newSurface)
     nextBuffer = QWaylandBufferRef();
     nextBufferCommitted = false;
     nextDamage = QRegion();
+    nextBufferDamage = QRegion();
+    bufferDamage = QRegion();
 
     if (surface) {
         QWaylandSurfacePrivate::get(surface)->refView(q);
@@ -181,16 +183,23 @@ void QWaylandView::setOutput(QWaylandOutput *newOutput)
  * This function is called when a new \a buffer is committed to this view's surface.
  * \a damage contains the region that is different from the current buffer, i.e. the
  * region that needs to be updated.
- * The new \a buffer will become current on the next call to advance().
+ * The new \a buffer will become current on the next call to advance(). If the surface
+ * is committed several times before advance() is called, the damage of all the commits
+ * is accumulated.
  *
  * Subclasses that reimplement this function \e must call the base implementation.
  */
 void QWaylandView::bufferCommitted(const QWaylandBufferRef &buffer, const QRegion &damage)
 {
     Q_D(QWaylandView);
+    // Transform while the surface state still matches the one the damage was committed with
+    const QRegion bufferDamage = d->surface
+            ? QWaylandSurfacePrivate::get(d->surface)->damageInBufferCoordinates(damage)
+            : QRegion();
     QMutexLocker locker(&d->bufferMutex);
     d->nextBuffer = buffer;
-    d->nextDamage = damage;
+    d->nextDamage |= damage;
+    d->nextBufferDamage |= bufferDamage;
     d->nextBufferCommitted = true;
 }
 
@@ -224,6 +233,16 @@ bool QWaylandView::advance()
     d->nextBufferCommitted = false;
     d->currentBuffer = d->nextBuffer;
     d->currentDamage = d->nextDamage;
+    d->nextDamage = QRegion();
+    d->bufferDamage |= d->nextBufferDamage;
+    d->nextBufferDamage = QRegion();
+
+    // The damage is kept until it is taken, which may never happen, so keep it from growing
+    const QRect bufferRect(QPoint(0, 0), d->currentBuffer.size());
+    if (!bufferRect.isEmpty() && (QRegion(bufferRect) - d->bufferDamage).isEmpty())
+        d->bufferDamage = bufferRect;
+    else if (d->bufferDamage.rectCount() > 16)
+        d->bufferDamage = d->bufferDamage.boundingRect();
     return true;
 }
 
@@ -250,6 +269,9 @@ QWaylandBufferRef QWaylandView::currentBuffer()
 
 /*!
  * Returns the current damage region of this view.
+ *
+ * This is the damage, in surface coordinates, of all the commits that were made
+ * between the two most recent calls to advance().
  */
 QRegion QWaylandView::currentDamage()
 {
@@ -258,6 +280,26 @@ QRegion QWaylandView::currentDamage()
     return d->currentDamage;
 }
 
+/*!
+ * \since 6.9
+ *
+ * Returns the damage of all the buffers that have become current through advance() since
+ * the previous call to this function, and resets it. Unlike currentDamage(), the region
+ * is in the buffer coordinate system, i.e. buffer scale and viewport have been applied.
+ *
+ * This makes it possible to incrementally update a copy of the buffer contents, even if
+ * the copy is not updated for every call to advance(). The region may be simplified to
+ * cover more than what was damaged, for instance the whole buffer once most of it is.
+ *
+ * \sa advance(), currentDamage()
+ */
+QRegion QWaylandView::takeBufferDamage()
+{
+    Q_D(QWaylandView);
+    QMutexLocker locker(&d->bufferMutex);
+    return std::exchange(d->bufferDamage, QRegion());
+}
+
 /*!
  * \qmlproperty bool QtWayland.Compositor::WaylandView::bufferLocked
  *
@@ -43,6 +43,7 @@ public:
     virtual void discardCurrentBuffer();
     virtual QWaylandBufferRef currentBuffer();
     virtual QRegion currentDamage();
+    QRegion takeBufferDamage();
 
     bool isBufferLocked() const;
     void setBufferLocked(bool locked);
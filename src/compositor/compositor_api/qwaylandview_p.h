@@ -50,12 +50,15 @@ public:
     QRegion currentDamage;
     QWaylandBufferRef nextBuffer;
     QRegion nextDamage;
+    QRegion nextBufferDamage;
+    QRegion bufferDamage;
     bool nextBufferCommitted = false;
     bool bufferLocked = false;
     bool broadcastRequestedPositionChanged = false;
     bool forceAdvanceSucceed = false;
     bool allowDiscardFrontBuffer = false;
     bool independentFrameCallback = false; //If frame callbacks are independent of the main quick scene graph
+    bool occluded = false; // Covered by opaque surfaces or outside of the output, see QWaylandQuickOutput
 };
 
 QT_END_NAMESPACE
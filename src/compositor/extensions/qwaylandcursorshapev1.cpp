@@ -0,0 +1,301 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtWaylandCompositor/QWaylandClient>
+#include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/QWaylandSeat>
+#include <QtWaylandCompositor/private/qwaylandpointer_p.h>
+
+#include "qwaylandcursorshapev1_p.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QWaylandCursorShapeManagerV1
+    \inmodule QtWaylandCompositor
+    \since 6.9
+    \brief Provides an extension that allows clients to set the cursor by shape.
+
+    The QWaylandCursorShapeManagerV1 extension lets clients ask for one of a set of
+    predefined cursor shapes instead of attaching a cursor surface. The cursor images
+    are then owned by the compositor, so clients no longer have to load a cursor
+    theme and commit cursor buffers every time the shape changes.
+
+    QWaylandCursorShapeManagerV1 corresponds to the Wayland interface, \c wp_cursor_shape_manager_v1.
+
+    When a client that has pointer focus requests a shape, the cursor surface it may
+    have set before is dropped with QWaylandSeat::cursorSurfaceRequested() and
+    cursorShapeRequested() is emitted. The extension does not come with cursor images:
+    the compositor shows the shape with images of its own, or with a QCursor for
+    toCursorShape(), whose images the platform plugin caches for each screen scale.
+*/
+
+/*!
+    \qmltype CursorShapeManagerV1
+    \nativetype QWaylandCursorShapeManagerV1
+    \inqmlmodule QtWayland.Compositor
+    \since 6.9
+    \brief Provides an extension that allows clients to set the cursor by shape.
+
+    The CursorShapeManagerV1 extension lets clients ask for one of a set of
+    predefined cursor shapes instead of attaching a cursor surface.
+
+    CursorShapeManagerV1 corresponds to the Wayland interface, \c wp_cursor_shape_manager_v1.
+
+    To provide the functionality of the extension in a compositor, create an instance of the
+    CursorShapeManagerV1 component, add it to the list of extensions supported by the compositor,
+    and show the requested shapes, for instance with a HoverHandler:
+
+    \qml
+    import QtQuick
+    import QtWayland.Compositor
+
+    WaylandCompositor {
+        CursorShapeManagerV1 {
+            id: cursorShapeManager
+            onCursorShapeRequested: (seat, shape, client) => hoverHandler.cursorShape = cursorShapeManager.toCursorShape(shape)
+        }
+
+        WaylandOutput {
+            window: Window {
+                WaylandMouseTracker {
+                    anchors.fill: parent
+                    windowSystemCursorEnabled: true
+                    HoverHandler { id: hoverHandler }
+                    // ...
+                }
+            }
+        }
+    }
+    \endqml
+*/
+
+/*!
+    \qmlsignal void CursorShapeManagerV1::cursorShapeRequested(WaylandSeat seat, enumeration shape, WaylandClient client)
+
+    This signal is emitted when \a client, which has the pointer focus of \a seat, requests
+    the cursor to be shown as \a shape, one of the \l{QWaylandCursorShapeManagerV1::Shape} values.
+*/
+
+/*!
+    \fn void QWaylandCursorShapeManagerV1::cursorShapeRequested(QWaylandSeat *seat, QWaylandCursorShapeManagerV1::Shape shape, QWaylandClient *client)
+
+    This signal is emitted when \a client, which has the pointer focus of \a seat, requests
+    the cursor to be shown as \a shape.
+
+    \sa toCursorShape()
+*/
+
+/*!
+    \enum QWaylandCursorShapeManagerV1::Shape
+
+    This enum type holds the shapes of \c wp_cursor_shape_device_v1, which follow the
+    cursor names of the CSS specification.
+
+    \value DefaultShape The default cursor.
+    \value ContextMenuShape A context menu is available for the object under the cursor.
+    \value HelpShape Help is available for the object under the cursor.
+    \value PointerShape A link or another interactive element.
+    \value ProgressShape A progress indicator.
+    \value WaitShape The program is busy, the user should wait.
+    \value CellShape A cell or set of cells may be selected.
+    \value CrosshairShape A simple crosshair.
+    \value TextShape Text may be selected.
+    \value VerticalTextShape Vertical text may be selected.
+    \value AliasShape Drag and drop: an alias of or a shortcut to something is to be created.
+    \value CopyShape Drag and drop: something is to be copied.
+    \value MoveShape Drag and drop: something is to be moved.
+    \value NoDropShape Drag and drop: the dragged item cannot be dropped here.
+    \value NotAllowedShape Drag and drop: the requested action will not be carried out.
+    \value GrabShape Drag and drop: something can be grabbed.
+    \value GrabbingShape Drag and drop: something is being grabbed.
+    \value EResizeShape The east border is to be moved.
+    \value NResizeShape The north border is to be moved.
+    \value NeResizeShape The north-east corner is to be moved.
+    \value NwResizeShape The north-west corner is to be moved.
+    \value SResizeShape The south border is to be moved.
+    \value SeResizeShape The south-east corner is to be moved.
+    \value SwResizeShape The south-west corner is to be moved.
+    \value WResizeShape The west border is to be moved.
+    \value EwResizeShape The east and west borders are to be moved.
+    \value NsResizeShape The north and south borders are to be moved.
+    \value NeswResizeShape The north-east and south-west corners are to be moved.
+    \value NwseResizeShape The north-west and south-east corners are to be moved.
+    \value ColResizeShape The item or column can be resized horizontally.
+    \value RowResizeShape The item or row can be resized vertically.
+    \value AllScrollShape Something can be scrolled in any direction.
+    \value ZoomInShape Something can be zoomed in.
+    \value ZoomOutShape Something can be zoomed out.
+*/
+
+/*!
+    Constructs a QWaylandCursorShapeManagerV1 object.
+*/
+QWaylandCursorShapeManagerV1::QWaylandCursorShapeManagerV1()
+    : QWaylandCompositorExtensionTemplate<QWaylandCursorShapeManagerV1>(*new QWaylandCursorShapeManagerV1Private())
+{
+}
+
+/*!
+    Constructs a QWaylandCursorShapeManagerV1 object for the provided \a compositor.
+*/
+QWaylandCursorShapeManagerV1::QWaylandCursorShapeManagerV1(QWaylandCompositor *compositor)
+    : QWaylandCompositorExtensionTemplate<QWaylandCursorShapeManagerV1>(compositor, *new QWaylandCursorShapeManagerV1Private())
+{
+}
+
+/*!
+    Destructs a QWaylandCursorShapeManagerV1 object.
+*/
+QWaylandCursorShapeManagerV1::~QWaylandCursorShapeManagerV1() = default;
+
+/*!
+    Initializes the extension.
+*/
+void QWaylandCursorShapeManagerV1::initialize()
+{
+    Q_D(QWaylandCursorShapeManagerV1);
+
+    QWaylandCompositorExtensionTemplate::initialize();
+    QWaylandCompositor *compositor = static_cast<QWaylandCompositor *>(extensionContainer());
+    if (!compositor) {
+        qCWarning(qLcWaylandCompositor) << "Failed to find QWaylandCompositor when initializing QWaylandCursorShapeManagerV1";
+        return;
+    }
+    d->init(compositor->display(), d->interfaceVersion());
+}
+
+/*!
+    Returns the Wayland interface for the QWaylandCursorShapeManagerV1.
+*/
+const wl_interface *QWaylandCursorShapeManagerV1::interface()
+{
+    return QWaylandCursorShapeManagerV1Private::interface();
+}
+
+/*!
+    Returns the Qt::CursorShape closest to \a shape, for showing it with a QCursor.
+
+    Qt::CursorShape has fewer shapes, so some map to the same one: \c ContextMenuShape,
+    \c ZoomInShape and \c ZoomOutShape are shown as Qt::ArrowCursor, and \c CellShape
+    as Qt::CrossCursor. Compositors that have images for them can use \l Shape directly.
+*/
+Qt::CursorShape QWaylandCursorShapeManagerV1::toCursorShape(QWaylandCursorShapeManagerV1::Shape shape)
+{
+    switch (shape) {
+    case HelpShape:
+        return Qt::WhatsThisCursor;
+    case PointerShape:
+        return Qt::PointingHandCursor;
+    case ProgressShape:
+        return Qt::BusyCursor;
+    case WaitShape:
+        return Qt::WaitCursor;
+    case CellShape:
+    case CrosshairShape:
+        return Qt::CrossCursor;
+    case TextShape:
+    case VerticalTextShape:
+        return Qt::IBeamCursor;
+    case AliasShape:
+        return Qt::DragLinkCursor;
+    case CopyShape:
+        return Qt::DragCopyCursor;
+    case MoveShape:
+        return Qt::DragMoveCursor;
+    case NoDropShape:
+    case NotAllowedShape:
+        return Qt::ForbiddenCursor;
+    case GrabShape:
+        return Qt::OpenHandCursor;
+    case GrabbingShape:
+        return Qt::ClosedHandCursor;
+    case EResizeShape:
+    case WResizeShape:
+    case EwResizeShape:
+        return Qt::SizeHorCursor;
+    case NResizeShape:
+    case SResizeShape:
+    case NsResizeShape:
+        return Qt::SizeVerCursor;
+    case NeResizeShape:
+    case SwResizeShape:
+    case NeswResizeShape:
+        return Qt::SizeBDiagCursor;
+    case NwResizeShape:
+    case SeResizeShape:
+    case NwseResizeShape:
+        return Qt::SizeFDiagCursor;
+    case ColResizeShape:
+        return Qt::SplitHCursor;
+    case RowResizeShape:
+        return Qt::SplitVCursor;
+    case AllScrollShape:
+        return Qt::SizeAllCursor;
+    case DefaultShape:
+    case ContextMenuShape:
+    case ZoomInShape:
+    case ZoomOutShape:
+        break;
+    }
+    return Qt::ArrowCursor;
+}
+
+void QWaylandCursorShapeManagerV1Private::wp_cursor_shape_manager_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void QWaylandCursorShapeManagerV1Private::wp_cursor_shape_manager_v1_get_pointer(Resource *resource, uint32_t id, wl_resource *pointer)
+{
+    Q_Q(QWaylandCursorShapeManagerV1);
+    new Device(q, QWaylandPointerPrivate::fromResource(pointer), resource->client(), id, resource->version());
+}
+
+void QWaylandCursorShapeManagerV1Private::wp_cursor_shape_manager_v1_get_tablet_tool_v2(Resource *resource, uint32_t id, wl_resource *tabletTool)
+{
+    Q_Q(QWaylandCursorShapeManagerV1);
+    Q_UNUSED(tabletTool);
+    new Device(q, nullptr, resource->client(), id, resource->version());
+}
+
+QWaylandCursorShapeManagerV1Private::Device::Device(QWaylandCursorShapeManagerV1 *manager, QWaylandPointer *pointer,
+                                                    wl_client *client, quint32 id, quint32 version)
+    : QtWaylandServer::wp_cursor_shape_device_v1(client, id, qMin<quint32>(version, interfaceVersion()))
+    , m_manager(manager)
+    , m_pointer(pointer)
+{
+}
+
+void QWaylandCursorShapeManagerV1Private::Device::wp_cursor_shape_device_v1_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+    delete this;
+}
+
+void QWaylandCursorShapeManagerV1Private::Device::wp_cursor_shape_device_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void QWaylandCursorShapeManagerV1Private::Device::wp_cursor_shape_device_v1_set_shape(Resource *resource, uint32_t serial, uint32_t shape)
+{
+    if (shape < shape_default || shape > shape_zoom_out) {
+        wl_resource_post_error(resource->handle, error_invalid_shape, "invalid cursor shape %u", shape);
+        return;
+    }
+
+    // Only the client the pointer last entered may change the cursor
+    if (!m_manager || !m_pointer || !QWaylandPointerPrivate::get(m_pointer)->hasEnterSerial(resource->client(), serial))
+        return;
+
+    QWaylandSeat *seat = m_pointer->seat();
+    QWaylandClient *client = QWaylandClient::fromWlClient(seat->compositor(), resource->client());
+    // The shape replaces the cursor surface the client may have set before
+    emit seat->cursorSurfaceRequested(nullptr, 0, 0, client);
+    emit m_manager->cursorShapeRequested(seat, QWaylandCursorShapeManagerV1::Shape(shape), client);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qwaylandcursorshapev1.cpp"
@@ -0,0 +1,75 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QWAYLANDCURSORSHAPEV1_H
+#define QWAYLANDCURSORSHAPEV1_H
+
+#include <QtWaylandCompositor/QWaylandCompositorExtension>
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandCursorShapeManagerV1Private;
+class QWaylandSeat;
+class QWaylandClient;
+
+class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandCursorShapeManagerV1 : public QWaylandCompositorExtensionTemplate<QWaylandCursorShapeManagerV1>
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QWaylandCursorShapeManagerV1)
+public:
+    // The shapes of wp_cursor_shape_device_v1, with the same values
+    enum Shape : uint {
+        DefaultShape = 1,
+        ContextMenuShape,
+        HelpShape,
+        PointerShape,
+        ProgressShape,
+        WaitShape,
+        CellShape,
+        CrosshairShape,
+        TextShape,
+        VerticalTextShape,
+        AliasShape,
+        CopyShape,
+        MoveShape,
+        NoDropShape,
+        NotAllowedShape,
+        GrabShape,
+        GrabbingShape,
+        EResizeShape,
+        NResizeShape,
+        NeResizeShape,
+        NwResizeShape,
+        SResizeShape,
+        SeResizeShape,
+        SwResizeShape,
+        WResizeShape,
+        EwResizeShape,
+        NsResizeShape,
+        NeswResizeShape,
+        NwseResizeShape,
+        ColResizeShape,
+        RowResizeShape,
+        AllScrollShape,
+        ZoomInShape,
+        ZoomOutShape,
+    };
+    Q_ENUM(Shape)
+
+    QWaylandCursorShapeManagerV1();
+    explicit QWaylandCursorShapeManagerV1(QWaylandCompositor *compositor);
+    ~QWaylandCursorShapeManagerV1() override;
+
+    void initialize() override;
+
+    static const struct wl_interface *interface();
+
+    Q_INVOKABLE static Qt::CursorShape toCursorShape(QWaylandCursorShapeManagerV1::Shape shape);
+
+Q_SIGNALS:
+    void cursorShapeRequested(QWaylandSeat *seat, QWaylandCursorShapeManagerV1::Shape shape, QWaylandClient *client);
+};
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDCURSORSHAPEV1_H
@@ -0,0 +1,60 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QWAYLANDCURSORSHAPEV1_P_H
+#define QWAYLANDCURSORSHAPEV1_P_H
+
+#include <QtWaylandCompositor/QWaylandPointer>
+#include <QtWaylandCompositor/QWaylandCursorShapeManagerV1>
+#include <QtWaylandCompositor/private/qwaylandcompositorextension_p.h>
+#include <QtWaylandCompositor/private/qwayland-server-cursor-shape-v1.h>
+
+#include <QtCore/qpointer.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandCursorShapeManagerV1Private
+        : public QWaylandCompositorExtensionPrivate
+        , public QtWaylandServer::wp_cursor_shape_manager_v1
+{
+    Q_DECLARE_PUBLIC(QWaylandCursorShapeManagerV1)
+public:
+    explicit QWaylandCursorShapeManagerV1Private() = default;
+
+    class Device : public QtWaylandServer::wp_cursor_shape_device_v1
+    {
+    public:
+        Device(QWaylandCursorShapeManagerV1 *manager, QWaylandPointer *pointer,
+               wl_client *client, quint32 id, quint32 version);
+
+    protected:
+        void wp_cursor_shape_device_v1_destroy_resource(Resource *resource) override;
+        void wp_cursor_shape_device_v1_destroy(Resource *resource) override;
+        void wp_cursor_shape_device_v1_set_shape(Resource *resource, uint32_t serial, uint32_t shape) override;
+
+    private:
+        QPointer<QWaylandCursorShapeManagerV1> m_manager;
+        // Null for tablet tools, which are not supported by the compositor
+        QPointer<QWaylandPointer> m_pointer;
+    };
+
+protected:
+    void wp_cursor_shape_manager_v1_destroy(Resource *resource) override;
+    void wp_cursor_shape_manager_v1_get_pointer(Resource *resource, uint32_t id, wl_resource *pointer) override;
+    void wp_cursor_shape_manager_v1_get_tablet_tool_v2(Resource *resource, uint32_t id, wl_resource *tabletTool) override;
+};
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDCURSORSHAPEV1_P_H
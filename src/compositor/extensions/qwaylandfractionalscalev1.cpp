@@ -0,0 +1,167 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qwaylandfractionalscalev1_p.h"
+
+#include <QtWaylandCompositor/QWaylandSurface>
+#include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/QWaylandOutput>
+
+#include <QtWaylandCompositor/private/qwaylandoutput_p.h>
+#include <QtWaylandCompositor/private/qwaylandsurface_p.h>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QWaylandFractionalScaleManagerV1
+    \inmodule QtWaylandCompositor
+    \since 6.9
+    \brief Provides an extension for telling clients the exact scale to render at.
+
+    The QWaylandFractionalScaleManagerV1 extension sends clients the scale their surfaces
+    are displayed at, which is the highest QWaylandOutput::fractionalScaleFactor of the
+    outputs a surface is on. Together with QWaylandViewporter, this lets clients render
+    buffers that match the output pixels exactly on outputs with a non-integer scale,
+    instead of rendering at the next integer scale and having the compositor scale the
+    buffers down on every frame.
+
+    QWaylandFractionalScaleManagerV1 corresponds to the Wayland interface,
+    \c wp_fractional_scale_manager_v1. It is created automatically by QWaylandQuickCompositor.
+*/
+
+/*!
+    Constructs a QWaylandFractionalScaleManagerV1 object.
+*/
+QWaylandFractionalScaleManagerV1::QWaylandFractionalScaleManagerV1()
+    : QWaylandCompositorExtensionTemplate<QWaylandFractionalScaleManagerV1>(*new QWaylandFractionalScaleManagerV1Private)
+{
+}
+
+/*!
+    Constructs a QWaylandFractionalScaleManagerV1 object for the provided \a compositor.
+*/
+QWaylandFractionalScaleManagerV1::QWaylandFractionalScaleManagerV1(QWaylandCompositor *compositor)
+    : QWaylandCompositorExtensionTemplate<QWaylandFractionalScaleManagerV1>(compositor, *new QWaylandFractionalScaleManagerV1Private())
+{
+}
+
+/*!
+    Initializes the extension.
+*/
+void QWaylandFractionalScaleManagerV1::initialize()
+{
+    Q_D(QWaylandFractionalScaleManagerV1);
+
+    QWaylandCompositorExtensionTemplate::initialize();
+    auto *compositor = static_cast<QWaylandCompositor *>(extensionContainer());
+    if (!compositor) {
+        qWarning() << "Failed to find QWaylandCompositor when initializing QWaylandFractionalScaleManagerV1";
+        return;
+    }
+    d->init(compositor->display(), 1);
+}
+
+/*!
+    Returns the Wayland interface for the QWaylandFractionalScaleManagerV1.
+*/
+const wl_interface *QWaylandFractionalScaleManagerV1::interface()
+{
+    return QWaylandFractionalScaleManagerV1Private::interface();
+}
+
+// Returns the highest scale of the outputs \a surface has entered, or 0 if it
+// is not on any output.
+qreal QWaylandFractionalScaleManagerV1Private::preferredScale(QWaylandSurface *surface)
+{
+    qreal scale = 0;
+    const auto outputs = surface->compositor()->outputs();
+    for (QWaylandOutput *output : outputs) {
+        auto *mapper = QWaylandOutputPrivate::get(output)->mapperForSurface(surface);
+        if (mapper && mapper->has_entered)
+            scale = qMax(scale, output->fractionalScaleFactor());
+    }
+    return scale;
+}
+
+void QWaylandFractionalScaleManagerV1Private::wp_fractional_scale_manager_v1_destroy(Resource *resource)
+{
+    // Fractional scale objects are allowed to outlive the manager
+    wl_resource_destroy(resource->handle);
+}
+
+void QWaylandFractionalScaleManagerV1Private::wp_fractional_scale_manager_v1_get_fractional_scale(Resource *resource, uint id, wl_resource *surfaceResource)
+{
+    auto *surface = QWaylandSurface::fromResource(surfaceResource);
+    if (!surface) {
+        qWarning() << "Couldn't find surface for fractional scale";
+        return;
+    }
+
+    auto *surfacePrivate = QWaylandSurfacePrivate::get(surface);
+    if (surfacePrivate->fractionalScale) {
+        wl_resource_post_error(resource->handle, error_fractional_scale_exists,
+                               "fractional scale already exists for surface");
+        return;
+    }
+
+    surfacePrivate->fractionalScale = new FractionalScale(surface, resource->client(), id);
+    surfacePrivate->fractionalScale->updatePreferredScale();
+}
+
+QWaylandFractionalScaleManagerV1Private::FractionalScale::FractionalScale(QWaylandSurface *surface, wl_client *client, int id)
+    : QtWaylandServer::wp_fractional_scale_v1(client, id, /*version*/ 1)
+    , m_surface(surface)
+{
+    Q_ASSERT(surface);
+}
+
+QWaylandFractionalScaleManagerV1Private::FractionalScale::~FractionalScale()
+{
+    if (m_surface) {
+        auto *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
+        Q_ASSERT(surfacePrivate->fractionalScale == this);
+        surfacePrivate->fractionalScale = nullptr;
+    }
+}
+
+// Sends the scale of the outputs the surface is on if it changed. Has to be
+// called whenever the surface enters or leaves an output, or the scale of one
+// of its outputs changes.
+void QWaylandFractionalScaleManagerV1Private::FractionalScale::updatePreferredScale()
+{
+    if (!m_surface)
+        return;
+
+    qreal scale = preferredScale(m_surface);
+    if (scale <= 0) {
+        // Keep the previous scale while the surface is not shown. Before the
+        // surface is mapped, the best guess is the default output, which saves
+        // clients from rendering their first frame at the wrong scale.
+        if (m_preferredScale != 0)
+            return;
+        QWaylandOutput *output = m_surface->compositor()->defaultOutput();
+        scale = output ? output->fractionalScaleFactor() : 1;
+    }
+
+    const uint preferredScale = qMax(1, qRound(scale * 120));
+    if (preferredScale == m_preferredScale)
+        return;
+
+    m_preferredScale = preferredScale;
+    send_preferred_scale(preferredScale);
+}
+
+void QWaylandFractionalScaleManagerV1Private::FractionalScale::wp_fractional_scale_v1_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource);
+    delete this;
+}
+
+void QWaylandFractionalScaleManagerV1Private::FractionalScale::wp_fractional_scale_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qwaylandfractionalscalev1.cpp"
@@ -0,0 +1,30 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QWAYLANDFRACTIONALSCALEV1_H
+#define QWAYLANDFRACTIONALSCALEV1_H
+
+#include <QtWaylandCompositor/QWaylandCompositorExtension>
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandFractionalScaleManagerV1Private;
+
+class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandFractionalScaleManagerV1
+        : public QWaylandCompositorExtensionTemplate<QWaylandFractionalScaleManagerV1>
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QWaylandFractionalScaleManagerV1)
+
+public:
+    explicit QWaylandFractionalScaleManagerV1();
+    explicit QWaylandFractionalScaleManagerV1(QWaylandCompositor *compositor);
+
+    void initialize() override;
+
+    static const struct wl_interface *interface();
+};
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDFRACTIONALSCALEV1_H
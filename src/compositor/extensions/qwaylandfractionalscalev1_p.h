@@ -0,0 +1,62 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QWAYLANDFRACTIONALSCALEV1_P_H
+#define QWAYLANDFRACTIONALSCALEV1_P_H
+
+#include <QtWaylandCompositor/QWaylandFractionalScaleManagerV1>
+#include <QtWaylandCompositor/private/qwaylandcompositorextension_p.h>
+#include <QtWaylandCompositor/private/qwayland-server-fractional-scale-v1.h>
+
+#include <QtCore/qpointer.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandSurface;
+
+class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandFractionalScaleManagerV1Private
+        : public QWaylandCompositorExtensionPrivate
+        , public QtWaylandServer::wp_fractional_scale_manager_v1
+{
+    Q_DECLARE_PUBLIC(QWaylandFractionalScaleManagerV1)
+public:
+    explicit QWaylandFractionalScaleManagerV1Private() = default;
+
+    class Q_WAYLANDCOMPOSITOR_EXPORT FractionalScale
+            : public QtWaylandServer::wp_fractional_scale_v1
+    {
+    public:
+        explicit FractionalScale(QWaylandSurface *surface, wl_client *client, int id);
+        ~FractionalScale() override;
+        void updatePreferredScale();
+
+    protected:
+        void wp_fractional_scale_v1_destroy_resource(Resource *resource) override;
+        void wp_fractional_scale_v1_destroy(Resource *resource) override;
+
+    private:
+        QPointer<QWaylandSurface> m_surface = nullptr;
+        uint m_preferredScale = 0; // In 120ths, 0 until the first one has been sent
+    };
+
+    static qreal preferredScale(QWaylandSurface *surface);
+
+protected:
+    void wp_fractional_scale_manager_v1_destroy(Resource *resource) override;
+    void wp_fractional_scale_manager_v1_get_fractional_scale(Resource *resource, uint32_t id, wl_resource *surface) override;
+};
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDFRACTIONALSCALEV1_P_H
@@ -0,0 +1,153 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "qwaylandsinglepixelbufferv1_p.h"
+
+#include <QtWaylandCompositor/QWaylandCompositor>
+#include <QtWaylandCompositor/private/qwaylandcompositor_p.h>
+#include <QtWaylandCompositor/private/qwlbuffermanager_p.h>
+#include <QtWaylandCompositor/private/wayland-wayland-server-protocol.h>
+
+#if QT_CONFIG(opengl)
+#include <QtOpenGL/QOpenGLTexture>
+#endif
+
+#include <limits>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+    \class QWaylandSinglePixelBufferManagerV1
+    \inmodule QtWaylandCompositor
+    \since 6.9
+    \brief Provides an extension for creating buffers of a single color.
+
+    The QWaylandSinglePixelBufferManagerV1 extension lets clients create \c wl_buffer
+    objects that consist of a single pixel of a given color. Combined with QWaylandViewporter,
+    a client can fill a surface of any size with a solid color without allocating or
+    drawing into shared memory. QWaylandQuickItem draws such surfaces as plain
+    rectangles, so no texture is uploaded either.
+
+    QWaylandSinglePixelBufferManagerV1 corresponds to the Wayland interface,
+    \c wp_single_pixel_buffer_manager_v1. It is created automatically by QWaylandQuickCompositor.
+*/
+
+/*!
+    Constructs a QWaylandSinglePixelBufferManagerV1 object.
+*/
+QWaylandSinglePixelBufferManagerV1::QWaylandSinglePixelBufferManagerV1()
+    : QWaylandCompositorExtensionTemplate<QWaylandSinglePixelBufferManagerV1>(*new QWaylandSinglePixelBufferManagerV1Private)
+{
+}
+
+/*!
+    Constructs a QWaylandSinglePixelBufferManagerV1 object for the provided \a compositor.
+*/
+QWaylandSinglePixelBufferManagerV1::QWaylandSinglePixelBufferManagerV1(QWaylandCompositor *compositor)
+    : QWaylandCompositorExtensionTemplate<QWaylandSinglePixelBufferManagerV1>(compositor, *new QWaylandSinglePixelBufferManagerV1Private())
+{
+}
+
+/*!
+    Initializes the extension.
+*/
+void QWaylandSinglePixelBufferManagerV1::initialize()
+{
+    Q_D(QWaylandSinglePixelBufferManagerV1);
+
+    QWaylandCompositorExtensionTemplate::initialize();
+    auto *compositor = static_cast<QWaylandCompositor *>(extensionContainer());
+    if (!compositor) {
+        qWarning() << "Failed to find QWaylandCompositor when initializing QWaylandSinglePixelBufferManagerV1";
+        return;
+    }
+    d->init(compositor->display(), 1);
+}
+
+/*!
+    Returns the Wayland interface for the QWaylandSinglePixelBufferManagerV1.
+*/
+const wl_interface *QWaylandSinglePixelBufferManagerV1::interface()
+{
+    return QWaylandSinglePixelBufferManagerV1Private::interface();
+}
+
+void QWaylandSinglePixelBufferManagerV1Private::wp_single_pixel_buffer_manager_v1_destroy(Resource *resource)
+{
+    // Buffers are allowed to outlive the manager
+    wl_resource_destroy(resource->handle);
+}
+
+static void singlePixelBufferDestroy(wl_client *client, wl_resource *resource)
+{
+    Q_UNUSED(client);
+    wl_resource_destroy(resource);
+}
+
+static const struct wl_buffer_interface singlePixelBufferInterface = {
+    singlePixelBufferDestroy
+};
+
+void QWaylandSinglePixelBufferManagerV1Private::wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(
+        Resource *resource, uint32_t id, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+    Q_Q(QWaylandSinglePixelBufferManagerV1);
+
+    wl_resource *buffer = wl_resource_create(resource->client(), &wl_buffer_interface, 1, id);
+    if (!buffer) {
+        wl_client_post_no_memory(resource->client());
+        return;
+    }
+    wl_resource_set_implementation(buffer, &singlePixelBufferInterface, nullptr, nullptr);
+
+    // The channels are premultiplied, QColor is not
+    constexpr double max = std::numeric_limits<uint32_t>::max();
+    QColor color = Qt::transparent;
+    if (a > 0) {
+        const auto unpremultiply = [a](uint32_t c) { return qMin(1.0, double(c) / a); };
+        color = QColor::fromRgbF(unpremultiply(r), unpremultiply(g), unpremultiply(b), a / max);
+    }
+
+    auto *compositor = static_cast<QWaylandCompositor *>(q->extensionContainer());
+    QWaylandCompositorPrivate::get(compositor)->bufferManager()->registerBuffer(
+            buffer, new QtWayland::SinglePixelBuffer(buffer, color));
+}
+
+namespace QtWayland {
+
+SinglePixelBuffer::SinglePixelBuffer(wl_resource *bufferResource, const QColor &color)
+    : ClientBuffer(bufferResource)
+    , m_color(color)
+{
+}
+
+QImage SinglePixelBuffer::image() const
+{
+    QImage image(1, 1, QImage::Format_ARGB32_Premultiplied);
+    image.fill(m_color);
+    return image;
+}
+
+void SinglePixelBuffer::setCommitted(QRegion &damage)
+{
+    ClientBuffer::setCommitted(damage);
+    // The color has been copied already, so the client may reuse the buffer right away
+    sendRelease();
+}
+
+#if QT_CONFIG(opengl)
+QOpenGLTexture *SinglePixelBuffer::toOpenGlTexture(int plane)
+{
+    Q_UNUSED(plane);
+    // Only used by renderers that cannot draw the color directly
+    if (!m_texture)
+        m_texture.reset(new QOpenGLTexture(image(), QOpenGLTexture::DontGenerateMipMaps));
+    return m_texture.data();
+}
+#endif
+
+}
+
+QT_END_NAMESPACE
+
+#include "moc_qwaylandsinglepixelbufferv1.cpp"
@@ -0,0 +1,30 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QWAYLANDSINGLEPIXELBUFFERV1_H
+#define QWAYLANDSINGLEPIXELBUFFERV1_H
+
+#include <QtWaylandCompositor/QWaylandCompositorExtension>
+
+QT_BEGIN_NAMESPACE
+
+class QWaylandSinglePixelBufferManagerV1Private;
+
+class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandSinglePixelBufferManagerV1
+        : public QWaylandCompositorExtensionTemplate<QWaylandSinglePixelBufferManagerV1>
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(QWaylandSinglePixelBufferManagerV1)
+
+public:
+    explicit QWaylandSinglePixelBufferManagerV1();
+    explicit QWaylandSinglePixelBufferManagerV1(QWaylandCompositor *compositor);
+
+    void initialize() override;
+
+    static const struct wl_interface *interface();
+};
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDSINGLEPIXELBUFFERV1_H
@@ -0,0 +1,72 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef QWAYLANDSINGLEPIXELBUFFERV1_P_H
+#define QWAYLANDSINGLEPIXELBUFFERV1_P_H
+
+#include <QtWaylandCompositor/QWaylandSinglePixelBufferManagerV1>
+#include <QtWaylandCompositor/private/qwaylandcompositorextension_p.h>
+#include <QtWaylandCompositor/private/qwayland-server-single-pixel-buffer-v1.h>
+#include <QtWaylandCompositor/private/qwlclientbuffer_p.h>
+
+#include <QtGui/qcolor.h>
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+QT_BEGIN_NAMESPACE
+
+class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandSinglePixelBufferManagerV1Private
+        : public QWaylandCompositorExtensionPrivate
+        , public QtWaylandServer::wp_single_pixel_buffer_manager_v1
+{
+    Q_DECLARE_PUBLIC(QWaylandSinglePixelBufferManagerV1)
+public:
+    explicit QWaylandSinglePixelBufferManagerV1Private() = default;
+
+protected:
+    void wp_single_pixel_buffer_manager_v1_destroy(Resource *resource) override;
+    void wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(Resource *resource, uint32_t id,
+                                                                 uint32_t r, uint32_t g,
+                                                                 uint32_t b, uint32_t a) override;
+};
+
+namespace QtWayland {
+
+// A 1x1 buffer of a single color, the contents live in the compositor only
+class Q_WAYLANDCOMPOSITOR_EXPORT SinglePixelBuffer : public ClientBuffer
+{
+public:
+    SinglePixelBuffer(struct ::wl_resource *bufferResource, const QColor &color);
+
+    QSize size() const override { return QSize(1, 1); }
+    QWaylandSurface::Origin origin() const override { return QWaylandSurface::OriginTopLeft; }
+    QImage image() const override;
+    QColor solidColor() const override { return m_color; }
+
+    void setCommitted(QRegion &damage) override;
+
+#if QT_CONFIG(opengl)
+    QOpenGLTexture *toOpenGlTexture(int plane = 0) override;
+
+private:
+    QScopedPointer<QOpenGLTexture> m_texture;
+#endif
+
+private:
+    QColor m_color;
+};
+
+}
+
+QT_END_NAMESPACE
+
+#endif // QWAYLANDSINGLEPIXELBUFFERV1_P_H
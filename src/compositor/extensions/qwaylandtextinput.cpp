@@ -473,22 +473,22 @@ void QWaylandTextInputPrivate::zwp_text_input_v2_set_content_type(Resource *reso
     pendingState->changedState |= Qt::ImHints;
 }
 
-void QWaylandTextInputPrivate::zwp_text_input_v2_set_preferred_language(Resource *resource, const QString &language)
+void QWaylandTextInputPrivate::zwp_text_input_v2_set_preferred_language(Resource *resource, QUtf8StringView language)
 {
     if (resource != focusResource)
         return;
 
-    pendingState->preferredLanguage = language;
+    pendingState->preferredLanguage = language.toString();
 
     pendingState->changedState |= Qt::ImPreferredLanguage;
 }
 
-void QWaylandTextInputPrivate::zwp_text_input_v2_set_surrounding_text(Resource *resource, const QString &text, int32_t cursor, int32_t anchor)
+void QWaylandTextInputPrivate::zwp_text_input_v2_set_surrounding_text(Resource *resource, QUtf8StringView text, int32_t cursor, int32_t anchor)
 {
     if (resource != focusResource)
         return;
 
-    pendingState->surroundingText = text;
+    pendingState->surroundingText = text.toString();
     pendingState->cursorPosition = QWaylandInputMethodEventBuilder::indexFromWayland(text, cursor);
     pendingState->anchorPosition = QWaylandInputMethodEventBuilder::indexFromWayland(text, anchor);
 
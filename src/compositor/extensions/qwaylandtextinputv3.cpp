@@ -400,14 +400,14 @@ void QWaylandTextInputV3Private::zwp_text_input_v3_set_content_type(Resource *re
     pendingState->changedState |= Qt::ImHints;
 }
 
-void QWaylandTextInputV3Private::zwp_text_input_v3_set_surrounding_text(Resource *resource, const QString &text, int32_t cursor, int32_t anchor)
+void QWaylandTextInputV3Private::zwp_text_input_v3_set_surrounding_text(Resource *resource, QUtf8StringView text, int32_t cursor, int32_t anchor)
 {
     qCDebug(qLcWaylandCompositorTextInput) << Q_FUNC_INFO << text << cursor << anchor;
 
     if (resource != focusResource)
         return;
 
-    pendingState->surroundingText = text;
+    pendingState->surroundingText = text.toString();
     pendingState->cursorPosition = QWaylandInputMethodEventBuilder::indexFromWayland(text, cursor);
     pendingState->anchorPosition = QWaylandInputMethodEventBuilder::indexFromWayland(text, anchor);
 
@@ -102,19 +102,15 @@ QWaylandViewporterPrivate::Viewport::~Viewport()
     }
 }
 
-// This function has to be called immediately after a surface is committed, before no
-// other client events have been dispatched, or we may incorrectly error out on an
-// incomplete pending state. See comment below.
-void QWaylandViewporterPrivate::Viewport::checkCommittedState()
+// This function has to be called immediately after a surface state is applied, with the
+// \a destination and \a source of the state that was applied, or we may incorrectly error
+// out on an incomplete pending state. See comment below.
+void QWaylandViewporterPrivate::Viewport::checkCommittedState(const QSize &destination, const QRectF &source)
 {
-    auto *surfacePrivate = QWaylandSurfacePrivate::get(m_surface);
-
     // We can't use the current state for destination/source when checking,
     // as that has fallbacks to the buffer size so we can't distinguish
-    // between the set/unset case. We use the pending state because no other
-    // requests has modified it yet.
-    QSize destination = surfacePrivate->pending.destinationSize;
-    QRectF source = surfacePrivate->pending.sourceGeometry;
+    // between the set/unset case. We use the state that was just applied
+    // instead, which may have been cached for a while for synchronized subsurfaces.
 
     if (!destination.isValid() && source.size() != source.size().toSize()) {
         wl_resource_post_error(resource()->handle, error_bad_size,
@@ -40,7 +40,7 @@ public:
     public:
         explicit Viewport(QWaylandSurface *surface, wl_client *client, int id);
         ~Viewport() override;
-        void checkCommittedState();
+        void checkCommittedState(const QSize &destination, const QRectF &source);
 
     protected:
         void wp_viewport_destroy_resource(Resource *resource) override;
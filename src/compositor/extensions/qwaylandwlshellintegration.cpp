@@ -112,7 +112,7 @@ void WlShellIntegration::handleMaximizedSizeChanged()
 
     if (nextState == State::Maximized) {
         QWaylandOutput *designatedOutput = nonwindowedState.output;
-        auto scaleFactor = designatedOutput->scaleFactor();
+        auto scaleFactor = designatedOutput->fractionalScaleFactor();
         m_shellSurface->sendConfigure(designatedOutput->availableGeometry().size() / scaleFactor, QWaylandWlShellSurface::NoneEdge);
     }
 }
@@ -274,7 +274,7 @@ bool WlShellIntegration::filterMouseMoveEvent(QMouseEvent *event)
             resizeState.initialized = true;
             return true;
         }
-        float scaleFactor = m_item->view()->output()->scaleFactor();
+        qreal scaleFactor = m_item->view()->output()->fractionalScaleFactor();
         QPointF delta = (event->scenePosition() - resizeState.initialMousePos) / scaleFactor * devicePixelRatio();
         QSize newSize = m_shellSurface->sizeForResize(resizeState.initialSize, delta, resizeState.resizeEdges);
         m_shellSurface->sendConfigure(newSize, resizeState.resizeEdges);
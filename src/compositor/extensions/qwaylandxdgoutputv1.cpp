@@ -451,16 +451,14 @@ QRect QWaylandXdgOutputV1::logicalGeometry() const
 
 void QWaylandXdgOutputV1Private::sendLogicalPosition(const QPoint &position)
 {
-    const auto values = resourceMap().values();
-    for (auto *resource : values)
+    for (auto *resource : resources())
         send_logical_position(resource->handle, position.x(), position.y());
     needToSendDone = true;
 }
 
 void QWaylandXdgOutputV1Private::sendLogicalSize(const QSize &size)
 {
-    const auto values = resourceMap().values();
-    for (auto *resource : values)
+    for (auto *resource : resources())
         send_logical_size(resource->handle, size.width(), size.height());
     needToSendDone = true;
 }
@@ -468,8 +466,7 @@ void QWaylandXdgOutputV1Private::sendLogicalSize(const QSize &size)
 void QWaylandXdgOutputV1Private::sendDone()
 {
     if (needToSendDone) {
-        const auto values = resourceMap().values();
-        for (auto *resource : values) {
+        for (auto *resource : resources()) {
             if (resource->version() < 3)
                 send_done(resource->handle);
         }
@@ -157,7 +157,7 @@ void XdgToplevelIntegration::handleMaximizedSizeChanged()
     if (m_toplevel == nullptr)
         return;
 
-    m_toplevel->sendMaximized(nonwindowedState.output->availableGeometry().size() / nonwindowedState.output->scaleFactor());
+    m_toplevel->sendMaximized(nonwindowedState.output->availableGeometry().size() / nonwindowedState.output->fractionalScaleFactor());
 }
 
 void XdgToplevelIntegration::handleUnsetMaximized()
@@ -213,7 +213,7 @@ void XdgToplevelIntegration::handleFullscreenSizeChanged()
     if (m_toplevel == nullptr)
         return;
 
-    m_toplevel->sendFullscreen(nonwindowedState.output->geometry().size() / nonwindowedState.output->scaleFactor());
+    m_toplevel->sendFullscreen(nonwindowedState.output->geometry().size() / nonwindowedState.output->fractionalScaleFactor());
 }
 
 void XdgToplevelIntegration::handleUnsetFullscreen()
@@ -11,7 +11,6 @@
 
 #include <QPainter>
 #include <QPen>
-#include <QTimer>
 
 #include <QtGui/private/qtexturefilereader_p.h>
 
@@ -21,6 +20,19 @@
 #include <QtQuick/QSGTexture>
 #include <QQmlContext>
 #include <QThread>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QCryptographicHash>
+
+#include <QtCore/private/qcore_unix_p.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -150,8 +162,124 @@ void QWaylandSharedTextureProvider::setExtensionReady(QWaylandTextureSharingExte
     m_pendingResponses.squeeze();
 }
 
+/*
+    The disk cache holds decoded images as a small header followed by the pixels,
+    so that they can be mapped and used without decoding them again.
+*/
+struct DiskCacheHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 width;
+    quint32 height;
+    quint32 bytesPerLine;
+    quint32 format;
+};
+
+static const quint32 diskCacheMagic = 0x54535751; // "QWST"
+static const quint32 diskCacheVersion = 1;
+
+// Entries are keyed by the source file and its modification time, so edited files are decoded again
+static QString diskCacheFileName(const QString &diskCachePath, const QString &pathName)
+{
+    const QFileInfo info(pathName);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray::number(info.size()));
+    return diskCachePath + QString::fromLatin1(hash.result().toHex()) + QLatin1String(".rgba");
+}
+
+struct DiskCacheMapping
+{
+    void *data;
+    size_t size;
+};
+
+static void unmapDiskCacheFile(void *info)
+{
+    auto *mapping = static_cast<DiskCacheMapping *>(info);
+    munmap(mapping->data, mapping->size);
+    delete mapping;
+}
+
+static QImage readDiskCacheFile(const QString &fileName)
+{
+    const int fd = qt_safe_open(QFile::encodeName(fileName).constData(), O_RDONLY);
+    if (fd < 0)
+        return QImage();
+
+    QImage image;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(DiskCacheHeader)) {
+        const size_t size = st.st_size;
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            const auto *header = static_cast<const DiskCacheHeader *>(data);
+            // Computed in 64 bits, so that a broken header cannot wrap around
+            const quint64 pixelBytes = quint64(header->bytesPerLine) * header->height;
+            const bool valid = header->magic == diskCacheMagic && header->version == diskCacheVersion
+                    && header->format == QImage::Format_RGBA8888_Premultiplied
+                    && header->width > 0 && header->height > 0
+                    && header->bytesPerLine <= quint32(std::numeric_limits<int>::max())
+                    && header->height <= quint32(std::numeric_limits<int>::max())
+                    && quint64(header->bytesPerLine) >= quint64(header->width) * 4
+                    && quint64(size - sizeof(DiskCacheHeader)) >= pixelBytes;
+            if (valid) {
+                // Mark the file as recently used, so that pruning the disk cache keeps it
+                futimens(fd, nullptr);
+                const uchar *bits = static_cast<const uchar *>(data) + sizeof(DiskCacheHeader);
+                image = QImage(bits, header->width, header->height, header->bytesPerLine,
+                               QImage::Format(header->format), unmapDiskCacheFile, new DiskCacheMapping{ data, size });
+            } else {
+                munmap(data, size);
+            }
+        }
+    }
+    qt_safe_close(fd);
+    return image;
+}
+
+// Deletes the least recently used files until the disk cache fits in maxSize bytes
+static void pruneDiskCache(const QString &diskCachePath, qint64 maxSize)
+{
+    const QFileInfoList files = QDir(diskCachePath).entryInfoList({ QStringLiteral("*.rgba") }, QDir::Files,
+                                                                  QDir::Time | QDir::Reversed);
+    qint64 total = 0;
+    for (const QFileInfo &file : files)
+        total += file.size();
+    for (const QFileInfo &file : files) {
+        if (total <= maxSize)
+            break;
+        if (QFile::remove(file.absoluteFilePath()))
+            total -= file.size();
+    }
+}
+
+static void writeDiskCacheFile(const QString &fileName, const QImage &image)
+{
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    const DiskCacheHeader header = { diskCacheMagic, diskCacheVersion, quint32(image.width()), quint32(image.height()),
+                                     quint32(image.bytesPerLine()), quint32(image.format()) };
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes());
+    if (!file.commit())
+        qWarning() << "QWaylandTextureSharingExtension: could not write disk cache file" << fileName;
+}
+
 QWaylandTextureSharingExtension *QWaylandTextureSharingExtension::s_self = nullptr; // theoretical race conditions, but OK as long as we don't delete it while we are running
 
+// Images are decoded off the main thread and handed back in this
+struct QWaylandTextureSharingExtension::LoadedImage
+{
+    QString pathName;
+    QImage image;
+    QTextureFileData textureData;
+};
+
 QWaylandTextureSharingExtension::QWaylandTextureSharingExtension()
 {
     s_self = this;
@@ -168,6 +296,9 @@ QWaylandTextureSharingExtension::~QWaylandTextureSharingExtension()
     //qDebug() << Q_FUNC_INFO;
     //dumpBufferInfo();
 
+    m_image_loader.clear();
+    m_image_loader.waitForDone();
+
     for (auto b : m_server_buffers)
         delete b.buffer;
 
@@ -182,8 +313,51 @@ void QWaylandTextureSharingExtension::setImageSearchPath(const QString &path)
     for (auto it = m_image_dirs.begin(); it != m_image_dirs.end(); ++it)
         if (!(*it).endsWith(QLatin1Char('/')))
             (*it) += QLatin1Char('/');
+
+    m_resolved_paths.clear();
 }
 
+/*
+    Sets a manifest file listing the keys of images to load in the background when
+    the extension is initialized, one key per line. Empty lines and lines starting
+    with '#' are ignored. The environment variable QT_WAYLAND_SHAREDTEXTURE_PRELOAD
+    can be used instead.
+*/
+void QWaylandTextureSharingExtension::setPreloadManifest(const QString &fileName)
+{
+    m_preload_manifest = fileName;
+    if (isInitialized())
+        preloadImages();
+}
+
+/*
+    Sets a directory where decoded images are stored, so that they are mapped
+    instead of decoded again the next time the compositor starts. The environment
+    variable QT_WAYLAND_SHAREDTEXTURE_DISK_CACHE can be used instead. The least
+    recently used files are deleted when the directory grows past 256 MB, unless
+    QT_WAYLAND_SHAREDTEXTURE_DISK_CACHE_SIZE is set to another number of megabytes.
+*/
+void QWaylandTextureSharingExtension::setDiskCachePath(const QString &path)
+{
+    m_disk_cache_path = path;
+    if (m_disk_cache_path.isEmpty())
+        return;
+    if (!m_disk_cache_path.endsWith(QLatin1Char('/')))
+        m_disk_cache_path += QLatin1Char('/');
+    if (!QDir().mkpath(m_disk_cache_path)) {
+        qWarning() << "QWaylandTextureSharingExtension: could not create disk cache directory" << m_disk_cache_path;
+        m_disk_cache_path.clear();
+    }
+}
+
+/*
+    Buffers that no client or compositor item is using are kept around, so that
+    requesting them again is cheap, until they take more than the cache size. Then
+    the least recently used ones are deleted first. The size is 64 MB, unless
+    QT_WAYLAND_SHAREDTEXTURE_CACHE_SIZE is set to another number of megabytes.
+    Preloaded buffers are kept until they are requested, and preloading stops
+    once they would take more than the cache size.
+*/
 void QWaylandTextureSharingExtension::initialize()
 {
     QWaylandCompositorExtensionTemplate::initialize();
@@ -204,6 +378,17 @@ void QWaylandTextureSharingExtension::initialize()
 
     //qDebug() << "m_image_suffixes" << m_image_suffixes << "m_image_dirs" << m_image_dirs;
 
+    const QString disk_cache_path = qEnvironmentVariable("QT_WAYLAND_SHAREDTEXTURE_DISK_CACHE");
+    if (!disk_cache_path.isEmpty())
+        setDiskCachePath(disk_cache_path);
+
+    bool ok = false;
+    const int cacheSize = qEnvironmentVariableIntValue("QT_WAYLAND_SHAREDTEXTURE_CACHE_SIZE", &ok);
+    m_cache_size = qsizetype(ok ? qMax(cacheSize, 0) : 64) * 1024 * 1024;
+
+    const int diskCacheSize = qEnvironmentVariableIntValue("QT_WAYLAND_SHAREDTEXTURE_DISK_CACHE_SIZE", &ok);
+    m_disk_cache_size = qint64(ok ? qMax(diskCacheSize, 0) : 256) * 1024 * 1024;
+
     auto *ctx = QQmlEngine::contextForObject(this);
     if (ctx) {
         QQmlEngine *engine = ctx->engine();
@@ -213,9 +398,83 @@ void QWaylandTextureSharingExtension::initialize()
                 provider->setExtensionReady(this);
         }
     }
+
+    const QString preload_manifest = qEnvironmentVariable("QT_WAYLAND_SHAREDTEXTURE_PRELOAD");
+    if (!preload_manifest.isEmpty())
+        m_preload_manifest = preload_manifest;
+    if (!m_preload_manifest.isEmpty())
+        preloadImages();
+}
+
+// Starts loading the images listed in the preload manifest, so that they are cached when requested
+void QWaylandTextureSharingExtension::preloadImages()
+{
+    QFile manifest(m_preload_manifest);
+    if (!manifest.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "QWaylandTextureSharingExtension: could not open preload manifest" << m_preload_manifest;
+        return;
+    }
+    if (!initServerBufferIntegration())
+        return;
+
+    m_preload_queue.clear();
+    while (!manifest.atEnd()) {
+        const QString key = QString::fromUtf8(manifest.readLine()).trimmed();
+        if (!key.isEmpty() && !key.startsWith(QLatin1Char('#')))
+            m_preload_queue.append(key);
+    }
+    if (m_preloading_key.isEmpty())
+        preloadNextImage();
+}
+
+// Images are preloaded one at a time, so that preloading can stop as soon as the cache is full
+void QWaylandTextureSharingExtension::preloadNextImage()
+{
+    m_preloading_key.clear();
+    while (!m_preload_queue.isEmpty()) {
+        const QString key = m_preload_queue.takeFirst();
+        if (m_server_buffers.contains(key) || m_pending_images.contains(key))
+            continue;
+
+        bool handled = false;
+        if (getCustomBuffer(key, &handled))
+            keepPreloadedBuffer(key);
+        if (!handled) {
+            PendingImage pending;
+            pending.preload = true;
+            m_pending_images.insert(key, pending);
+            m_preloading_key = key;
+            loadImage(key);
+            return;
+        }
+    }
+    emit preloadFinished();
+}
+
+// Keeps the preloaded buffer for key until it is requested, unless it does not fit in the
+// cache next to the other preloaded buffers. Then it is deleted, and preloading stops.
+bool QWaylandTextureSharingExtension::keepPreloadedBuffer(const QString &key)
+{
+    qsizetype preloaded = 0;
+    for (const BufferInfo &info : std::as_const(m_server_buffers)) {
+        if (info.preloaded)
+            preloaded += info.byteCount;
+    }
+
+    auto it = m_server_buffers.find(key);
+    if (preloaded + it->byteCount > m_cache_size) {
+        qWarning() << "QWaylandTextureSharingExtension: stopped preloading at" << key
+                   << "since the preloaded images would take more than the cache size of" << m_cache_size << "bytes";
+        delete it->buffer;
+        m_server_buffers.erase(it);
+        m_preload_queue.clear();
+        return false;
+    }
+    it->preloaded = true;
+    return true;
 }
 
-QString QWaylandTextureSharingExtension::getExistingFilePath(const QString &key) const
+QString QWaylandTextureSharingExtension::getExistingFilePath(const QString &key, const QStringList &dirs, const QStringList &suffixes)
 {
     // The default search path blocks absolute pathnames, but this does not prevent relative
     // paths containing '../'. We handle that here, at the price of also blocking directory
@@ -224,14 +483,14 @@ QString QWaylandTextureSharingExtension::getExistingFilePath(const QString &key)
     if (key.contains(QLatin1String("../")))
         return QString();
 
-    for (auto dir : std::as_const(m_image_dirs)) {
+    for (auto dir : dirs) {
         QString path = dir + key;
         if (QFileInfo::exists(path))
             return path;
     }
 
-    for (auto dir : std::as_const(m_image_dirs)) {
-        for (auto ext : m_image_suffixes) {
+    for (auto dir : dirs) {
+        for (auto ext : suffixes) {
             QString fp = dir + key + ext;
             //qDebug() << "trying" << fp;
             if (QFileInfo::exists(fp))
@@ -241,77 +500,186 @@ QString QWaylandTextureSharingExtension::getExistingFilePath(const QString &key)
     return QString();
 }
 
-QtWayland::ServerBuffer *QWaylandTextureSharingExtension::getBuffer(const QString &key)
+// Runs in the thread pool
+QWaylandTextureSharingExtension::LoadedImage QWaylandTextureSharingExtension::readImage(const QString &key, QString pathName,
+                                                                                       const QStringList &dirs, const QStringList &suffixes,
+                                                                                       const QString &diskCachePath, qint64 diskCacheSize)
 {
-    if (!initServerBufferIntegration())
-        return nullptr;
+    LoadedImage loaded;
+    if (pathName.isEmpty())
+        pathName = getExistingFilePath(key, dirs, suffixes);
+    //qDebug() << "pathName" << pathName;
+    if (pathName.isEmpty())
+        return loaded;
+    loaded.pathName = pathName;
 
-//qDebug() << "getBuffer" << key;
+    QFile f(pathName);
+    if (f.open(QIODevice::ReadOnly)) {
+        QTextureFileReader r(&f, pathName);
+        if (r.canRead()) {
+            QTextureFileData td(r.read());
+            //qDebug() << "QWaylandTextureSharingExtension: reading compressed texture data" << td;
+            if (td.isValid()) {
+                loaded.textureData = td;
+                return loaded;
+            }
+            qWarning() << "QWaylandTextureSharingExtension:" << pathName << "not valid compressed texture";
+        }
+        f.close();
+    }
 
-    QtWayland::ServerBuffer *buffer = nullptr;
+    // Texture files are read as they are, only decoded images are worth caching
+    const QString cacheFileName = diskCachePath.isEmpty() ? QString() : diskCacheFileName(diskCachePath, pathName);
+    if (!cacheFileName.isEmpty()) {
+        loaded.image = readDiskCacheFile(cacheFileName);
+        if (!loaded.image.isNull())
+            return loaded;
+    }
 
-    if ((buffer = m_server_buffers.value(key).buffer))
-        return buffer;
+    QImage img(pathName);
+    if (!img.isNull()) {
+        loaded.image = img.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+        if (!cacheFileName.isEmpty()) {
+            writeDiskCacheFile(cacheFileName, loaded.image);
+            pruneDiskCache(diskCachePath, diskCacheSize);
+        }
+    }
+    return loaded;
+}
 
+QtWayland::ServerBuffer *QWaylandTextureSharingExtension::cachedBuffer(const QString &key)
+{
+    auto it = m_server_buffers.find(key);
+    if (it == m_server_buffers.end())
+        return nullptr;
+    it->lastUsed = ++m_use_count;
+    it->preloaded = false;
+    return it->buffer;
+}
+
+QtWayland::ServerBuffer *QWaylandTextureSharingExtension::getCustomBuffer(const QString &key, bool *handled)
+{
     QByteArray pixelData;
     QSize size;
     uint glInternalFormat = GL_NONE;
 
-    if (customPixelData(key, &pixelData, &size, &glInternalFormat)) {
-        if (!pixelData.isEmpty()) {
-            buffer = m_server_buffer_integration->createServerBufferFromData(pixelData, size, glInternalFormat);
-            if (!buffer)
-                qWarning() << "QWaylandTextureSharingExtension: could not create buffer from custom data for key:" << key;
-        }
-    } else {
-        QString pathName = getExistingFilePath(key);
-        //qDebug() << "pathName" << pathName;
-        if (pathName.isEmpty())
-            return nullptr;
+    *handled = customPixelData(key, &pixelData, &size, &glInternalFormat);
+    if (!*handled || pixelData.isEmpty())
+        return nullptr;
 
-        buffer = getCompressedBuffer(pathName);
-        //qDebug() << "getCompressedBuffer" << buffer;
+    auto *buffer = m_server_buffer_integration->createServerBufferFromData(pixelData, size, glInternalFormat);
+    if (buffer)
+        insertBuffer(key, buffer, pixelData.size());
+    else
+        qWarning() << "QWaylandTextureSharingExtension: could not create buffer from custom data for key:" << key;
+    return buffer;
+}
 
-        if (!buffer) {
-            QImage img(pathName);
-            if (!img.isNull()) {
-                img = img.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
-                buffer = m_server_buffer_integration->createServerBufferFromImage(img, QtWayland::ServerBuffer::RGBA32);
-            }
-            //qDebug() << "createServerBufferFromImage" << buffer;
-        }
+/*
+    Answers a request for the image \a key from \a resource, or from the compositor
+    itself if \a resource is null. Files are found and decoded in a thread pool, so
+    the answer may come later, and requests for an image that is still loading wait
+    for the same load.
+*/
+void QWaylandTextureSharingExtension::requestImage(const QString &key, Resource *resource)
+{
+    const QList<Resource *> resources = resource ? QList<Resource *>{ resource } : QList<Resource *>();
+
+    if (!initServerBufferIntegration()) {
+        deliverBuffer(key, nullptr, resources, !resource);
+        return;
     }
-    if (buffer)
-        m_server_buffers.insert(key, BufferInfo(buffer));
 
-    //qDebug() << ">>>>" << key << buffer;
+    if (auto *buffer = cachedBuffer(key)) {
+        deliverBuffer(key, buffer, resources, !resource);
+        return;
+    }
 
-    return buffer;
+    bool handled = false;
+    auto *buffer = getCustomBuffer(key, &handled);
+    if (handled) {
+        deliverBuffer(key, buffer, resources, !resource);
+        return;
+    }
+
+    auto pending = m_pending_images.find(key);
+    if (pending == m_pending_images.end()) {
+        pending = m_pending_images.insert(key, PendingImage());
+        loadImage(key);
+    }
+    pending->preload = false;
+    if (resource)
+        pending->resources.append(resource);
+    else
+        pending->local = true;
 }
 
-// Compositor requesting image for its own UI
-void QWaylandTextureSharingExtension::requestBuffer(const QString &key)
+void QWaylandTextureSharingExtension::loadImage(const QString &key)
 {
-    //qDebug() << "requestBuffer" << key;
+    const QString pathName = m_resolved_paths.value(key);
+    m_image_loader.start([this, key, pathName, dirs = m_image_dirs, suffixes = m_image_suffixes,
+                          diskCachePath = m_disk_cache_path, diskCacheSize = m_disk_cache_size] {
+        LoadedImage image = readImage(key, pathName, dirs, suffixes, diskCachePath, diskCacheSize);
+        // The destructor waits for the pool, so this is still alive
+        QMetaObject::invokeMethod(this, [this, key, image] { imageLoaded(key, image); }, Qt::QueuedConnection);
+    });
+}
 
-    if (thread() != QThread::currentThread())
-        qWarning("QWaylandTextureSharingExtension::requestBuffer() called from outside main thread: possible race condition");
+void QWaylandTextureSharingExtension::imageLoaded(const QString &key, const LoadedImage &image)
+{
+    const bool loaded = image.textureData.isValid() || !image.image.isNull();
+    if (!loaded && m_resolved_paths.remove(key)) {
+        // The file was moved or removed since it was found, so look for it again
+        loadImage(key);
+        return;
+    }
+    if (loaded)
+        m_resolved_paths.insert(key, image.pathName);
 
-    auto *buffer = getBuffer(key);
+    const PendingImage pending = m_pending_images.take(key);
 
-    if (buffer)
-        m_server_buffers[key].usedLocally = true;
+    QtWayland::ServerBuffer *buffer = nullptr;
+    if (image.textureData.isValid()) {
+        const QTextureFileData &td = image.textureData;
+        buffer = m_server_buffer_integration->createServerBufferFromData(td.getDataView(), td.size(),
+                                                                         td.glInternalFormat());
+        if (buffer)
+            insertBuffer(key, buffer, td.getDataView().size());
+    }
+    if (!buffer && !image.image.isNull()) {
+        buffer = m_server_buffer_integration->createServerBufferFromImage(image.image, QtWayland::ServerBuffer::RGBA32);
+        //qDebug() << "createServerBufferFromImage" << buffer;
+        if (buffer)
+            insertBuffer(key, buffer, image.image.sizeInBytes());
+    }
 
-    //dumpBufferInfo();
+    //qDebug() << ">>>>" << key << buffer;
 
-    emit bufferResult(key, buffer);
+    // Nobody else waits for a preloaded image, so there is nothing to deliver if it does not fit
+    if (buffer && pending.preload && !keepPreloadedBuffer(key))
+        buffer = nullptr;
+    deliverBuffer(key, buffer, pending.resources, pending.local);
+    cleanupBuffers();
+
+    if (key == m_preloading_key)
+        preloadNextImage();
 }
 
-void QWaylandTextureSharingExtension::zqt_texture_sharing_v1_request_image(Resource *resource, const QString &key)
+void QWaylandTextureSharingExtension::insertBuffer(const QString &key, QtWayland::ServerBuffer *buffer, qsizetype byteCount)
 {
-    //qDebug() << "texture_sharing_request_image" << key;
-    auto *buffer = getBuffer(key);
-    if (buffer) {
+    BufferInfo info(buffer, byteCount);
+    info.lastUsed = ++m_use_count;
+    m_server_buffers.insert(key, info);
+}
+
+void QWaylandTextureSharingExtension::deliverBuffer(const QString &key, QtWayland::ServerBuffer *buffer,
+                                                    const QList<Resource *> &resources, bool local)
+{
+    for (Resource *resource : resources) {
+        if (!buffer) {
+            send_image_failed(resource->handle, key, QString());
+            continue;
+        }
         struct ::wl_client *client = resource->client();
         struct ::wl_resource *buffer_resource = buffer->resourceForClient(client);
         //qDebug() << "          server_buffer resource" << buffer_resource;
@@ -319,27 +687,51 @@ void QWaylandTextureSharingExtension::zqt_texture_sharing_v1_request_image(Resou
             send_provide_buffer(resource->handle, buffer_resource, key);
         else
             qWarning() << "QWaylandTextureSharingExtension: no buffer resource for client";
-    } else {
-        send_image_failed(resource->handle, key, QString());
+    }
+
+    if (local) {
+        if (buffer)
+            m_server_buffers[key].usedLocally = true;
+        emit bufferResult(key, buffer);
     }
     //dumpBufferInfo();
 }
 
+// Compositor requesting image for its own UI
+void QWaylandTextureSharingExtension::requestBuffer(const QString &key)
+{
+    //qDebug() << "requestBuffer" << key;
+
+    if (thread() != QThread::currentThread())
+        qWarning("QWaylandTextureSharingExtension::requestBuffer() called from outside main thread: possible race condition");
+
+    requestImage(key, nullptr);
+}
+
+void QWaylandTextureSharingExtension::zqt_texture_sharing_v1_request_image(Resource *resource, const QString &key)
+{
+    //qDebug() << "texture_sharing_request_image" << key;
+    requestImage(key, resource);
+}
+
 void QWaylandTextureSharingExtension::zqt_texture_sharing_v1_abandon_image(Resource *resource, const QString &key)
 {
     Q_UNUSED(resource);
     Q_UNUSED(key);
 //    qDebug() << Q_FUNC_INFO << resource << key;
-    QTimer::singleShot(100, this, &QWaylandTextureSharingExtension::cleanupBuffers);
+    // The client releases its buffer after abandoning the image
+    QMetaObject::invokeMethod(this, &QWaylandTextureSharingExtension::cleanupBuffers, Qt::QueuedConnection);
 }
 
 // A client has disconnected
 void QWaylandTextureSharingExtension::zqt_texture_sharing_v1_destroy_resource(Resource *resource)
 {
-    Q_UNUSED(resource);
 //    qDebug() << "texture_sharing_destroy_resource" << resource->handle << resource->handle->object.id << "client" << resource->client();
 //    dumpBufferInfo();
-    QTimer::singleShot(1000, this, &QWaylandTextureSharingExtension::cleanupBuffers);
+    for (auto &pending : m_pending_images)
+        pending.resources.removeAll(resource);
+    // The client's buffer resources are destroyed after this one
+    QMetaObject::invokeMethod(this, &QWaylandTextureSharingExtension::cleanupBuffers, Qt::QueuedConnection);
 }
 
 bool QWaylandTextureSharingExtension::initServerBufferIntegration()
@@ -358,41 +750,31 @@ bool QWaylandTextureSharingExtension::initServerBufferIntegration()
     return true;
 }
 
-QtWayland::ServerBuffer *QWaylandTextureSharingExtension::getCompressedBuffer(const QString &pathName)
-{
-    QFile f(pathName);
-    if (!f.open(QIODevice::ReadOnly))
-        return nullptr;
-
-    QTextureFileReader r(&f, pathName);
-
-    if (!r.canRead())
-        return nullptr;
-
-    QTextureFileData td(r.read());
-
-    //qDebug() << "QWaylandTextureSharingExtension: reading compressed texture data" << td;
-
-    if (!td.isValid()) {
-        qWarning() << "VulkanServerBufferIntegration:" << pathName << "not valid compressed texture";
-        return nullptr;
-    }
-
-    return m_server_buffer_integration->createServerBufferFromData(td.getDataView(), td.size(),
-                                                                   td.glInternalFormat());
-}
-
+// Deletes the least recently used buffers nobody uses until the cache fits its size.
+// Preloaded buffers are kept until they are requested, since that is what they are for,
+// and they never take more than the cache size.
 void QWaylandTextureSharingExtension::cleanupBuffers()
 {
-    for (auto it = m_server_buffers.begin(); it != m_server_buffers.end(); ) {
-        auto *buffer = it.value().buffer;
-        if (!it.value().usedLocally && !buffer->bufferInUse()) {
-            //qDebug() << "deleting buffer for" << it.key();
-            it = m_server_buffers.erase(it);
-            delete buffer;
-        } else {
-            ++it;
-        }
+    qsizetype total = 0;
+    QList<QString> unused;
+    for (auto it = m_server_buffers.cbegin(); it != m_server_buffers.cend(); ++it) {
+        total += it.value().byteCount;
+        if (!it.value().preloaded && !it.value().usedLocally && !it.value().buffer->bufferInUse())
+            unused.append(it.key());
+    }
+    if (total <= m_cache_size)
+        return;
+
+    std::sort(unused.begin(), unused.end(), [this](const QString &a, const QString &b) {
+        return m_server_buffers.value(a).lastUsed < m_server_buffers.value(b).lastUsed;
+    });
+    for (const QString &key : std::as_const(unused)) {
+        if (total <= m_cache_size)
+            break;
+        const BufferInfo info = m_server_buffers.take(key);
+        //qDebug() << "deleting buffer for" << key;
+        total -= info.byteCount;
+        delete info.buffer;
     }
     //dumpBufferInfo();
 }
@@ -401,7 +783,7 @@ void QWaylandTextureSharingExtension::dumpBufferInfo()
 {
     qDebug() << "shared buffers:" << m_server_buffers.size();
     for (auto it = m_server_buffers.cbegin(); it != m_server_buffers.cend(); ++it)
-        qDebug() << "    " << it.key() << ":" << it.value().buffer << "in use" << it.value().buffer->bufferInUse() << "usedLocally" << it.value().usedLocally ;
+        qDebug() << "    " << it.key() << ":" << it.value().buffer << "in use" << it.value().buffer->bufferInUse() << "usedLocally" << it.value().usedLocally << "preloaded" << it.value().preloaded;
 }
 
 QT_END_NAMESPACE
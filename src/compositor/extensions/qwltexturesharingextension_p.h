@@ -19,6 +19,7 @@
 
 #include <QtCore/QMap>
 #include <QtCore/QHash>
+#include <QtCore/QThreadPool>
 
 #include <QtWaylandCompositor/QWaylandCompositorExtensionTemplate>
 #include <QtWaylandCompositor/QWaylandQuickExtension>
@@ -60,6 +61,8 @@ class Q_WAYLANDCOMPOSITOR_EXPORT QWaylandTextureSharingExtension
 {
     Q_OBJECT
     Q_PROPERTY(QString imageSearchPath WRITE setImageSearchPath)
+    Q_PROPERTY(QString preloadManifest WRITE setPreloadManifest)
+    Q_PROPERTY(QString diskCachePath WRITE setDiskCachePath)
 public:
     QWaylandTextureSharingExtension();
     QWaylandTextureSharingExtension(QWaylandCompositor *compositor);
@@ -68,6 +71,8 @@ public:
     void initialize() override;
 
     void setImageSearchPath(const QString &path);
+    void setPreloadManifest(const QString &fileName);
+    void setDiskCachePath(const QString &path);
 
     static QWaylandTextureSharingExtension *self() { return s_self; }
 
@@ -76,6 +81,7 @@ public Q_SLOTS:
 
 Q_SIGNALS:
      void bufferResult(const QString &key, QtWayland::ServerBuffer *buffer);
+     void preloadFinished();
 
 protected Q_SLOTS:
     void cleanupBuffers();
@@ -95,22 +101,55 @@ protected:
     }
 
 private:
-    QtWayland::ServerBuffer *getBuffer(const QString &key);
+    struct LoadedImage;
+
+    void requestImage(const QString &key, Resource *resource);
+    QtWayland::ServerBuffer *cachedBuffer(const QString &key);
+    QtWayland::ServerBuffer *getCustomBuffer(const QString &key, bool *handled);
+    void loadImage(const QString &key);
+    void preloadImages();
+    void preloadNextImage();
+    bool keepPreloadedBuffer(const QString &key);
+    void imageLoaded(const QString &key, const LoadedImage &image);
+    void insertBuffer(const QString &key, QtWayland::ServerBuffer *buffer, qsizetype byteCount);
+    void deliverBuffer(const QString &key, QtWayland::ServerBuffer *buffer, const QList<Resource *> &resources, bool local);
     bool initServerBufferIntegration();
-    QtWayland::ServerBuffer *getCompressedBuffer(const QString &key);
-    QString getExistingFilePath(const QString &key) const;
+    static LoadedImage readImage(const QString &key, QString pathName, const QStringList &dirs, const QStringList &suffixes,
+                                 const QString &diskCachePath, qint64 diskCacheSize);
+    static QString getExistingFilePath(const QString &key, const QStringList &dirs, const QStringList &suffixes);
     void dumpBufferInfo();
 
     struct BufferInfo
     {
-        BufferInfo(QtWayland::ServerBuffer *b = nullptr) : buffer(b) {}
+        BufferInfo(QtWayland::ServerBuffer *b = nullptr, qsizetype bytes = 0) : buffer(b), byteCount(bytes) {}
         QtWayland::ServerBuffer *buffer = nullptr;
+        qsizetype byteCount = 0;
+        quint64 lastUsed = 0;
         bool usedLocally = false;
+        bool preloaded = false;
+    };
+
+    // Requests waiting for an image that is being loaded
+    struct PendingImage
+    {
+        QList<Resource *> resources;
+        bool local = false;
+        bool preload = false;
     };
 
     QStringList m_image_dirs;
     QStringList m_image_suffixes;
+    QHash<QString, QString> m_resolved_paths;
+    QString m_preload_manifest;
+    QStringList m_preload_queue;
+    QString m_preloading_key;
+    QString m_disk_cache_path;
+    qint64 m_disk_cache_size = 0;
     QHash<QString, BufferInfo> m_server_buffers;
+    QHash<QString, PendingImage> m_pending_images;
+    quint64 m_use_count = 0;
+    qsizetype m_cache_size = 0;
+    QThreadPool m_image_loader;
     QtWayland::ServerBufferIntegration *m_server_buffer_integration = nullptr;
 
     static QWaylandTextureSharingExtension *s_self;
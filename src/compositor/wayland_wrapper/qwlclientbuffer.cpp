@@ -7,6 +7,7 @@
 #include "hardware_integration/qwlclientbufferintegration_p.h"
 #include <qpa/qplatformopenglcontext.h>
 #include <QOpenGLTexture>
+#include <QOpenGLContext>
 #endif
 
 #include <QtCore/QDebug>
@@ -16,6 +17,24 @@
 
 #include <QtWaylandCompositor/private/qwaylandcompositor_p.h>
 
+#if QT_CONFIG(opengl)
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+#ifndef GL_TEXTURE_SWIZZLE_R
+#define GL_TEXTURE_SWIZZLE_R 0x8E42
+#endif
+#ifndef GL_TEXTURE_SWIZZLE_B
+#define GL_TEXTURE_SWIZZLE_B 0x8E44
+#endif
+#ifndef GL_TEXTURE_SWIZZLE_A
+#define GL_TEXTURE_SWIZZLE_A 0x8E45
+#endif
+#endif
+
 QT_BEGIN_NAMESPACE
 
 namespace QtWayland {
@@ -71,6 +90,16 @@ void ClientBuffer::setCommitted(QRegion &damage)
      m_textureDirty = true;
 }
 
+/*
+    Adds \a damage, in buffer coordinates, to the region of the buffer that has changed
+    since its contents were last copied into a texture. This is called before
+    setCommitted().
+*/
+void ClientBuffer::addBufferDamage(const QRegion &damage)
+{
+    m_bufferDamage |= damage;
+}
+
 QWaylandBufferRef::BufferFormatEgl ClientBuffer::bufferFormatEgl() const
 {
     return QWaylandBufferRef::BufferFormatEgl_Null;
@@ -123,6 +152,105 @@ QImage SharedMemoryBuffer::image() const
 }
 
 #if QT_CONFIG(opengl)
+namespace {
+struct ShmTextureUpload
+{
+    GLenum internalFormat = GL_RGBA;
+    GLenum format = GL_RGBA;
+    // Only used if the client's pixel layout cannot be uploaded as is
+    QImage::Format convertTo = QImage::Format_Invalid;
+    bool canSwizzle = false;
+    bool swapRedBlue = false;
+    bool forceOpaque = false;
+};
+}
+
+static ShmTextureUpload shmTextureUploadFor(QImage::Format imageFormat, QOpenGLContext *context)
+{
+    const bool isGles = context->isOpenGLES();
+    const auto version = context->format().version();
+
+    ShmTextureUpload upload;
+    upload.canSwizzle = isGles ? version >= qMakePair(3, 0) : version >= qMakePair(3, 3);
+    const bool hasBgra = !isGles || context->hasExtension(QByteArrayLiteral("GL_EXT_texture_format_BGRA8888"));
+
+    // Wayland buffers have premultiplied alpha, and so does the texture, so wl_shm data is
+    // uploaded as is and at most swizzled
+    switch (imageFormat) {
+    case QImage::Format_RGBA8888_Premultiplied:
+        break;
+    case QImage::Format_RGBX8888:
+        upload.forceOpaque = true;
+        break;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_RGB32:
+        // Memory layout is B, G, R, A
+        upload.forceOpaque = imageFormat == QImage::Format_RGB32;
+        if (hasBgra) {
+            upload.format = GL_BGRA;
+            if (isGles)
+                upload.internalFormat = GL_BGRA;
+        } else if (upload.canSwizzle) {
+            upload.swapRedBlue = true;
+        } else {
+            upload.convertTo = upload.forceOpaque ? QImage::Format_RGBX8888
+                                                  : QImage::Format_RGBA8888_Premultiplied;
+        }
+        break;
+#endif
+    default:
+        upload.convertTo = QImage::toPixelFormat(imageFormat).alphaUsage() == QPixelFormat::UsesAlpha
+                ? QImage::Format_RGBA8888_Premultiplied
+                : QImage::Format_RGBX8888;
+        break;
+    }
+
+    if (upload.forceOpaque && !upload.canSwizzle) {
+        // The undefined X channel must not end up as alpha, let the conversion fill it in
+        upload = ShmTextureUpload();
+        upload.convertTo = QImage::Format_RGBX8888;
+    } else if (upload.convertTo != QImage::Format_Invalid) {
+        upload.forceOpaque = false;
+    }
+
+    return upload;
+}
+
+static void uploadShmImage(const QImage &image, const ShmTextureUpload &upload, const QRegion &region,
+                           QOpenGLContext *context)
+{
+    const bool isGles = context->isOpenGLES();
+    const bool hasRowLength = !isGles || context->format().majorVersion() >= 3
+            || context->hasExtension(QByteArrayLiteral("GL_EXT_unpack_subimage"));
+    const int bytesPerPixel = image.depth() / 8;
+    const bool canUseRowLength = hasRowLength && image.bytesPerLine() % bytesPerPixel == 0;
+
+    // Many tiny uploads cost more than a single bigger one
+    const QRegion uploadRegion = region.rectCount() > 16 ? QRegion(region.boundingRect()) : region;
+
+    for (const QRect &rect : uploadRegion) {
+        if (upload.convertTo != QImage::Format_Invalid) {
+            // Only convert the damaged part, the result is tightly packed
+            const QImage converted = image.copy(rect).convertToFormat(upload.convertTo);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                            upload.format, GL_UNSIGNED_BYTE, converted.constBits());
+        } else if (canUseRowLength || rect.width() * bytesPerPixel == image.bytesPerLine()) {
+            // Upload directly from the shared memory
+            if (canUseRowLength)
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, image.bytesPerLine() / bytesPerPixel);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                            upload.format, GL_UNSIGNED_BYTE, image.constScanLine(rect.y()) + rect.x() * bytesPerPixel);
+            if (canUseRowLength)
+                glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        } else {
+            const QImage copy = image.copy(rect);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, rect.x(), rect.y(), rect.width(), rect.height(),
+                            upload.format, GL_UNSIGNED_BYTE, copy.constBits());
+        }
+    }
+}
+
 QOpenGLTexture *SharedMemoryBuffer::toOpenGlTexture(int plane)
 {
     Q_UNUSED(plane);
@@ -135,20 +263,31 @@ QOpenGLTexture *SharedMemoryBuffer::toOpenGlTexture(int plane)
             m_textureDirty = false;
             m_shmTexture->bind();
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-            // TODO: partial texture upload
-            QImage image = this->image();
-            m_shmTexture->setSize(image.width(), image.height());
-            if (image.hasAlphaChannel()) {
-                m_shmTexture->setFormat(QOpenGLTexture::RGBAFormat);
-                if (image.format() != QImage::Format_RGBA8888)
-                    image = image.convertToFormat(QImage::Format_RGBA8888);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width(), image.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
-            } else {
-                m_shmTexture->setFormat(QOpenGLTexture::RGBFormat);
-                if (image.format() != QImage::Format_RGBX8888)
-                    image = image.convertToFormat(QImage::Format_RGBX8888);
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, image.width(), image.height(), 0, GL_RGB, GL_UNSIGNED_BYTE, image.constBits());
+
+            QOpenGLContext *context = QOpenGLContext::currentContext();
+            const QImage image = this->image();
+            const ShmTextureUpload upload = shmTextureUploadFor(image.format(), context);
+            QRegion damage = std::exchange(m_bufferDamage, QRegion());
+
+            if (image.size() != m_textureSize || image.format() != m_textureImageFormat) {
+                // Allocate the storage once, it is kept as long as size and format stay the same
+                m_textureSize = image.size();
+                m_textureImageFormat = image.format();
+                m_shmTexture->setSize(image.width(), image.height());
+                m_shmTexture->setFormat(image.hasAlphaChannel() ? QOpenGLTexture::RGBAFormat
+                                                                : QOpenGLTexture::RGBFormat);
+                glTexImage2D(GL_TEXTURE_2D, 0, upload.internalFormat, image.width(), image.height(), 0,
+                             upload.format, GL_UNSIGNED_BYTE, nullptr);
+                if (upload.canSwizzle) {
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, upload.swapRedBlue ? GL_BLUE : GL_RED);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, upload.swapRedBlue ? GL_RED : GL_BLUE);
+                    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, upload.forceOpaque ? GL_ONE : GL_ALPHA);
+                }
+                damage = image.rect();
             }
+
+            uploadShmImage(image, upload, damage.intersected(image.rect()), context);
+
             //we can release the buffer after uploading, since we have a copy
             if (isCommitted())
                 sendRelease();
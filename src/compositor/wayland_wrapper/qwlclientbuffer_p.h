@@ -18,6 +18,7 @@
 #include <QtCore/QRect>
 #include <QtGui/qopengl.h>
 #include <QImage>
+#include <QColor>
 #include <QAtomicInt>
 #include <QScopedPointer>
 
@@ -57,9 +58,11 @@ public:
     virtual void unlockNativeBuffer(quintptr native_buffer) const { Q_UNUSED(native_buffer); }
 
     virtual QImage image() const { return QImage(); }
+    virtual QColor solidColor() const { return QColor(); }
 
     inline bool isCommitted() const { return m_committed; }
     virtual void setCommitted(QRegion &damage);
+    void addBufferDamage(const QRegion &damage);
     bool isDestroyed() { return m_destroyed; }
 
     virtual bool isProtected() { return false; }
@@ -83,6 +86,7 @@ protected:
 
     struct ::wl_resource *m_buffer = nullptr;
     QRegion m_damage;
+    QRegion m_bufferDamage;
     bool m_textureDirty = false;
 
 private:
@@ -109,6 +113,8 @@ public:
 
 private:
     QScopedPointer<QOpenGLTexture> m_shmTexture;
+    QSize m_textureSize;
+    QImage::Format m_textureImageFormat = QImage::Format_Invalid;
 #endif
 };
 
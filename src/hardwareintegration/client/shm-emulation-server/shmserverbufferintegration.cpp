@@ -9,8 +9,34 @@
 #include <QtGui/QImage>
 #include <QtCore/QSharedMemory>
 
+#include <unistd.h>
+#include <sys/mman.h>
+
 QT_BEGIN_NAMESPACE
 
+static QImage::Format toImageFormat(int format)
+{
+    switch (format) {
+        case QtWayland::qt_shm_emulation_server_buffer::format_RGBA32:
+            return QImage::Format_RGBA8888;
+        case QtWayland::qt_shm_emulation_server_buffer::format_A8:
+            return QImage::Format_Alpha8;
+        default:
+            qWarning() << "ShmServerBuffer: unknown format" << format;
+            return QImage::Format_RGBA8888;
+    }
+}
+
+static QOpenGLTexture *createTexture(const uchar *data, int w, int h, int bpl, int format)
+{
+    QImage image(data, w, h, bpl, toImageFormat(format));
+
+    if (!QOpenGLContext::currentContext())
+        qWarning("ShmServerBuffer: creating texture with no current context");
+
+    return new QOpenGLTexture(image, QOpenGLTexture::DontGenerateMipMaps);
+}
+
 static QOpenGLTexture *createTextureFromShm(const QString &key, int w, int h, int bpl, int format)
 {
     QT_IGNORE_DEPRECATIONS(QSharedMemory shm(key);)
@@ -26,26 +52,7 @@ static QOpenGLTexture *createTextureFromShm(const QString &key, int w, int h, in
         return nullptr;
     }
 
-    QImage::Format imageFormat;
-    switch (format) {
-        case QtWayland::qt_shm_emulation_server_buffer::format_RGBA32:
-            imageFormat = QImage::Format_RGBA8888;
-            break;
-        case QtWayland::qt_shm_emulation_server_buffer::format_A8:
-            imageFormat = QImage::Format_Alpha8;
-            break;
-        default:
-            qWarning() << "ShmServerBuffer: unknown format" << format;
-            imageFormat = QImage::Format_RGBA8888;
-            break;
-    }
-
-    QImage image(static_cast<const uchar*>(shm.constData()), w, h, bpl, imageFormat);
-
-    if (!QOpenGLContext::currentContext())
-        qWarning("ShmServerBuffer: creating texture with no current context");
-
-    auto *tex = new QOpenGLTexture(image, QOpenGLTexture::DontGenerateMipMaps);
+    auto *tex = createTexture(static_cast<const uchar*>(shm.constData()), w, h, bpl, format);
     shm.unlock();
     return tex;
 }
@@ -53,24 +60,79 @@ static QOpenGLTexture *createTextureFromShm(const QString &key, int w, int h, in
 
 namespace QtWaylandClient {
 
-ShmServerBuffer::ShmServerBuffer(const QString &key, const QSize& size, int bytesPerLine, QWaylandServerBuffer::Format format)
-    : m_key(key)
+ShmServerBuffer::ShmServerBuffer(struct ::qt_server_buffer *id, const QString &key, const QSize& size, int bytesPerLine, QWaylandServerBuffer::Format format)
+    : m_server_buffer(id)
+    , m_key(key)
+    , m_bpl(bytesPerLine)
+{
+    m_format = format;
+    m_size = size;
+}
+
+/*
+    Maps the sealed memfd sent with server_buffer_created_fd. Its contents can not
+    change anymore, so the mapping is read without locking and shared by the
+    textures of all contexts.
+*/
+ShmServerBuffer::ShmServerBuffer(struct ::qt_server_buffer *id, int fd, const QSize &size, int bytesPerLine, QWaylandServerBuffer::Format format)
+    : m_server_buffer(id)
     , m_bpl(bytesPerLine)
 {
     m_format = format;
     m_size = size;
+
+    m_mappedSize = qsizetype(bytesPerLine) * size.height();
+    void *data = mmap(nullptr, m_mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        qErrnoWarning("ShmServerBuffer: could not map server buffer");
+        m_mappedSize = 0;
+    } else {
+        m_data = static_cast<const uchar *>(data);
+    }
+    close(fd);
 }
 
 ShmServerBuffer::~ShmServerBuffer()
 {
+    // Textures can only be deleted while their share group is current, the
+    // others are deleted when their group goes away
+    QOpenGLContextGroup *currentGroup = QOpenGLContextGroup::currentContextGroup();
+    for (auto it = m_textures.cbegin(); it != m_textures.cend(); ++it) {
+        QOpenGLTexture *texture = it.value();
+        if (!texture)
+            continue;
+        if (!it.key() || it.key() == currentGroup)
+            delete texture;
+        else
+            QObject::connect(it.key(), &QObject::destroyed, it.key(), [texture] { delete texture; });
+    }
+
+    if (m_data)
+        munmap(const_cast<uchar *>(m_data), m_mappedSize);
+
+    qt_server_buffer_release(m_server_buffer);
+    qt_server_buffer_destroy(m_server_buffer);
 }
 
 QOpenGLTexture *ShmServerBuffer::toOpenGlTexture()
 {
-    if (!m_texture)
-        m_texture = createTextureFromShm(m_key, m_size.width(), m_size.height(), m_bpl, m_format);
-
-    return m_texture;
+    QOpenGLContextGroup *group = QOpenGLContextGroup::currentContextGroup();
+    QOpenGLTexture *&texture = m_textures[group];
+    if (texture)
+        return texture;
+
+    if (m_data)
+        texture = createTexture(m_data, m_size.width(), m_size.height(), m_bpl, m_format);
+    else if (!m_key.isEmpty())
+        texture = createTextureFromShm(m_key, m_size.width(), m_size.height(), m_bpl, m_format);
+
+    // The texture goes away with the contexts it was created in
+    if (texture && group) {
+        QObject::connect(group, &QObject::destroyed, &m_textureGuard, [this, group] {
+            delete m_textures.take(group);
+        });
+    }
+    return texture;
 }
 
 void ShmServerBufferIntegration::initialize(QWaylandDisplay *display)
@@ -86,10 +148,9 @@ QWaylandServerBuffer *ShmServerBufferIntegration::serverBuffer(struct qt_server_
 
 void ShmServerBufferIntegration::wlDisplayHandleGlobal(void *data, ::wl_registry *registry, uint32_t id, const QString &interface, uint32_t version)
 {
-    Q_UNUSED(version);
     if (interface == "qt_shm_emulation_server_buffer") {
         auto *integration = static_cast<ShmServerBufferIntegration *>(data);
-        integration->QtWayland::qt_shm_emulation_server_buffer::init(registry, id, 1);
+        integration->QtWayland::qt_shm_emulation_server_buffer::init(registry, id, qMin(version, 2u));
     }
 }
 
@@ -98,7 +159,15 @@ void QtWaylandClient::ShmServerBufferIntegration::shm_emulation_server_buffer_se
 {
     QSize size(width, height);
     auto fmt = QWaylandServerBuffer::Format(format);
-    auto *server_buffer = new ShmServerBuffer(key, size, bytes_per_line, fmt);
+    auto *server_buffer = new ShmServerBuffer(id, key, size, bytes_per_line, fmt);
+    qt_server_buffer_set_user_data(id, server_buffer);
+}
+
+void QtWaylandClient::ShmServerBufferIntegration::shm_emulation_server_buffer_server_buffer_created_fd(qt_server_buffer *id, int32_t fd, int32_t width, int32_t height, int32_t bytes_per_line, int32_t format)
+{
+    QSize size(width, height);
+    auto fmt = QWaylandServerBuffer::Format(format);
+    auto *server_buffer = new ShmServerBuffer(id, fd, size, bytes_per_line, fmt);
     qt_server_buffer_set_user_data(id, server_buffer);
 }
 
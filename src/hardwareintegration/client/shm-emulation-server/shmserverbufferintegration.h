@@ -10,10 +10,14 @@
 
 #include "shmserverbufferintegration.h"
 #include <QtWaylandClient/private/qwaylanddisplay_p.h>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
 #include <QtCore/QTextStream>
 
 QT_BEGIN_NAMESPACE
 
+class QOpenGLContextGroup;
+
 namespace QtWaylandClient {
 
 class ShmServerBufferIntegration;
@@ -21,12 +25,18 @@ class ShmServerBufferIntegration;
 class ShmServerBuffer : public QWaylandServerBuffer
 {
 public:
-    ShmServerBuffer(const QString &key, const QSize &size, int bytesPerLine, QWaylandServerBuffer::Format format);
+    ShmServerBuffer(struct ::qt_server_buffer *id, const QString &key, const QSize &size, int bytesPerLine, QWaylandServerBuffer::Format format);
+    ShmServerBuffer(struct ::qt_server_buffer *id, int fd, const QSize &size, int bytesPerLine, QWaylandServerBuffer::Format format);
     ~ShmServerBuffer() override;
     QOpenGLTexture* toOpenGlTexture() override;
 private:
-    QOpenGLTexture *m_texture = nullptr;
+    // One texture for each share group, all made from the same mapping
+    QHash<QOpenGLContextGroup *, QOpenGLTexture *> m_textures;
+    QObject m_textureGuard;
+    struct ::qt_server_buffer *m_server_buffer = nullptr;
     QString m_key;
+    const uchar *m_data = nullptr;
+    qsizetype m_mappedSize = 0;
     int m_bpl;
 };
 
@@ -41,6 +51,7 @@ public:
 
 protected:
     void shm_emulation_server_buffer_server_buffer_created(qt_server_buffer *id, const QString &key, int32_t width, int32_t height, int32_t bytes_per_line, int32_t format) override;
+    void shm_emulation_server_buffer_server_buffer_created_fd(qt_server_buffer *id, int32_t fd, int32_t width, int32_t height, int32_t bytes_per_line, int32_t format) override;
 
 private:
     static void wlDisplayHandleGlobal(void *data, struct ::wl_registry *registry, uint32_t id,
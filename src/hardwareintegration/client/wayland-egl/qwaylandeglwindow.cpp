@@ -53,7 +53,7 @@ void QWaylandEglWindow::ensureSize()
 {
     // this is always called on the main thread
     QRect rect = geometry();
-    QMargins margins = clientSideMargins();
+    QMargins margins = bufferMargins();
     QSize sizeWithMargins = (rect.size() + QSize(margins.left() + margins.right(), margins.top() + margins.bottom())) * scale();
     {
         QWriteLocker lock(&m_bufferSizeLock);
@@ -142,7 +142,7 @@ void QWaylandEglWindow::updateSurface(bool create)
 QRect QWaylandEglWindow::contentsRect() const
 {
     QRect r = geometry();
-    QMargins m = clientSideMargins();
+    QMargins m = bufferMargins();
     return QRect(m.left(), m.bottom(), r.width(), r.height());
 }
 
@@ -172,7 +172,7 @@ EGLSurface QWaylandEglWindow::eglSurface() const
 
 GLuint QWaylandEglWindow::contentFBO() const
 {
-    if (!decoration())
+    if (!decoration() || hasDecorationSurface())
         return 0;
 
     if (m_resize || !m_contentFBO) {
@@ -194,7 +194,7 @@ GLuint QWaylandEglWindow::contentTexture() const
 
 void QWaylandEglWindow::bindContentFBO()
 {
-    if (decoration()) {
+    if (decoration() && !hasDecorationSurface()) {
         contentFBO();
         m_contentFBO->bind();
     }
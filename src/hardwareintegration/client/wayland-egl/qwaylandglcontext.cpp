@@ -373,7 +373,7 @@ void QWaylandGLContext::swapBuffers(QPlatformSurface *surface)
 
     EGLSurface eglSurface = window->eglSurface();
 
-    if (window->decoration()) {
+    if (window->decoration() && !window->hasDecorationSurface()) {
         if (m_api != EGL_OPENGL_ES_API)
             eglBindAPI(EGL_OPENGL_ES_API);
 
@@ -9,8 +9,74 @@
 
 #include <QtCore/QDebug>
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifdef Q_OS_LINUX
+#  include <sys/syscall.h>
+// from linux/memfd.h:
+#  ifndef MFD_CLOEXEC
+#    define MFD_CLOEXEC     0x0001U
+#  endif
+#  ifndef MFD_ALLOW_SEALING
+#    define MFD_ALLOW_SEALING 0x0002U
+#  endif
+// from bits/fcntl-linux.h
+#  ifndef F_ADD_SEALS
+#    define F_ADD_SEALS 1033
+#  endif
+#  ifndef F_SEAL_SEAL
+#    define F_SEAL_SEAL 0x0001
+#  endif
+#  ifndef F_SEAL_SHRINK
+#    define F_SEAL_SHRINK 0x0002
+#  endif
+#  ifndef F_SEAL_GROW
+#    define F_SEAL_GROW 0x0004
+#  endif
+#  ifndef F_SEAL_WRITE
+#    define F_SEAL_WRITE 0x0008
+#  endif
+#endif
+
 QT_BEGIN_NAMESPACE
 
+/*
+    Returns a memfd holding a copy of the first size bytes of data, sealed so that
+    clients can map it without any locking, or -1 if memfds are not supported.
+*/
+static int createSealedMemfd(const uchar *data, qsizetype size)
+{
+    int fd = -1;
+#ifdef SYS_memfd_create
+    fd = syscall(SYS_memfd_create, "qt-shm-server-buffer", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+        return -1;
+
+    bool ok = ftruncate(fd, size) == 0;
+    if (ok) {
+        void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ok = map != MAP_FAILED;
+        if (ok) {
+            memcpy(map, data, size);
+            // F_SEAL_WRITE fails while writable mappings exist
+            munmap(map, size);
+        }
+    }
+    ok = ok && fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) == 0;
+    if (!ok) {
+        qErrnoWarning("ShmServerBuffer: could not create memfd");
+        close(fd);
+        fd = -1;
+    }
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+#endif
+    return fd;
+}
+
 ShmServerBuffer::ShmServerBuffer(ShmServerBufferIntegration *integration, const QImage &qimage, QtWayland::ServerBuffer::Format format)
     : QtWayland::ServerBuffer(qimage.size(),format)
     , m_integration(integration)
@@ -32,24 +98,36 @@ ShmServerBuffer::ShmServerBuffer(ShmServerBufferIntegration *integration, const
             break;
     }
 
-    QString key = "qt_shm_emulation_" + QString::number(qimage.cacheKey());
+    // The pixels go into a sealed memfd, which clients binding version 2 map directly.
+    // The QSharedMemory segment is only created once a version 1 client needs it.
+    m_cacheKey = qimage.cacheKey();
+    m_byteCount = qimage.sizeInBytes();
+    m_fd = createSealedMemfd(qimage.constBits(), m_byteCount);
+    if (m_fd < 0)
+        createSharedMemory(qimage.constBits());
+}
+
+ShmServerBuffer::~ShmServerBuffer()
+{
+    if (m_fd >= 0)
+        close(m_fd);
+    delete m_shm;
+}
+
+void ShmServerBuffer::createSharedMemory(const uchar *data)
+{
+    QString key = "qt_shm_emulation_" + QString::number(m_cacheKey);
     // ### Use proper native keys the next time we can break protocol compatibility
     QT_IGNORE_DEPRECATIONS(m_shm = new QSharedMemory(key);)
-    qsizetype shm_size = qimage.sizeInBytes();
-    bool ok = m_shm->create(shm_size) && m_shm->lock();
+    bool ok = m_shm->create(m_byteCount) && m_shm->lock();
     if (ok) {
-        memcpy(m_shm->data(), qimage.constBits(), shm_size);
+        memcpy(m_shm->data(), data, m_byteCount);
         m_shm->unlock();
     } else {
-        qWarning() << "Could not create shared memory" << key << shm_size;
+        qWarning() << "Could not create shared memory" << key << m_byteCount;
     }
 }
 
-ShmServerBuffer::~ShmServerBuffer()
-{
-    delete m_shm;
-}
-
 struct ::wl_resource *ShmServerBuffer::resourceForClient(struct ::wl_client *client)
 {
     auto *bufferResource = resourceMap().value(client);
@@ -61,7 +139,21 @@ struct ::wl_resource *ShmServerBuffer::resourceForClient(struct ::wl_client *cli
         }
         struct ::wl_resource *shm_integration_resource = integrationResource->handle;
         Resource *resource = add(client, 1);
-        QT_IGNORE_DEPRECATIONS(const QString shmKey = m_shm->key();)
+        if (m_fd >= 0 && integrationResource->version() >= 2) {
+            m_integration->send_server_buffer_created_fd(shm_integration_resource, resource->handle, m_fd, m_width, m_height, m_bpl, m_shm_format);
+            return resource->handle;
+        }
+
+        if (!m_shm) {
+            const void *data = mmap(nullptr, m_byteCount, PROT_READ, MAP_SHARED, m_fd, 0);
+            if (data != MAP_FAILED) {
+                createSharedMemory(static_cast<const uchar *>(data));
+                munmap(const_cast<void *>(data), m_byteCount);
+            } else {
+                qErrnoWarning("ShmServerBuffer: could not map memfd");
+            }
+        }
+        QT_IGNORE_DEPRECATIONS(const QString shmKey = m_shm ? m_shm->key() : QString();)
         m_integration->send_server_buffer_created(shm_integration_resource, resource->handle, shmKey, m_width, m_height, m_bpl, m_shm_format);
         return resource->handle;
     }
@@ -73,6 +165,11 @@ bool ShmServerBuffer::bufferInUse()
     return resourceMap().size() > 0;
 }
 
+void ShmServerBuffer::server_buffer_release(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
 QOpenGLTexture *ShmServerBuffer::toOpenGlTexture()
 {
     if (!m_texture) {
@@ -93,7 +190,7 @@ bool ShmServerBufferIntegration::initializeHardware(QWaylandCompositor *composit
 {
     Q_ASSERT(QGuiApplication::platformNativeInterface());
 
-    QtWaylandServer::qt_shm_emulation_server_buffer::init(compositor->display(), 1);
+    QtWaylandServer::qt_shm_emulation_server_buffer::init(compositor->display(), 2);
     return true;
 }
 
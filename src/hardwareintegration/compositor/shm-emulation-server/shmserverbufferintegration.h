@@ -31,9 +31,17 @@ public:
     bool bufferInUse() override;
     QOpenGLTexture *toOpenGlTexture() override;
 
+protected:
+    void server_buffer_release(Resource *resource) override;
+
 private:
+    void createSharedMemory(const uchar *data);
+
     ShmServerBufferIntegration *m_integration = nullptr;
 
+    int m_fd = -1;
+    qsizetype m_byteCount = 0;
+    qint64 m_cacheKey = 0;
     QSharedMemory *m_shm = nullptr;
     int m_width;
     int m_height;
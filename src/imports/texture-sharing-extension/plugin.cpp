@@ -48,6 +48,26 @@
     Image { source: "image://wlshared/wallpapers/mybackground.jpg" }
     \endcode
 
+    Images are loaded and decoded in a thread pool, so that requests do not block the
+    compositor. Buffers that are no longer used are kept in a cache of 64 MB, and the least
+    recently used ones are released first. Set the environment variable
+    \c QT_WAYLAND_SHAREDTEXTURE_CACHE_SIZE to use a different cache size in megabytes.
+
+    To have images ready before the first client asks for them, list their identifiers, one
+    per line, in a manifest file and set it as the \c preloadManifest property of the
+    extension, or in the \c QT_WAYLAND_SHAREDTEXTURE_PRELOAD environment variable. The images
+    are then loaded in the background when the extension is initialized. Decoded images can
+    also be stored on disk, so that the next start maps them instead of decoding them again,
+    by setting a directory as the \c diskCachePath property or in the
+    \c QT_WAYLAND_SHAREDTEXTURE_DISK_CACHE environment variable:
+
+    \code
+    TextureSharingExtension {
+        preloadManifest: "/etc/dashboard/shared-textures.txt"
+        diskCachePath: "/var/cache/dashboard/textures"
+    }
+    \endcode
+
 */
 
 QT_BEGIN_NAMESPACE
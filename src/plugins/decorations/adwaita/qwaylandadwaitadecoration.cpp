@@ -120,10 +120,17 @@ QMargins QWaylandAdwaitaDecoration::margins(QWaylandAbstractDecoration::MarginsT
 }
 
 void QWaylandAdwaitaDecoration::paint(QPaintDevice *device)
+{
+    QPainter p(device);
+    paintClipped(&p);
+}
+
+bool QWaylandAdwaitaDecoration::paintClipped(QPainter *painter)
 {
     const QRect surfaceRect = waylandWindow()->windowContentGeometry() + margins(ShadowsOnly);
 
-    QPainter p(device);
+    QPainter &p = *painter;
+    p.save();
     p.setRenderHint(QPainter::Antialiasing);
 
     /*
@@ -181,7 +188,7 @@ void QWaylandAdwaitaDecoration::paint(QPaintDevice *device)
         }
 
         p.save();
-        p.setClipRect(titleBar);
+        p.setClipRect(titleBar, Qt::IntersectClip);
         p.setPen(color(Foreground));
         QSize size = m_windowTitle.size().toSize();
         int dx = (top.width() - size.width()) / 2;
@@ -204,6 +211,9 @@ void QWaylandAdwaitaDecoration::paint(QPaintDevice *device)
 
     if (m_buttons.contains(Minimize))
         drawButton(Minimize, &p);
+
+    p.restore();
+    return true;
 }
 
 bool QWaylandAdwaitaDecoration::handleMouse(QWaylandInputDevice *inputDevice, const QPointF &local,
@@ -593,11 +603,13 @@ void QWaylandAdwaitaDecoration::updateButtonHoverState(Button hoveredButton)
     m_hoveredButtons.setFlag(Maximize, hoveredButton == Button::Maximize);
     m_hoveredButtons.setFlag(Minimize, hoveredButton == Button::Minimize);
 
-    if (m_hoveredButtons.testFlag(Close) != currentCloseButtonState
-        || m_hoveredButtons.testFlag(Maximize) != currentMaximizeButtonState
-        || m_hoveredButtons.testFlag(Minimize) != currentMinimizeButtonState) {
-        requestRepaint();
-    }
+    // Only the buttons whose state changed need to be repainted
+    if (m_hoveredButtons.testFlag(Close) != currentCloseButtonState)
+        requestRepaint(buttonRect(Close).toAlignedRect().adjusted(-1, -1, 1, 1));
+    if (m_hoveredButtons.testFlag(Maximize) != currentMaximizeButtonState)
+        requestRepaint(buttonRect(Maximize).toAlignedRect().adjusted(-1, -1, 1, 1));
+    if (m_hoveredButtons.testFlag(Minimize) != currentMinimizeButtonState)
+        requestRepaint(buttonRect(Minimize).toAlignedRect().adjusted(-1, -1, 1, 1));
 }
 
 void QWaylandAdwaitaDecoration::processMouseTop(QWaylandInputDevice *inputDevice, const QPointF &local,
@@ -724,6 +736,14 @@ void QWaylandAdwaitaDecoration::requestRepaint() const
     waylandWindow()->window()->requestUpdate();
 }
 
+void QWaylandAdwaitaDecoration::requestRepaint(const QRect &rect) const
+{
+    if (waylandWindow()->decoration())
+        waylandWindow()->decoration()->update(rect);
+
+    waylandWindow()->window()->requestUpdate();
+}
+
 } // namespace QtWaylandClient
 
 QT_END_NAMESPACE
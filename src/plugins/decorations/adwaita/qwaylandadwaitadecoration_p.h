@@ -88,6 +88,7 @@ public:
 protected:
     QMargins margins(MarginsType marginsType = Full) const override;
     void paint(QPaintDevice *device) override;
+    bool paintClipped(QPainter *painter) override;
     bool handleMouse(QWaylandInputDevice *inputDevice, const QPointF &local, const QPointF &global,
                      Qt::MouseButtons b, Qt::KeyboardModifiers mods) override;
     bool handleTouch(QWaylandInputDevice *inputDevice, const QPointF &local, const QPointF &global,
@@ -130,6 +131,8 @@ private:
     // Request to repaint the decorations. This will be invoked when button hover changes or
     // when there is a setting change (e.g. layout change).
     void requestRepaint() const;
+    // Same as above, but only repaints the given area
+    void requestRepaint(const QRect &rect) const;
 
     // Button states
     Button m_clicking = None;
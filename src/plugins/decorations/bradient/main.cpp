@@ -39,6 +39,7 @@ public:
 protected:
     QMargins margins(MarginsType marginsType = Full) const override;
     void paint(QPaintDevice *device) override;
+    bool paintClipped(QPainter *painter) override;
     bool handleMouse(QWaylandInputDevice *inputDevice, const QPointF &local, const QPointF &global,Qt::MouseButtons b,Qt::KeyboardModifiers mods) override;
     bool handleTouch(QWaylandInputDevice *inputDevice, const QPointF &local, const QPointF &global, QEventPoint::State state, Qt::KeyboardModifiers mods) override;
 private:
@@ -102,6 +103,13 @@ QMargins QWaylandBradientDecoration::margins(MarginsType marginsType) const
 
 void QWaylandBradientDecoration::paint(QPaintDevice *device)
 {
+    QPainter p(device);
+    paintClipped(&p);
+}
+
+bool QWaylandBradientDecoration::paintClipped(QPainter *painter)
+{
+    QPainter &p = *painter;
     bool active = window()->handle()->isActive();
     QRect wg = QRect(QPoint(), waylandWindow()->surfaceSize()).marginsRemoved(margins(ShadowsOnly));
     QRect cg = wg.marginsRemoved(margins(ShadowsExcluded));
@@ -120,7 +128,7 @@ void QWaylandBradientDecoration::paint(QPaintDevice *device)
     const QColor backgroundColor = palette.color(QPalette::Active, QPalette::Window);
     const QColor foregroundInactiveColor = palette.color(QPalette::Disabled, QPalette::WindowText);
 
-    QPainter p(device);
+    p.save();
     p.setRenderHint(QPainter::Antialiasing);
 
     // Title bar
@@ -128,7 +136,7 @@ void QWaylandBradientDecoration::paint(QPaintDevice *device)
     roundedRect.addRoundedRect(wg, 3, 3);
     for (int i = 0; i < 4; ++i) {
         p.save();
-        p.setClipRect(clips[i]);
+        p.setClipRect(clips[i], Qt::IntersectClip);
         p.fillPath(roundedRect, backgroundColor);
         p.restore();
     }
@@ -156,7 +164,7 @@ void QWaylandBradientDecoration::paint(QPaintDevice *device)
         titleBar.setRight(minimizeButtonRect().left() - BUTTON_SPACING);
 
         p.save();
-        p.setClipRect(titleBar);
+        p.setClipRect(titleBar, Qt::IntersectClip);
         p.setPen(active ? foregroundColor : foregroundInactiveColor);
         QSizeF size = m_windowTitle.size();
         int dx = (top.width() - size.width()) /2;
@@ -213,6 +221,9 @@ void QWaylandBradientDecoration::paint(QPaintDevice *device)
     p.setPen(pen);
     p.drawLine(rect.bottomLeft(), rect.bottomRight());
     p.restore();
+
+    p.restore();
+    return true;
 }
 
 bool QWaylandBradientDecoration::clickButton(Qt::MouseButtons b, Button btn)
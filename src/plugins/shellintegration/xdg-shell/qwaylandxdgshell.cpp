@@ -403,7 +403,7 @@ bool QWaylandXdgSurface::handleExpose(const QRegion &region)
     if (!isExposed() && !region.isEmpty()) {
         return true;
     }
-    setContentGeometry(window()->windowContentGeometry());
+    setContentGeometry(window()->shellWindowGeometry());
     return false;
 }
 
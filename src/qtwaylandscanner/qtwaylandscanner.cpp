@@ -69,7 +69,11 @@ private:
     QByteArray waylandToQtType(const QByteArray &waylandType, const QByteArray &interface, bool cStyleArray);
     const Scanner::WaylandArgument *newIdArgument(const std::vector<WaylandArgument> &arguments);
 
-    void printEvent(const WaylandEvent &e, bool omitNames = false, bool withResource = false);
+    bool hasStringArguments(const WaylandEvent &e);
+    void printEvent(const WaylandEvent &e, bool omitNames = false, bool withResource = false, bool stringViews = false);
+    void printForwardedArguments(const WaylandEvent &e);
+    void printStringViewCopies(const WaylandEvent &e);
+    void printOutgoingString(const WaylandArgument &a, bool stringViews);
     void printEventHandlerSignature(const WaylandEvent &e, const char *interfaceName, bool deepIndent = true);
     void printEnums(const std::vector<WaylandEnum> &enums);
 
@@ -90,6 +94,7 @@ private:
     QByteArray m_prefix;
     QByteArray m_buildMacro;
     QList <QByteArray> m_includes;
+    bool m_stringViews = false;
     QXmlStreamReader *m_xml = nullptr;
 };
 
@@ -116,6 +121,7 @@ bool Scanner::parseArguments(int argc, char **argv)
         // --header-path=<path> (14 characters)
         // --prefix=<prefix> (9 characters)
         // --add-include=<include> (14 characters)
+        // --string-views
         for (int pos = 3; pos < argc; pos++) {
             const QByteArray &option = args[pos];
             if (option.startsWith("--header-path=")) {
@@ -128,6 +134,8 @@ bool Scanner::parseArguments(int argc, char **argv)
                 auto include = option.mid(14);
                 if (!include.isEmpty())
                     m_includes << include;
+            } else if (option == "--string-views") {
+                m_stringViews = true;
             } else {
                 return false;
             }
@@ -139,7 +147,7 @@ bool Scanner::parseArguments(int argc, char **argv)
 
 void Scanner::printUsage()
 {
-    fprintf(stderr, "Usage: %s [client-header|server-header|client-code|server-code] specfile [--header-path=<path>] [--prefix=<prefix>] [--add-include=<include>]\n", m_scannerName.constData());
+    fprintf(stderr, "Usage: %s [client-header|server-header|client-code|server-code] specfile [--header-path=<path>] [--prefix=<prefix>] [--add-include=<include>] [--string-views]\n", m_scannerName.constData());
 }
 
 bool Scanner::isServerSide()
@@ -297,7 +305,19 @@ const Scanner::WaylandArgument *Scanner::newIdArgument(const std::vector<Wayland
     return nullptr;
 }
 
-void Scanner::printEvent(const WaylandEvent &e, bool omitNames, bool withResource)
+bool Scanner::hasStringArguments(const WaylandEvent &e)
+{
+    for (const WaylandArgument &a : e.arguments) {
+        if (a.type == "string")
+            return true;
+    }
+    return false;
+}
+
+// With stringViews, string arguments are QUtf8StringView instead of const QString &.
+// Such overloads are generated with --string-views for all messages with string
+// arguments, so that handlers and senders can avoid converting from and to UTF-16.
+void Scanner::printEvent(const WaylandEvent &e, bool omitNames, bool withResource, bool stringViews)
 {
     printf("%s(", e.name.constData());
     bool needsComma = false;
@@ -334,11 +354,62 @@ void Scanner::printEvent(const WaylandEvent &e, bool omitNames, bool withResourc
         }
 
         QByteArray qtType = waylandToQtType(a.type, a.interface, e.request == isServerSide());
+        if (stringViews && a.type == "string")
+            qtType = "QUtf8StringView";
         printf("%s%s%s", qtType.constData(), qtType.endsWith("&") || qtType.endsWith("*") ? "" : " ", omitNames ? "" : a.name.constData());
     }
     printf(")");
 }
 
+// Prints the arguments of a handler taking string views, converted for the QString overload
+void Scanner::printForwardedArguments(const WaylandEvent &e)
+{
+    bool needsComma = false;
+    if (isServerSide() && e.request) {
+        printf("resource");
+        needsComma = true;
+    }
+    for (const WaylandArgument &a : e.arguments) {
+        bool isNewId = a.type == "new_id";
+        if (isNewId && !isServerSide() && (a.interface.isEmpty() != e.request))
+            continue;
+        if (needsComma)
+            printf(", ");
+        needsComma = true;
+        if (a.type == "string")
+            printf("%s.toString()", a.name.constData());
+        else
+            printf("%s", a.name.constData());
+    }
+}
+
+// The C API needs null-terminated strings, which a view does not guarantee. They are
+// copied to the stack, so that sending does not allocate for reasonably short strings.
+void Scanner::printStringViewCopies(const WaylandEvent &e)
+{
+    for (const WaylandArgument &a : e.arguments) {
+        if (a.type != "string")
+            continue;
+        const char *variableName = a.name.constData();
+        printf("        QVarLengthArray<char, 256> %s_utf8(%s.size() + 1);\n", variableName, variableName);
+        printf("        if (!%s.isEmpty())\n", variableName);
+        printf("            memcpy(%s_utf8.data(), %s.data(), %s.size());\n", variableName, variableName, variableName);
+        printf("        %s_utf8[%s.size()] = '\\0';\n", variableName, variableName);
+        printf("\n");
+    }
+}
+
+void Scanner::printOutgoingString(const WaylandArgument &a, bool stringViews)
+{
+    printf("            ");
+    if (a.allowNull)
+        printf("%s.isNull() ? nullptr : ", a.name.constData());
+    if (stringViews)
+        printf("%s_utf8.constData()", a.name.constData());
+    else
+        printf("%s.toUtf8().constData()", a.name.constData());
+}
+
 void Scanner::printEventHandlerSignature(const WaylandEvent &e, const char *interfaceName, bool deepIndent)
 {
     const char *indent = deepIndent ? "    " : "";
@@ -476,6 +547,8 @@ bool Scanner::process()
         printf("#include <QByteArray>\n");
         printf("#include <QMultiMap>\n");
         printf("#include <QString>\n");
+        if (m_stringViews)
+            printf("#include <QUtf8StringView>\n");
 
         printf("\n");
         printf("#ifndef WAYLAND_VERSION_CHECK\n");
@@ -550,6 +623,29 @@ bool Scanner::process()
             printf("        QMultiMap<struct ::wl_client*, Resource*> resourceMap() { return m_resource_map; }\n");
             printf("        const QMultiMap<struct ::wl_client*, Resource*> resourceMap() const { return m_resource_map; }\n");
             printf("\n");
+            // Resources of a client are adjacent in the map, so they can be iterated without
+            // copying them into a list first, e.g. when sending an event to all of them.
+            // The range must not be used after resources were added or destroyed.
+            printf("        class ResourceRange\n");
+            printf("        {\n");
+            printf("        public:\n");
+            printf("            using const_iterator = QMultiMap<struct ::wl_client*, Resource*>::const_iterator;\n");
+            printf("            ResourceRange(const_iterator begin, const_iterator end) : m_begin(begin), m_end(end) {}\n");
+            printf("            const_iterator begin() const { return m_begin; }\n");
+            printf("            const_iterator end() const { return m_end; }\n");
+            printf("            bool isEmpty() const { return m_begin == m_end; }\n");
+            printf("        private:\n");
+            printf("            const_iterator m_begin;\n");
+            printf("            const_iterator m_end;\n");
+            printf("        };\n");
+            printf("\n");
+            printf("        ResourceRange resources() const { return ResourceRange(m_resource_map.cbegin(), m_resource_map.cend()); }\n");
+            printf("        ResourceRange resources(struct ::wl_client *client) const\n");
+            printf("        {\n");
+            printf("            const auto range = m_resource_map.equal_range(client);\n");
+            printf("            return ResourceRange(range.first, range.second);\n");
+            printf("        }\n");
+            printf("\n");
             printf("        bool isGlobal() const { return m_global != nullptr; }\n");
             printf("        bool isResource() const { return m_resource != nullptr; }\n");
             printf("\n");
@@ -571,6 +667,14 @@ bool Scanner::process()
                     printf("        void send_");
                     printEvent(e, false, true);
                     printf(";\n");
+                    if (m_stringViews && hasStringArguments(e)) {
+                        printf("        void send_");
+                        printEvent(e, false, false, true);
+                        printf(";\n");
+                        printf("        void send_");
+                        printEvent(e, false, true, true);
+                        printf(";\n");
+                    }
                 }
             }
 
@@ -589,6 +693,11 @@ bool Scanner::process()
                     printf("        virtual void %s_", interfaceNameStripped);
                     printEvent(e);
                     printf(";\n");
+                    if (m_stringViews && hasStringArguments(e)) {
+                        printf("        virtual void %s_", interfaceNameStripped);
+                        printEvent(e, false, false, true);
+                        printf(";\n");
+                    }
                 }
             }
 
@@ -638,6 +747,12 @@ bool Scanner::process()
             printf("#include \"qwayland-server-%s.h\"\n", fileBaseName.constData());
         else
             printf("#include <%s/qwayland-server-%s.h>\n", m_headerPath.constData(), fileBaseName.constData());
+        if (m_stringViews) {
+            printf("\n");
+            printf("#include <QVarLengthArray>\n");
+            printf("\n");
+            printf("#include <cstring>\n");
+        }
         printf("\n");
         printf("QT_BEGIN_NAMESPACE\n");
         printf("QT_WARNING_PUSH\n");
@@ -859,6 +974,17 @@ bool Scanner::process()
                     printf("\n");
                     printf("    {\n");
                     printf("    }\n");
+                    if (m_stringViews && hasStringArguments(e)) {
+                        printf("\n");
+                        printf("    void %s::%s_", interfaceName, interfaceNameStripped);
+                        printEvent(e, false, false, true);
+                        printf("\n");
+                        printf("    {\n");
+                        printf("        %s_%s(", interfaceNameStripped, e.name.constData());
+                        printForwardedArguments(e);
+                        printf(");\n");
+                        printf("    }\n");
+                    }
                 }
                 printf("\n");
 
@@ -886,6 +1012,8 @@ bool Scanner::process()
                         const char *argumentName = a.name.constData();
                         if (cType == qtType)
                             printf("            %s", argumentName);
+                        else if (a.type == "string" && m_stringViews)
+                            printf("            QUtf8StringView(%s)", argumentName);
                         else if (a.type == "string")
                             printf("            QString::fromUtf8(%s)", argumentName);
                     }
@@ -895,65 +1023,68 @@ bool Scanner::process()
             }
 
             for (const WaylandEvent &e : interface.events) {
-                printf("\n");
-                printf("    void %s::send_", interfaceName);
-                printEvent(e);
-                printf("\n");
-                printf("    {\n");
-                printf("        Q_ASSERT_X(m_resource, \"%s::%s\", \"Uninitialised resource\");\n", interfaceName, e.name.constData());
-                printf("        if (Q_UNLIKELY(!m_resource)) {\n");
-                printf("            qWarning(\"could not call %s::%s as it's not initialised\");\n", interfaceName, e.name.constData());
-                printf("            return;\n");
-                printf("        }\n");
-                printf("        send_%s(\n", e.name.constData());
-                printf("            m_resource->handle");
-                for (const WaylandArgument &a : e.arguments) {
-                    printf(",\n");
-                    printf("            %s", a.name.constData());
-                }
-                printf(");\n");
-                printf("    }\n");
-                printf("\n");
-
-                printf("    void %s::send_", interfaceName);
-                printEvent(e, false, true);
-                printf("\n");
-                printf("    {\n");
-
-                for (const WaylandArgument &a : e.arguments) {
-                    if (a.type != "array")
+                for (bool stringViews : { false, true }) {
+                    if (stringViews && !(m_stringViews && hasStringArguments(e)))
                         continue;
-                    QByteArray array = a.name + "_data";
-                    const char *arrayName = array.constData();
-                    const char *variableName = a.name.constData();
-                    printf("        struct wl_array %s;\n", arrayName);
-                    printf("        %s.size = %s.size();\n", arrayName, variableName);
-                    printf("        %s.data = static_cast<void *>(const_cast<char *>(%s.constData()));\n", arrayName, variableName);
-                    printf("        %s.alloc = 0;\n", arrayName);
                     printf("\n");
-                }
-
-                printf("        %s_send_%s(\n", interfaceName, e.name.constData());
-                printf("            resource");
-
-                for (const WaylandArgument &a : e.arguments) {
-                    printf(",\n");
-                    QByteArray cType = waylandToCType(a.type, a.interface);
-                    QByteArray qtType = waylandToQtType(a.type, a.interface, e.request);
-                    if (a.type == "string") {
-                        printf("            ");
-                        if (a.allowNull)
-                            printf("%s.isNull() ? nullptr : ", a.name.constData());
-                        printf("%s.toUtf8().constData()", a.name.constData());
-                    } else if (a.type == "array")
-                        printf("            &%s_data", a.name.constData());
-                    else if (cType == qtType)
+                    printf("    void %s::send_", interfaceName);
+                    printEvent(e, false, false, stringViews);
+                    printf("\n");
+                    printf("    {\n");
+                    printf("        Q_ASSERT_X(m_resource, \"%s::%s\", \"Uninitialised resource\");\n", interfaceName, e.name.constData());
+                    printf("        if (Q_UNLIKELY(!m_resource)) {\n");
+                    printf("            qWarning(\"could not call %s::%s as it's not initialised\");\n", interfaceName, e.name.constData());
+                    printf("            return;\n");
+                    printf("        }\n");
+                    printf("        send_%s(\n", e.name.constData());
+                    printf("            m_resource->handle");
+                    for (const WaylandArgument &a : e.arguments) {
+                        printf(",\n");
                         printf("            %s", a.name.constData());
-                }
+                    }
+                    printf(");\n");
+                    printf("    }\n");
+                    printf("\n");
 
-                printf(");\n");
-                printf("    }\n");
-                printf("\n");
+                    printf("    void %s::send_", interfaceName);
+                    printEvent(e, false, true, stringViews);
+                    printf("\n");
+                    printf("    {\n");
+
+                    for (const WaylandArgument &a : e.arguments) {
+                        if (a.type != "array")
+                            continue;
+                        QByteArray array = a.name + "_data";
+                        const char *arrayName = array.constData();
+                        const char *variableName = a.name.constData();
+                        printf("        struct wl_array %s;\n", arrayName);
+                        printf("        %s.size = %s.size();\n", arrayName, variableName);
+                        printf("        %s.data = static_cast<void *>(const_cast<char *>(%s.constData()));\n", arrayName, variableName);
+                        printf("        %s.alloc = 0;\n", arrayName);
+                        printf("\n");
+                    }
+                    if (stringViews)
+                        printStringViewCopies(e);
+
+                    printf("        %s_send_%s(\n", interfaceName, e.name.constData());
+                    printf("            resource");
+
+                    for (const WaylandArgument &a : e.arguments) {
+                        printf(",\n");
+                        QByteArray cType = waylandToCType(a.type, a.interface);
+                        QByteArray qtType = waylandToQtType(a.type, a.interface, e.request);
+                        if (a.type == "string")
+                            printOutgoingString(a, stringViews);
+                        else if (a.type == "array")
+                            printf("            &%s_data", a.name.constData());
+                        else if (cType == qtType)
+                            printf("            %s", a.name.constData());
+                    }
+
+                    printf(");\n");
+                    printf("    }\n");
+                    printf("\n");
+                }
             }
         }
         printf("}\n");
@@ -973,6 +1104,8 @@ bool Scanner::process()
             printf("#include <%s/wayland-%s-client-protocol.h>\n", m_headerPath.constData(), fileBaseName.constData());
         printf("#include <QByteArray>\n");
         printf("#include <QString>\n");
+        if (m_stringViews)
+            printf("#include <QUtf8StringView>\n");
         printf("\n");
         printf("struct wl_registry;\n");
         printf("\n");
@@ -1040,6 +1173,11 @@ bool Scanner::process()
                     printf("        %s", new_id_str.constData());
                     printEvent(e);
                     printf(";\n");
+                    if (m_stringViews && hasStringArguments(e)) {
+                        printf("        %s", new_id_str.constData());
+                        printEvent(e, false, false, true);
+                        printf(";\n");
+                    }
                 }
             }
 
@@ -1052,6 +1190,11 @@ bool Scanner::process()
                     printf("        virtual void %s_", interfaceNameStripped);
                     printEvent(e);
                     printf(";\n");
+                    if (m_stringViews && hasStringArguments(e)) {
+                        printf("        virtual void %s_", interfaceNameStripped);
+                        printEvent(e, false, false, true);
+                        printf(";\n");
+                    }
                 }
             }
 
@@ -1083,6 +1226,12 @@ bool Scanner::process()
             printf("#include \"qwayland-%s.h\"\n",  fileBaseName.constData());
         else
             printf("#include <%s/qwayland-%s.h>\n", m_headerPath.constData(),  fileBaseName.constData());
+        if (m_stringViews) {
+            printf("\n");
+            printf("#include <QVarLengthArray>\n");
+            printf("\n");
+            printf("#include <cstring>\n");
+        }
         printf("\n");
         printf("QT_BEGIN_NAMESPACE\n");
         printf("QT_WARNING_PUSH\n");
@@ -1188,64 +1337,67 @@ bool Scanner::process()
             printf("    }\n");
 
             for (const WaylandEvent &e : interface.requests) {
-                printf("\n");
-                const WaylandArgument *new_id = newIdArgument(e.arguments);
-                QByteArray new_id_str = "void ";
-                if (new_id) {
-                    if (new_id->interface.isEmpty())
-                        new_id_str = "void *";
-                    else
-                        new_id_str = "struct ::" + new_id->interface + " *";
-                }
-                printf("    %s%s::", new_id_str.constData(), interfaceName);
-                printEvent(e);
-                printf("\n");
-                printf("    {\n");
-                for (const WaylandArgument &a : e.arguments) {
-                    if (a.type != "array")
+                for (bool stringViews : { false, true }) {
+                    if (stringViews && !(m_stringViews && hasStringArguments(e)))
                         continue;
-                    QByteArray array = a.name + "_data";
-                    const char *arrayName = array.constData();
-                    const char *variableName = a.name.constData();
-                    printf("        struct wl_array %s;\n", arrayName);
-                    printf("        %s.size = %s.size();\n", arrayName, variableName);
-                    printf("        %s.data = static_cast<void *>(const_cast<char *>(%s.constData()));\n", arrayName, variableName);
-                    printf("        %s.alloc = 0;\n", arrayName);
                     printf("\n");
-                }
-                int actualArgumentCount = new_id ? int(e.arguments.size()) - 1 : int(e.arguments.size());
-                printf("        %s::%s_%s(\n", new_id ? "return " : "", interfaceName, e.name.constData());
-                printf("            m_%s%s", interfaceName, actualArgumentCount > 0 ? "," : "");
-                bool needsComma = false;
-                for (const WaylandArgument &a : e.arguments) {
-                    bool isNewId = a.type == "new_id";
-                    if (isNewId && !a.interface.isEmpty())
-                        continue;
-                    if (needsComma)
-                        printf(",");
-                    needsComma = true;
+                    const WaylandArgument *new_id = newIdArgument(e.arguments);
+                    QByteArray new_id_str = "void ";
+                    if (new_id) {
+                        if (new_id->interface.isEmpty())
+                            new_id_str = "void *";
+                        else
+                            new_id_str = "struct ::" + new_id->interface + " *";
+                    }
+                    printf("    %s%s::", new_id_str.constData(), interfaceName);
+                    printEvent(e, false, false, stringViews);
                     printf("\n");
-                    if (isNewId) {
-                        printf("            interface,\n");
-                        printf("            version");
-                    } else {
-                        QByteArray cType = waylandToCType(a.type, a.interface);
-                        QByteArray qtType = waylandToQtType(a.type, a.interface, e.request);
-                        if (a.type == "string") {
-                            printf("            ");
-                            if (a.allowNull)
-                                printf("%s.isNull() ? nullptr : ", a.name.constData());
-                            printf("%s.toUtf8().constData()", a.name.constData());
-                        } else if (a.type == "array")
-                            printf("            &%s_data", a.name.constData());
-                        else if (cType == qtType)
-                            printf("            %s", a.name.constData());
+                    printf("    {\n");
+                    for (const WaylandArgument &a : e.arguments) {
+                        if (a.type != "array")
+                            continue;
+                        QByteArray array = a.name + "_data";
+                        const char *arrayName = array.constData();
+                        const char *variableName = a.name.constData();
+                        printf("        struct wl_array %s;\n", arrayName);
+                        printf("        %s.size = %s.size();\n", arrayName, variableName);
+                        printf("        %s.data = static_cast<void *>(const_cast<char *>(%s.constData()));\n", arrayName, variableName);
+                        printf("        %s.alloc = 0;\n", arrayName);
+                        printf("\n");
                     }
+                    if (stringViews)
+                        printStringViewCopies(e);
+                    int actualArgumentCount = new_id ? int(e.arguments.size()) - 1 : int(e.arguments.size());
+                    printf("        %s::%s_%s(\n", new_id ? "return " : "", interfaceName, e.name.constData());
+                    printf("            m_%s%s", interfaceName, actualArgumentCount > 0 ? "," : "");
+                    bool needsComma = false;
+                    for (const WaylandArgument &a : e.arguments) {
+                        bool isNewId = a.type == "new_id";
+                        if (isNewId && !a.interface.isEmpty())
+                            continue;
+                        if (needsComma)
+                            printf(",");
+                        needsComma = true;
+                        printf("\n");
+                        if (isNewId) {
+                            printf("            interface,\n");
+                            printf("            version");
+                        } else {
+                            QByteArray cType = waylandToCType(a.type, a.interface);
+                            QByteArray qtType = waylandToQtType(a.type, a.interface, e.request);
+                            if (a.type == "string")
+                                printOutgoingString(a, stringViews);
+                            else if (a.type == "array")
+                                printf("            &%s_data", a.name.constData());
+                            else if (cType == qtType)
+                                printf("            %s", a.name.constData());
+                        }
+                    }
+                    printf(");\n");
+                    if (e.type == "destructor")
+                        printf("        m_%s = nullptr;\n", interfaceName);
+                    printf("    }\n");
                 }
-                printf(");\n");
-                if (e.type == "destructor")
-                    printf("        m_%s = nullptr;\n", interfaceName);
-                printf("    }\n");
             }
 
             if (hasEvents) {
@@ -1257,6 +1409,17 @@ bool Scanner::process()
                     printf("    {\n");
                     printf("    }\n");
                     printf("\n");
+                    if (m_stringViews && hasStringArguments(e)) {
+                        printf("    void %s::%s_", interfaceName, interfaceNameStripped);
+                        printEvent(e, false, false, true);
+                        printf("\n");
+                        printf("    {\n");
+                        printf("        %s_%s(", interfaceNameStripped, e.name.constData());
+                        printForwardedArguments(e);
+                        printf(");\n");
+                        printf("    }\n");
+                        printf("\n");
+                    }
                     printf("    void %s::", interfaceName);
                     printEventHandlerSignature(e, interfaceName, false);
                     printf("\n");
@@ -1270,7 +1433,9 @@ bool Scanner::process()
                         needsComma = true;
                         printf("\n");
                         const char *argumentName = a.name.constData();
-                        if (a.type == "string")
+                        if (a.type == "string" && m_stringViews)
+                            printf("            QUtf8StringView(%s)", argumentName);
+                        else if (a.type == "string")
                             printf("            QString::fromUtf8(%s)", argumentName);
                         else
                             printf("            %s", argumentName);
@@ -285,6 +285,20 @@ int QWaylandInputMethodEventBuilder::indexFromWayland(const QString &text, int l
     }
 }
 
+// Same as above for text still in UTF-8, without converting it
+int QWaylandInputMethodEventBuilder::indexFromWayland(QUtf8StringView text, int length)
+{
+    const qsizetype end = qBound<qsizetype>(0, length, text.size());
+    int index = 0;
+    for (qsizetype i = 0; i < end; ++i) {
+        const uchar ch = uchar(text.data()[i]);
+        // Continuation bytes do not start a character, four byte sequences need a surrogate pair
+        if ((ch & 0xc0) != 0x80)
+            index += ch >= 0xf0 ? 2 : 1;
+    }
+    return index;
+}
+
 int QWaylandInputMethodEventBuilder::trimmedIndexFromWayland(const QString &text, int length, int base)
 {
     if (length == 0)
@@ -325,7 +339,23 @@ int QWaylandInputMethodEventBuilder::trimmedIndexFromWayland(const QString &text
 
 int QWaylandInputMethodEventBuilder::indexToWayland(const QString &text, int length, int base)
 {
-    return QStringView{text}.mid(base, length).toUtf8().size();
+    // Counts the UTF-8 length instead of converting, invalid surrogates become U+FFFD
+    const QStringView view = QStringView{text}.mid(base, length);
+    int utf8Length = 0;
+    for (qsizetype i = 0; i < view.size(); ++i) {
+        const char16_t ch = view[i].unicode();
+        if (ch < 0x80) {
+            utf8Length += 1;
+        } else if (ch < 0x800) {
+            utf8Length += 2;
+        } else if (QChar::isHighSurrogate(ch) && i + 1 < view.size() && view[i + 1].isLowSurrogate()) {
+            utf8Length += 4;
+            ++i;
+        } else {
+            utf8Length += 3;
+        }
+    }
+    return utf8Length;
 }
 
 QT_END_NAMESPACE
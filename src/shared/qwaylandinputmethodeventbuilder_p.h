@@ -5,6 +5,7 @@
 #define QWAYLANDINPUTMETHODEVENTBUILDER_H
 
 #include <QInputMethodEvent>
+#include <QUtf8StringView>
 #include <private/qglobal_p.h>
 
 QT_BEGIN_NAMESPACE
@@ -27,6 +28,7 @@ public:
     QInputMethodEvent *buildPreedit(const QString &text);
 
     static int indexFromWayland(const QString &text, int length, int base = 0);
+    static int indexFromWayland(QUtf8StringView text, int length);
     static int indexToWayland(const QString &text, int length, int base = 0);
 
     static int trimmedIndexFromWayland(const QString &text, int length, int base = 0);
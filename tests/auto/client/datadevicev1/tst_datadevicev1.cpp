@@ -3,9 +3,18 @@
 
 #include "mockcompositor.h"
 
+#include <QtWaylandClient/private/qwaylandmimedatasender_p.h>
+
 #include <QtGui/QRasterWindow>
 #include <QtGui/QClipboard>
 #include <QtGui/QDrag>
+#include <qpa/qplatformnativeinterface.h>
+
+#include <QtCore/QMimeData>
+#include <QtCore/QTimer>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace MockCompositor;
 
@@ -33,6 +42,9 @@ private slots:
     void pasteUtf8();
     void pasteMozUrl();
     void pasteSingleUtf8MozUrl();
+    void pasteFromSlowSource();
+    void pasteAsync();
+    void sendToSlowReaders();
     void destroysPreviousSelection();
     void destroysSelectionWithSurface();
     void destroysSelectionOnLeave();
@@ -209,6 +221,146 @@ void tst_datadevicev1::pasteSingleUtf8MozUrl()
     QCOMPARE(window.m_urls.at(0), QUrl("https://www.qt.io/"));
 }
 
+void tst_datadevicev1::pasteFromSlowSource()
+{
+    // The source sends the rest of the data a little later, which the
+    // blocking read has to wait for
+    class Window : public QRasterWindow {
+    public:
+        void mousePressEvent(QMouseEvent *) override { m_text = QGuiApplication::clipboard()->text(); }
+        QString m_text;
+    };
+
+    Window window;
+    window.resize(64, 64);
+    window.show();
+
+    QCOMPOSITOR_TRY_VERIFY(xdgSurface() && xdgSurface()->m_committedConfigureSerial);
+    exec([&] {
+        auto *client = xdgSurface()->resource()->client();
+        auto *offer = dataDevice()->sendDataOffer(client, {"text/plain"});
+        connect(offer, &DataOffer::receive, offer, [offer](QString mimeType, int fd) {
+            QCOMPARE(mimeType, "text/plain");
+            const QByteArray data("slow");
+            QCOMPARE(::write(fd, data.constData(), data.size()), ssize_t(data.size()));
+            // The compositor runs its own event loop while the client waits
+            QTimer::singleShot(50, offer, [fd] {
+                const QByteArray rest(" source");
+                QCOMPARE(::write(fd, rest.constData(), rest.size()), ssize_t(rest.size()));
+                ::close(fd);
+            });
+        }, Qt::DirectConnection);
+        dataDevice()->sendSelection(offer);
+
+        auto *surface = xdgSurface()->m_surface;
+        keyboard()->sendEnter(surface); // Need to set keyboard focus according to protocol
+
+        pointer()->sendEnter(surface, {32, 32});
+        pointer()->sendFrame(client);
+        pointer()->sendButton(client, BTN_LEFT, 1);
+        pointer()->sendFrame(client);
+        pointer()->sendButton(client, BTN_LEFT, 0);
+        pointer()->sendFrame(client);
+    });
+    QTRY_COMPARE(window.m_text, "slow source");
+}
+
+void tst_datadevicev1::pasteAsync()
+{
+    using RetrieveFunction = QFuture<QByteArray> (*)(const QString &, QClipboard::Mode);
+    auto retrieve = reinterpret_cast<RetrieveFunction>(QGuiApplication::platformNativeInterface()
+            ->nativeResourceFunctionForIntegration("retrieveClipboardDataAsync"));
+    QVERIFY(retrieve);
+
+    QRasterWindow window;
+    window.resize(64, 64);
+    window.show();
+
+    QCOMPOSITOR_TRY_VERIFY(xdgSurface() && xdgSurface()->m_committedConfigureSerial);
+    int sourceFd = -1; // Only used on the compositor thread
+    exec([&] {
+        auto *client = xdgSurface()->resource()->client();
+        auto *offer = dataDevice()->sendDataOffer(client, {"text/plain"});
+        connect(offer, &DataOffer::receive, offer, [&sourceFd](QString mimeType, int fd) {
+            QCOMPARE(mimeType, "text/plain");
+            const QByteArray data("async");
+            QCOMPARE(::write(fd, data.constData(), data.size()), ssize_t(data.size()));
+            sourceFd = fd;
+        }, Qt::DirectConnection);
+        dataDevice()->sendSelection(offer);
+        keyboard()->sendEnter(xdgSurface()->m_surface);
+    });
+    QTRY_VERIFY(QGuiApplication::clipboard()->mimeData()->hasText());
+
+    // The rest is only sent once the test continues, which a blocking read would never let happen
+    QFuture<QByteArray> future = retrieve(QStringLiteral("text/plain"), QClipboard::Clipboard);
+    QCOMPOSITOR_TRY_VERIFY(sourceFd != -1);
+    QVERIFY(!future.isFinished());
+    exec([&] {
+        const QByteArray rest(" paste");
+        QCOMPARE(::write(sourceFd, rest.constData(), rest.size()), ssize_t(rest.size()));
+        ::close(sourceFd);
+    });
+    QTRY_VERIFY(future.isFinished());
+    QCOMPARE(future.result(), QByteArray("async paste"));
+
+    // The synchronous path uses what was received
+    QCOMPARE(QGuiApplication::clipboard()->text(), QStringLiteral("async paste"));
+}
+
+void tst_datadevicev1::sendToSlowReaders()
+{
+    // The payload does not fit into a pipe, and the paste targets only read a little of
+    // it at a time from the event loop, which the sender must not block in the meantime
+    const QString mimeType = QStringLiteral("application/octet-stream");
+    QByteArray payload(1024 * 1024, Qt::Uninitialized);
+    for (qsizetype i = 0; i < payload.size(); ++i)
+        payload[i] = char(i % 251);
+
+    QMimeData mimeData;
+    mimeData.setData(mimeType, payload);
+    QtWaylandClient::QWaylandMimeDataSender sender(&mimeData);
+
+    struct Reader {
+        int fd = -1;
+        QByteArray data;
+    } readers[3];
+
+    for (int i = 0; i < 3; ++i) {
+        // The payload is serialized once, and served from the cache afterwards
+        if (i == 2)
+            mimeData.setData(mimeType, QByteArray("changed"));
+
+        int fds[2];
+        QCOMPARE(::pipe(fds), 0);
+        ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+        readers[i].fd = fds[0];
+        sender.send(mimeType, fds[1]);
+    }
+
+    QTimer timer;
+    connect(&timer, &QTimer::timeout, this, [&readers] {
+        for (Reader &reader : readers) {
+            if (reader.fd == -1)
+                continue;
+            char buffer[4096];
+            const ssize_t n = ::read(reader.fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                reader.data.append(buffer, n);
+            } else if (n == 0) {
+                ::close(reader.fd);
+                reader.fd = -1;
+            }
+        }
+    });
+    timer.start(1);
+
+    for (Reader &reader : readers)
+        QTRY_COMPARE_WITH_TIMEOUT(reader.fd, -1, 10000);
+    for (Reader &reader : readers)
+        QCOMPARE(reader.data, payload);
+}
+
 void tst_datadevicev1::destroysPreviousSelection()
 {
     QRasterWindow window;
@@ -0,0 +1,60 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "mockcompositor.h"
+#include <QtGui/QRasterWindow>
+
+using namespace MockCompositor;
+
+class tst_decorationsurface : public QObject, private DefaultCompositor
+{
+    Q_OBJECT
+public:
+    tst_decorationsurface();
+private slots:
+    void cleanup() { QTRY_VERIFY2(isClean(), qPrintable(dirtyMessage())); }
+    void createsEdgeSurfaces();
+};
+
+tst_decorationsurface::tst_decorationsurface()
+{
+    qputenv("QT_WAYLAND_DECORATION_SUBSURFACE", "1");
+}
+
+void tst_decorationsurface::createsEdgeSurfaces()
+{
+    QRasterWindow window;
+    window.resize(64, 64);
+    window.show();
+    QCOMPOSITOR_TRY_VERIFY(xdgToplevel());
+    exec([&] { xdgToplevel()->sendCompleteConfigure(); });
+    QCOMPOSITOR_TRY_VERIFY(xdgToplevel()->surface()->m_committed.buffer);
+
+    const QMargins margins = window.frameMargins();
+    if (margins.isNull())
+        QSKIP("No decoration plugin available");
+
+    // The window's own buffer only holds the contents
+    QCOMPOSITOR_COMPARE(xdgToplevel()->surface()->m_committed.buffer->size(), QSize(64, 64));
+
+    // Every edge has its own subsurface below the window's surface, with a buffer of its size
+    QCOMPOSITOR_TRY_COMPARE(get<SubCompositor>()->m_subsurfaces.size(), 4);
+    const QRegion frame = QRegion(QRect(-margins.left(), -margins.top(),
+                                        64 + margins.left() + margins.right(),
+                                        64 + margins.top() + margins.bottom()))
+            - QRect(0, 0, 64, 64);
+    auto decorationArea = [&] {
+        QRegion area;
+        for (Subsurface *subsurface : get<SubCompositor>()->m_subsurfaces) {
+            if (!subsurface->m_surface || subsurface->m_parent != xdgToplevel()->surface())
+                return QRegion();
+            if (Buffer *buffer = subsurface->m_surface->m_committed.buffer)
+                area += QRect(subsurface->m_position, buffer->size());
+        }
+        return area;
+    };
+    QCOMPOSITOR_TRY_COMPARE(decorationArea(), frame);
+}
+
+QCOMPOSITOR_TEST_MAIN(tst_decorationsurface)
+#include "tst_decorationsurface.moc"
@@ -4,6 +4,7 @@
 #include "mockcompositor.h"
 #include <QtGui/QRasterWindow>
 #include <QtGui/QEventPoint>
+#include <qpa/qplatformnativeinterface.h>
 
 using namespace MockCompositor;
 
@@ -13,13 +14,17 @@ public:
     {
         exec([this] {
             m_config.autoConfigure = true;
+            recreateSeat();
+        });
+    }
 
-            removeAll<Seat>();
+    void recreateSeat()
+    {
+        removeAll<Seat>();
 
-            uint capabilities = MockCompositor::Seat::capability_pointer | MockCompositor::Seat::capability_touch;
-            int version = 9;
-            add<Seat>(capabilities, version);
-        });
+        uint capabilities = MockCompositor::Seat::capability_pointer | MockCompositor::Seat::capability_touch;
+        int version = 9;
+        add<Seat>(capabilities, version);
     }
 };
 
@@ -40,6 +45,7 @@ private slots:
     void fingerScrollSlow();
     void continuousScroll();
     void highResolutionScroll();
+    void coalescedMotion();
 
     // Touch tests
     void createsTouch();
@@ -375,6 +381,59 @@ void tst_seat::highResolutionScroll()
     }
 }
 
+class MotionWindow : public QRasterWindow {
+public:
+    MotionWindow()
+    {
+        resize(64, 64);
+        show();
+    }
+    void mouseMoveEvent(QMouseEvent *event) override
+    {
+        QRasterWindow::mouseMoveEvent(event);
+        m_positions.append(event->position());
+    }
+    QList<QPointF> m_positions;
+};
+
+void tst_seat::coalescedMotion()
+{
+    // The setting is read when the client binds the pointer
+    qputenv("QT_WAYLAND_COALESCE_POINTER_MOTION", "1");
+    auto restoreSeat = qScopeGuard([&] {
+        qunsetenv("QT_WAYLAND_COALESCE_POINTER_MOTION");
+        exec([&] { recreateSeat(); });
+        QCOMPOSITOR_TRY_COMPARE(pointer()->resourceMap().size(), 1);
+    });
+    exec([&] { recreateSeat(); });
+    QCOMPOSITOR_TRY_COMPARE(pointer()->resourceMap().size(), 1);
+
+    MotionWindow window;
+    QCOMPOSITOR_TRY_VERIFY(xdgSurface() && xdgSurface()->m_committedConfigureSerial);
+
+    exec([&] {
+        auto *p = pointer();
+        auto *c = client();
+        p->sendEnter(xdgToplevel()->surface(), {10, 10});
+        p->sendFrame(c);
+        for (int i = 1; i <= 5; ++i) {
+            p->sendMotion(c, {10.0 + i, 10});
+            p->sendFrame(c);
+        }
+    });
+
+    // The frames arrive together, so fewer mouse move events than frames are delivered
+    QTRY_COMPARE(window.m_positions.size() > 0 ? window.m_positions.last() : QPointF(), QPointF(15, 10));
+    QVERIFY(window.m_positions.size() < 5);
+
+    // All of the positions are still available
+    auto *nativeInterface = QGuiApplication::platformNativeInterface();
+    const QVariantList history = nativeInterface->windowProperty(window.handle(), "pointerMotionHistory").toList();
+    QCOMPARE(history.size(), 5);
+    for (int i = 0; i < 5; ++i)
+        QCOMPARE(history.at(i).toMap().value("position").toPointF(), QPointF(11.0 + i, 10));
+}
+
 void tst_seat::continuousScroll()
 {
     WheelWindow window;
@@ -0,0 +1,231 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "mockcompositor.h"
+
+#include <QtGui/private/qguiapplication_p.h>
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QtOpenGL/QOpenGLTexture>
+#include <QtWaylandClient/private/qwaylandintegration_p.h>
+#include <QtWaylandClient/private/qwaylandserverbufferintegration_p.h>
+#include <QtWaylandClient/qwaylandclientextension.h>
+
+#include <qwayland-qt-texture-sharing-unstable-v1.h>
+#include <qwayland-server-qt-texture-sharing-unstable-v1.h>
+#include <qwayland-server-server-buffer-extension.h>
+#include <qwayland-server-shm-emulation-server-buffer.h>
+
+#include <memory>
+
+using namespace MockCompositor;
+
+// Only the server buffer resources, the pixels are sent as a file descriptor
+class ServerBuffer : public QtWaylandServer::qt_server_buffer
+{
+public:
+    int releaseCount = 0;
+
+protected:
+    void server_buffer_release(Resource *resource) override
+    {
+        ++releaseCount;
+        wl_resource_destroy(resource->handle);
+    }
+};
+
+class ShmEmulationServerBuffer : public Global, public QtWaylandServer::qt_shm_emulation_server_buffer
+{
+    Q_OBJECT
+public:
+    explicit ShmEmulationServerBuffer(CoreCompositor *compositor)
+        : QtWaylandServer::qt_shm_emulation_server_buffer(compositor->m_display, 2)
+    {
+    }
+};
+
+// Shares the image with any key it is asked for
+class TextureSharing : public Global, public QtWaylandServer::zqt_texture_sharing_v1
+{
+    Q_OBJECT
+public:
+    explicit TextureSharing(CoreCompositor *compositor)
+        : QtWaylandServer::zqt_texture_sharing_v1(compositor->m_display, 1)
+        , m_compositor(compositor)
+    {
+    }
+
+    QImage image;
+    ServerBuffer buffer;
+
+protected:
+    void zqt_texture_sharing_v1_request_image(Resource *resource, const QString &key) override
+    {
+        auto *shm = m_compositor->get<ShmEmulationServerBuffer>();
+        auto *shmResource = shm->resourceMap().value(resource->client());
+        QTemporaryFile file;
+        if (!shmResource || !file.open()
+                || file.write(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes()) != image.sizeInBytes()
+                || !file.flush()) {
+            send_image_failed(resource->handle, key, QStringLiteral("Could not share the image"));
+            return;
+        }
+
+        auto *bufferResource = buffer.add(resource->client(), 1);
+        shm->send_server_buffer_created_fd(shmResource->handle, bufferResource->handle, file.handle(),
+                                           image.width(), image.height(), image.bytesPerLine(),
+                                           QtWaylandServer::qt_shm_emulation_server_buffer::format_RGBA32);
+        send_provide_buffer(resource->handle, bufferResource->handle, key);
+    }
+
+private:
+    CoreCompositor *m_compositor = nullptr;
+};
+
+class TextureSharingExtension
+    : public QWaylandClientExtensionTemplate<TextureSharingExtension>
+    , public QtWayland::zqt_texture_sharing_v1
+{
+public:
+    TextureSharingExtension() : QWaylandClientExtensionTemplate(1) {}
+    QHash<QString, struct ::qt_server_buffer *> buffers;
+
+protected:
+    void zqt_texture_sharing_v1_provide_buffer(struct ::qt_server_buffer *buffer, const QString &key) override
+    {
+        buffers.insert(key, buffer);
+    }
+};
+
+class tst_serverbuffer : public QObject, private CoreCompositor
+{
+    Q_OBJECT
+private:
+    QtWaylandClient::QWaylandServerBufferIntegration *serverBufferIntegration()
+    {
+        return static_cast<QtWaylandClient::QWaylandIntegration *>(
+                       QGuiApplicationPrivate::platformIntegration())
+                ->serverBufferIntegration();
+    }
+    QtWaylandClient::QWaylandServerBuffer *requestServerBuffer(const QString &key, const QImage &image);
+    std::unique_ptr<TextureSharingExtension> m_textureSharing;
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase() { m_textureSharing.reset(); }
+    void mapMemfd();
+    void texturePerShareGroup();
+};
+
+void tst_serverbuffer::initTestCase()
+{
+    exec([this] {
+        add<ShmEmulationServerBuffer>();
+        add<TextureSharing>();
+    });
+    if (!serverBufferIntegration())
+        QSKIP("The shm-emulation-server server buffer integration is not available");
+    QCOMPOSITOR_TRY_COMPARE(get<ShmEmulationServerBuffer>()->resourceMap().size(), 1);
+    m_textureSharing.reset(new TextureSharingExtension);
+    QTRY_VERIFY(m_textureSharing->isActive());
+}
+
+// Asks the compositor to share image, and returns the client side of the server buffer
+QtWaylandClient::QWaylandServerBuffer *tst_serverbuffer::requestServerBuffer(const QString &key, const QImage &image)
+{
+    exec([&] { get<TextureSharing>()->image = image; });
+    m_textureSharing->request_image(key);
+    if (!QTest::qWaitFor([&] { return m_textureSharing->buffers.contains(key); }))
+        return nullptr;
+    return serverBufferIntegration()->serverBuffer(m_textureSharing->buffers.value(key));
+}
+
+void tst_serverbuffer::mapMemfd()
+{
+    QTest::failOnWarning(QRegularExpression("could not map server buffer"));
+
+    QImage image(5, 3, QImage::Format_RGBA8888);
+    image.fill(Qt::red);
+    QtWaylandClient::QWaylandServerBuffer *buffer = requestServerBuffer("mapMemfd", image);
+    QVERIFY(buffer);
+    QCOMPARE(buffer->size(), image.size());
+    QCOMPARE(buffer->format(), QtWaylandClient::QWaylandServerBuffer::RGBA32);
+
+    // Deleting the buffer releases it
+    const int releaseCount = exec([&] { return get<TextureSharing>()->buffer.releaseCount; });
+    delete buffer;
+    QCOMPOSITOR_TRY_COMPARE(get<TextureSharing>()->buffer.releaseCount, releaseCount + 1);
+    QCOMPOSITOR_TRY_VERIFY(get<TextureSharing>()->buffer.resourceMap().isEmpty());
+}
+
+void tst_serverbuffer::texturePerShareGroup()
+{
+    QOffscreenSurface surface;
+    surface.create();
+    QOpenGLContext context;
+    QOpenGLContext sharingContext;
+    sharingContext.setShareContext(&context);
+    QOpenGLContext otherContext;
+    if (!context.create() || !sharingContext.create() || !otherContext.create()
+            || !context.makeCurrent(&surface))
+        QSKIP("OpenGL is not available");
+
+    QImage image(3, 2, QImage::Format_RGBA8888);
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            image.setPixel(x, y, qRgba(x * 100, y * 200, 50, 255));
+    }
+    QtWaylandClient::QWaylandServerBuffer *buffer = requestServerBuffer("texturePerShareGroup", image);
+    QVERIFY(buffer);
+
+    QOpenGLTexture *texture = buffer->toOpenGlTexture();
+    QVERIFY(texture);
+    QCOMPARE(buffer->toOpenGlTexture(), texture);
+    QCOMPARE(QSize(texture->width(), texture->height()), image.size());
+
+    // The texture holds the pixels of the mapped memfd
+    QOpenGLFunctions *functions = context.functions();
+    GLuint fbo = 0;
+    functions->glGenFramebuffers(1, &fbo);
+    functions->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    functions->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->textureId(), 0);
+    QCOMPARE(functions->glCheckFramebufferStatus(GL_FRAMEBUFFER), GLenum(GL_FRAMEBUFFER_COMPLETE));
+    QImage pixels(image.size(), QImage::Format_RGBA8888);
+    functions->glReadPixels(0, 0, image.width(), image.height(), GL_RGBA, GL_UNSIGNED_BYTE, pixels.bits());
+    functions->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    functions->glDeleteFramebuffers(1, &fbo);
+    QCOMPARE(pixels, image);
+
+    // Contexts sharing with each other share the texture, the others get their own
+    QVERIFY(sharingContext.makeCurrent(&surface));
+    QCOMPARE(buffer->toOpenGlTexture(), texture);
+    QVERIFY(otherContext.makeCurrent(&surface));
+    QOpenGLTexture *otherTexture = buffer->toOpenGlTexture();
+    QVERIFY(otherTexture);
+    QVERIFY(otherTexture != texture);
+
+    // The texture of the current share group is deleted along with the buffer
+    QVERIFY(context.makeCurrent(&surface));
+    const GLuint textureId = texture->textureId();
+    QVERIFY(functions->glIsTexture(textureId));
+    delete buffer;
+    QVERIFY(!functions->glIsTexture(textureId));
+    context.doneCurrent();
+}
+
+int main(int argc, char **argv)
+{
+    QTemporaryDir tmpRuntimeDir;
+    setenv("XDG_RUNTIME_DIR", tmpRuntimeDir.path().toLocal8Bit(), 1);
+    setenv("QT_QPA_PLATFORM", "wayland", 1);
+    setenv("QT_WAYLAND_DONT_CHECK_SHELL_INTEGRATION", "1", 1);
+    setenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server", 1);
+
+    tst_serverbuffer tc;
+    QGuiApplication app(argc, argv);
+    QTEST_SET_MAIN_SOURCE_PATH
+    return QTest::qExec(&tc, argc, argv);
+}
+
+#include "tst_serverbuffer.moc"
@@ -4,6 +4,9 @@
 #include "coreprotocol.h"
 #include "datadevice.h"
 
+#include <sys/mman.h>
+#include <unistd.h>
+
 namespace MockCompositor {
 
 Surface::Surface(WlCompositor *wlCompositor, wl_client *client, int id, int version)
@@ -94,12 +97,30 @@ void Surface::surface_attach(Resource *resource, wl_resource *buffer, int32_t x,
     }
 }
 
+void Surface::surface_damage(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    Q_UNUSED(resource);
+    m_pending.commitSpecific.damage += QRect(x, y, width, height);
+}
+
+void Surface::surface_damage_buffer(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height)
+{
+    Q_UNUSED(resource);
+    m_pending.commitSpecific.bufferDamage += QRect(x, y, width, height);
+}
+
 void Surface::surface_set_buffer_scale(QtWaylandServer::wl_surface::Resource *resource, int32_t scale)
 {
     Q_UNUSED(resource);
     m_pending.bufferScale = scale;
 }
 
+void Surface::surface_set_opaque_region(Resource *resource, wl_resource *region)
+{
+    Q_UNUSED(resource);
+    m_pending.opaqueRegion = region ? Region::fromResource(region)->m_region : QRegion();
+}
+
 void Surface::surface_commit(Resource *resource)
 {
     Q_UNUSED(resource);
@@ -593,22 +614,57 @@ bool Shm::isClean()
 
 void Shm::shm_create_pool(Resource *resource, uint32_t id, int32_t fd, int32_t size)
 {
-    Q_UNUSED(fd);
-    Q_UNUSED(size);
-    auto *pool = new ShmPool(this, resource->client(), id, 1);
+    auto *pool = new ShmPool(this, resource->client(), id, fd, size, 1);
     m_pools.append(pool);
 }
 
-ShmPool::ShmPool(Shm *shm, wl_client *client, int id, int version)
+ShmPool::ShmPool(Shm *shm, wl_client *client, int id, int fd, int size, int version)
     : QtWaylandServer::wl_shm_pool(client, id, version)
     , m_shm(shm)
+    , m_fd(fd)
+    , m_serial(++shm->m_createdPools)
+    , m_size(size)
 {
 }
 
+ShmPool::~ShmPool()
+{
+    close(m_fd);
+}
+
+QImage ShmPool::image(int offset, const QSize &size, int stride, Shm::format format) const
+{
+    QImage::Format imageFormat;
+    switch (format) {
+    case Shm::format_argb8888:
+        imageFormat = QImage::Format_ARGB32_Premultiplied;
+        break;
+    case Shm::format_xrgb8888:
+        imageFormat = QImage::Format_RGB32;
+        break;
+    default:
+        return QImage();
+    }
+
+    void *data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED)
+        return QImage();
+    const uchar *bits = static_cast<const uchar *>(data) + offset;
+    QImage image = QImage(bits, size.width(), size.height(), stride, imageFormat).copy();
+    munmap(data, m_size);
+    return image;
+}
+
 void ShmPool::shm_pool_create_buffer(Resource *resource, uint32_t id, int32_t offset, int32_t width, int32_t height, int32_t stride, uint32_t format)
 {
     QSize size(width, height);
-    new ShmBuffer(offset, size, stride, Shm::format(format), resource->client(), id);
+    new ShmBuffer(this, offset, size, stride, Shm::format(format), resource->client(), id);
+}
+
+void ShmPool::shm_pool_resize(Resource *resource, int32_t size)
+{
+    Q_UNUSED(resource);
+    m_size = size;
 }
 
 void ShmPool::shm_pool_destroy_resource(Resource *resource)
@@ -93,12 +93,15 @@ public:
         Callback *frame = nullptr;
         QPoint attachOffset;
         bool attached = false;
+        QRegion damage; // In surface coordinates
+        QRegion bufferDamage;
     };
     struct DoubleBufferedState {
         PerCommitData commitSpecific;
         Buffer *buffer = nullptr;
         uint configureSerial = 0;
         int bufferScale = 1;
+        QRegion opaqueRegion;
     } m_pending, m_committed;
     QList<DoubleBufferedState *> m_commits;
     QList<Callback *> m_waitingFrameCallbacks;
@@ -122,7 +125,10 @@ protected:
     void surface_destroy_resource(Resource *resource) override;
     void surface_destroy(Resource *resource) override;
     void surface_attach(Resource *resource, wl_resource *buffer, int32_t x, int32_t y) override;
+    void surface_damage(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height) override;
+    void surface_damage_buffer(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height) override;
     void surface_set_buffer_scale(Resource *resource, int32_t scale) override;
+    void surface_set_opaque_region(Resource *resource, wl_resource *region) override;
     void surface_commit(Resource *resource) override;
     void surface_frame(Resource *resource, uint32_t callback) override;
     void surface_offset(Resource *resource, int32_t x, int32_t y) override;
@@ -136,11 +142,29 @@ public:
     {
     }
 
+    static Region *fromResource(::wl_resource *resource)
+    {
+        return static_cast<Region *>(Resource::fromResource(resource)->object());
+    }
+
+    QRegion m_region;
+
+protected:
     void region_destroy_resource(Resource *resource) override
     {
         Q_UNUSED(resource);
         delete this;
     }
+    void region_add(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height) override
+    {
+        Q_UNUSED(resource);
+        m_region += QRect(x, y, width, height);
+    }
+    void region_subtract(Resource *resource, int32_t x, int32_t y, int32_t width, int32_t height) override
+    {
+        Q_UNUSED(resource);
+        m_region -= QRect(x, y, width, height);
+    }
 };
 
 class WlCompositor : public Global, public QtWaylandServer::wl_compositor
@@ -207,9 +231,21 @@ class Subsurface : public QObject, public QtWaylandServer::wl_subsurface
 {
     Q_OBJECT
 public:
-    explicit Subsurface(wl_client *client, int id, int version)
+    explicit Subsurface(Surface *surface, Surface *parent, wl_client *client, int id, int version)
         : QtWaylandServer::wl_subsurface(client, id, version)
+        , m_surface(surface)
+        , m_parent(parent)
+    {
+    }
+    QPointer<Surface> m_surface;
+    QPointer<Surface> m_parent;
+    QPoint m_position;
+
+protected:
+    void subsurface_set_position(Resource *resource, int32_t x, int32_t y) override
     {
+        Q_UNUSED(resource);
+        m_position = QPoint(x, y);
     }
 };
 
@@ -230,7 +266,8 @@ protected:
     {
         QTRY_VERIFY(parent);
         QTRY_VERIFY(surface);
-        auto *subsurface = new Subsurface(resource->client(), id, resource->version());
+        auto *subsurface = new Subsurface(fromResource<Surface>(surface), fromResource<Surface>(parent),
+                                          resource->client(), id, resource->version());
         m_subsurfaces.append(subsurface); // TODO: clean up?
         emit subsurfaceCreated(subsurface);
     }
@@ -418,6 +455,7 @@ public:
     bool isClean() override;
     CoreCompositor *m_compositor = nullptr;
     QList<ShmPool *> m_pools;
+    int m_createdPools = 0;
     const QList<format> m_formats;
 
 protected:
@@ -429,16 +467,22 @@ protected:
     }
 };
 
-class ShmPool : QObject, public QtWaylandServer::wl_shm_pool
+class ShmPool : public QObject, public QtWaylandServer::wl_shm_pool
 {
     Q_OBJECT
 public:
-    explicit ShmPool(Shm *shm, wl_client *client, int id, int version = 1);
+    explicit ShmPool(Shm *shm, wl_client *client, int id, int fd, int size, int version = 1);
+    ~ShmPool() override;
+    QImage image(int offset, const QSize &size, int stride, Shm::format format) const;
     Shm *m_shm = nullptr;
+    int m_fd = -1;
     QList<ShmBuffer *> m_buffers;
+    const int m_serial; // Identifies the pool, even after it has been destroyed
+    int m_size = 0;
 
 protected:
     void shm_pool_create_buffer(Resource *resource, uint32_t id, int32_t offset, int32_t width, int32_t height, int32_t stride, uint32_t format) override;
+    void shm_pool_resize(Resource *resource, int32_t size) override;
     void shm_pool_destroy_resource(Resource *resource) override;
     void shm_pool_destroy(Resource *resource) override { wl_resource_destroy(resource->handle); }
 };
@@ -448,8 +492,10 @@ class ShmBuffer : public Buffer
     Q_OBJECT
 public:
     static ShmBuffer *fromBuffer(Buffer *buffer) { return qobject_cast<ShmBuffer *>(buffer); }
-    explicit ShmBuffer(int offset, const QSize &size, int stride, Shm::format format, wl_client *client, int id, int version = 1)
+    explicit ShmBuffer(ShmPool *pool, int offset, const QSize &size, int stride, Shm::format format, wl_client *client, int id, int version = 1)
         : Buffer(client, id, version)
+        , m_pool(pool)
+        , m_poolSerial(pool->m_serial)
         , m_offset(offset)
         , m_size(size)
         , m_stride(stride)
@@ -457,6 +503,10 @@ public:
     {
     }
     QSize size() const override { return m_size; }
+    // The current contents, or a null image if the pool is gone
+    QImage image() const { return m_pool ? m_pool->image(m_offset, m_size, m_stride, m_format) : QImage(); }
+    QPointer<ShmPool> m_pool;
+    const int m_poolSerial;
     const int m_offset;
     const QSize m_size;
     const int m_stride;
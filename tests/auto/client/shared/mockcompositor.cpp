@@ -23,6 +23,8 @@ DefaultCompositor::DefaultCompositor(CompositorType t, int socketFd)
         add<XdgWmBase>();
         add<FractionalScaleManager>();
         add<Viewporter>();
+        add<Presentation>();
+        add<SinglePixelBufferManager>();
         add<XdgWmDialog>();
 
         switch (m_type) {
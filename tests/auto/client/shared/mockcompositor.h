@@ -13,6 +13,8 @@
 #include "xdgshell.h"
 #include "viewport.h"
 #include "fractionalscalev1.h"
+#include "presentationtime.h"
+#include "singlepixelbuffer.h"
 #include "xdgdialog.h"
 
 #include <QtGui/QGuiApplication>
@@ -51,6 +53,7 @@ public:
     IviSurface *iviSurface(int i = 0) { return get<IviApplication>()->m_iviSurfaces.value(i, nullptr); }
     FractionalScale *fractionalScale(int i = 0) {return get<FractionalScaleManager>()->m_fractionalScales.value(i, nullptr); }
     Viewport *viewport(int i = 0) {return get<Viewporter>()->m_viewports.value(i, nullptr); }
+    PresentationFeedback *presentationFeedback(int i = 0) { return get<Presentation>()->m_feedbacks.value(i, nullptr); }
     XdgDialog *xdgDialog(int i = 0) { return get<XdgWmDialog>()->m_dialogs.value(i, nullptr); }
 
     uint sendXdgShellPing();
@@ -0,0 +1,61 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "presentationtime.h"
+
+#include <time.h>
+
+namespace MockCompositor {
+
+Presentation::Presentation(CoreCompositor *compositor, int version)
+    : QtWaylandServer::wp_presentation(compositor->m_display, version)
+{
+}
+
+void Presentation::wp_presentation_bind_resource(Resource *resource)
+{
+    send_clock_id(resource->handle, CLOCK_MONOTONIC);
+}
+
+void Presentation::wp_presentation_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void Presentation::wp_presentation_feedback(Resource *resource, wl_resource *surface, uint32_t callback)
+{
+    auto *s = fromResource<Surface>(surface);
+    auto *feedback = new PresentationFeedback(s, resource->client(), callback, resource->version());
+    connect(feedback, &QObject::destroyed, this, [this, feedback]() {
+        m_feedbacks.removeOne(feedback);
+    });
+    m_feedbacks << feedback;
+}
+
+PresentationFeedback::PresentationFeedback(Surface *surface, wl_client *client, int id, int version)
+    : QtWaylandServer::wp_presentation_feedback(client, id, version)
+    , m_surface(surface)
+{
+}
+
+void PresentationFeedback::sendPresented(qint64 time, uint refresh, quint64 sequence, uint flags)
+{
+    const quint64 seconds = time / 1000000000;
+    send_presented(seconds >> 32, seconds & 0xffffffff, time % 1000000000, refresh,
+                   sequence >> 32, sequence & 0xffffffff, flags);
+    wl_resource_destroy(resource()->handle);
+}
+
+void PresentationFeedback::sendDiscarded()
+{
+    send_discarded();
+    wl_resource_destroy(resource()->handle);
+}
+
+void PresentationFeedback::wp_presentation_feedback_destroy_resource(Resource *resource)
+{
+    Q_UNUSED(resource)
+    delete this;
+}
+
+}
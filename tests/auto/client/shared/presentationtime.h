@@ -0,0 +1,45 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef MOCKCOMPOSITOR_PRESENTATIONTIME_H
+#define MOCKCOMPOSITOR_PRESENTATIONTIME_H
+
+#include "coreprotocol.h"
+#include <qwayland-server-presentation-time.h>
+
+namespace MockCompositor {
+
+class PresentationFeedback;
+
+class Presentation : public Global, public QtWaylandServer::wp_presentation
+{
+    Q_OBJECT
+public:
+    explicit Presentation(CoreCompositor *compositor, int version = 1);
+    QList<PresentationFeedback *> m_feedbacks;
+
+protected:
+    void wp_presentation_bind_resource(Resource *resource) override;
+    void wp_presentation_destroy(Resource *resource) override;
+    void wp_presentation_feedback(Resource *resource, wl_resource *surface, uint32_t callback) override;
+};
+
+class PresentationFeedback : public QObject, public QtWaylandServer::wp_presentation_feedback
+{
+    Q_OBJECT
+public:
+    explicit PresentationFeedback(Surface *surface, wl_client *client, int id, int version);
+
+    // Both destroy the feedback
+    void sendPresented(qint64 time, uint refresh, quint64 sequence, uint flags);
+    void sendDiscarded();
+
+    Surface *m_surface;
+
+protected:
+    void wp_presentation_feedback_destroy_resource(Resource *resource) override;
+};
+
+}
+
+#endif
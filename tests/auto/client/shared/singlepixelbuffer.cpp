@@ -0,0 +1,24 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "singlepixelbuffer.h"
+
+namespace MockCompositor {
+
+SinglePixelBufferManager::SinglePixelBufferManager(CoreCompositor *compositor, int version)
+    : QtWaylandServer::wp_single_pixel_buffer_manager_v1(compositor->m_display, version)
+{
+}
+
+void SinglePixelBufferManager::wp_single_pixel_buffer_manager_v1_destroy(Resource *resource)
+{
+    wl_resource_destroy(resource->handle);
+}
+
+void SinglePixelBufferManager::wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(
+        Resource *resource, uint32_t id, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+{
+    new SinglePixelBuffer(resource->client(), id, r, g, b, a);
+}
+
+}
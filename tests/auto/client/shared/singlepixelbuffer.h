@@ -0,0 +1,43 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef MOCKCOMPOSITOR_SINGLEPIXELBUFFER_H
+#define MOCKCOMPOSITOR_SINGLEPIXELBUFFER_H
+
+#include "coreprotocol.h"
+#include <qwayland-server-single-pixel-buffer-v1.h>
+
+namespace MockCompositor {
+
+class SinglePixelBufferManager : public Global, public QtWaylandServer::wp_single_pixel_buffer_manager_v1
+{
+    Q_OBJECT
+public:
+    explicit SinglePixelBufferManager(CoreCompositor *compositor, int version = 1);
+
+protected:
+    void wp_single_pixel_buffer_manager_v1_destroy(Resource *resource) override;
+    void wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(Resource *resource, uint32_t id,
+                                                                 uint32_t r, uint32_t g,
+                                                                 uint32_t b, uint32_t a) override;
+};
+
+class SinglePixelBuffer : public Buffer
+{
+    Q_OBJECT
+public:
+    static SinglePixelBuffer *fromBuffer(Buffer *buffer) { return qobject_cast<SinglePixelBuffer *>(buffer); }
+    explicit SinglePixelBuffer(wl_client *client, int id, uint32_t r, uint32_t g, uint32_t b, uint32_t a)
+        : Buffer(client, id, 1)
+        , m_r(r), m_g(g), m_b(b), m_a(a)
+    {
+    }
+    QSize size() const override { return QSize(1, 1); }
+
+    // Premultiplied, as sent by the client
+    uint32_t m_r, m_g, m_b, m_a;
+};
+
+}
+
+#endif
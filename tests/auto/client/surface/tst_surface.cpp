@@ -3,6 +3,10 @@
 
 #include "mockcompositor.h"
 #include <QtGui/QRasterWindow>
+#include <QtGui/QPainter>
+#include <qpa/qplatformnativeinterface.h>
+#include <QtWaylandClient/private/qwaylandabstractdecoration_p.h>
+#include <QtWaylandClient/private/qwaylandwindow_p.h>
 #if QT_CONFIG(opengl)
 #include <QtOpenGL/QOpenGLWindow>
 #endif
@@ -22,6 +26,12 @@ private slots:
     void waitForFrameCallbackGl();
 #endif
     void negotiateShmFormat();
+    void presentationFeedback();
+    void solidColor();
+    void clearSolidColor();
+    void shmPool();
+    void shmNonBlocking();
+    void decorationDirtyMargins();
 
     // Subsurfaces
     void createSubsurface();
@@ -148,6 +158,331 @@ void tst_surface::negotiateShmFormat()
     });
 }
 
+void tst_surface::presentationFeedback()
+{
+    QRasterWindow window;
+    window.resize(64, 64);
+    window.show();
+    QCOMPOSITOR_TRY_VERIFY(xdgToplevel());
+    exec([&] { xdgToplevel()->sendCompleteConfigure(); });
+
+    // Feedback is requested for every commit
+    QCOMPOSITOR_TRY_VERIFY(presentationFeedback());
+    const qint64 time = 5000000000LL * 1000000000LL + 123; // Uses the high bits of tv_sec
+    const uint flags = PresentationFeedback::kind_vsync | PresentationFeedback::kind_hw_clock;
+    exec([&] { presentationFeedback()->sendPresented(time, 16666666, 0x100000001ULL, flags); });
+
+    auto *nativeInterface = QGuiApplication::platformNativeInterface();
+    auto feedback = [&] {
+        return nativeInterface->windowProperty(window.handle(), "presentationFeedback").toMap();
+    };
+    QTRY_COMPARE(feedback().value("presentedFrames").toULongLong(), 1u);
+    QCOMPARE(feedback().value("presentationTime").toLongLong(), time);
+    QCOMPARE(feedback().value("refresh").toLongLong(), 16666666);
+    QCOMPARE(feedback().value("sequence").toULongLong(), 0x100000001ULL);
+    QCOMPARE(feedback().value("flags").toUInt(), flags);
+
+    // Discarded frames are counted, but don't replace the last presentation
+    exec([&] { xdgToplevel()->surface()->sendFrameCallbacks(); });
+    window.update();
+    QCOMPOSITOR_TRY_VERIFY(presentationFeedback());
+    exec([&] { presentationFeedback()->sendDiscarded(); });
+    QTRY_COMPARE(feedback().value("discardedFrames").toULongLong(), 1u);
+    QCOMPARE(feedback().value("presentedFrames").toULongLong(), 1u);
+    QCOMPARE(feedback().value("presentationTime").toLongLong(), time);
+}
+
+void tst_surface::solidColor()
+{
+    // Nothing is ever rendered into this window
+    QWindow window;
+    window.resize(64, 64);
+    window.show();
+    QCOMPOSITOR_TRY_VERIFY(xdgToplevel());
+
+    auto *nativeInterface = QGuiApplication::platformNativeInterface();
+    const QColor color(255, 0, 0, 128);
+    nativeInterface->setWindowProperty(window.handle(), "solidColor", color);
+    QCOMPARE(nativeInterface->windowProperty(window.handle(), "solidColor").value<QColor>(), color);
+
+    exec([&] { xdgToplevel()->sendCompleteConfigure(); });
+    QCOMPOSITOR_TRY_VERIFY(SinglePixelBuffer::fromBuffer(xdgToplevel()->surface()->m_committed.buffer));
+    QCOMPOSITOR_COMPARE(viewport()->m_destination, QSize(64, 64));
+    exec([&] {
+        auto *buffer = SinglePixelBuffer::fromBuffer(xdgToplevel()->surface()->m_committed.buffer);
+        // The channels are premultiplied
+        QCOMPARE(buffer->m_a >> 24, 0x80u);
+        QCOMPARE(buffer->m_r >> 24, 0x80u);
+        QCOMPARE(buffer->m_g, 0u);
+        QCOMPARE(buffer->m_b, 0u);
+    });
+
+    // The window is opaque, but the color is not
+    QCOMPOSITOR_VERIFY(xdgToplevel()->surface()->m_committed.opaqueRegion.isEmpty());
+
+    // The buffer follows the window size
+    exec([&] { xdgToplevel()->sendCompleteConfigure(QSize(100, 50)); });
+    QCOMPOSITOR_TRY_COMPARE(viewport()->m_destination, QSize(100, 50));
+    QCOMPOSITOR_VERIFY(SinglePixelBuffer::fromBuffer(xdgToplevel()->surface()->m_committed.buffer));
+    QCOMPOSITOR_VERIFY(xdgToplevel()->surface()->m_committed.opaqueRegion.isEmpty());
+
+    nativeInterface->setWindowProperty(window.handle(), "solidColor", QColor(Qt::red));
+    QCOMPOSITOR_TRY_COMPARE(xdgToplevel()->surface()->m_committed.opaqueRegion.boundingRect().size(), QSize(100, 50));
+
+    // Swaps of OpenGL and Vulkan windows would replace the single pixel buffer
+    QWindow glWindow;
+    glWindow.setSurfaceType(QSurface::OpenGLSurface);
+    glWindow.create();
+    QVERIFY(glWindow.handle());
+    nativeInterface->setWindowProperty(glWindow.handle(), "solidColor", color);
+    QVERIFY(!nativeInterface->windowProperty(glWindow.handle(), "solidColor").value<QColor>().isValid());
+}
+
+void tst_surface::clearSolidColor()
+{
+    QRasterWindow window;
+    window.setFlag(Qt::FramelessWindowHint);
+    window.resize(64, 64);
+    window.show();
+    QCOMPOSITOR_TRY_VERIFY(xdgToplevel());
+
+    auto *nativeInterface = QGuiApplication::platformNativeInterface();
+    nativeInterface->setWindowProperty(window.handle(), "solidColor", QColor(255, 0, 0, 128));
+    exec([&] { xdgToplevel()->sendCompleteConfigure(); });
+    QCOMPOSITOR_TRY_VERIFY(SinglePixelBuffer::fromBuffer(xdgToplevel()->surface()->m_committed.buffer));
+    QCOMPOSITOR_VERIFY(xdgToplevel()->surface()->m_committed.opaqueRegion.isEmpty());
+
+    // The contents are painted again, and replace the single pixel buffer at the same size
+    nativeInterface->setWindowProperty(window.handle(), "solidColor", QColor());
+    QCOMPOSITOR_TRY_VERIFY(ShmBuffer::fromBuffer(xdgToplevel()->surface()->m_committed.buffer));
+    QCOMPOSITOR_COMPARE(xdgToplevel()->surface()->m_committed.buffer->size(), QSize(64, 64));
+    QCOMPOSITOR_COMPARE(viewport()->m_destination, QSize(64, 64));
+
+    // The window is opaque again
+    QCOMPOSITOR_COMPARE(xdgToplevel()->surface()->m_committed.opaqueRegion, QRegion(0, 0, 64, 64));
+}
+
+void tst_surface::shmPool()
+{
+    // The compositor holds on to buffers until they are explicitly released
+    exec([&] { m_config.autoRelease = false; });
+    auto cleanup = qScopeGuard([&] { exec([&] { m_config.autoRelease = true; }); });
+
+    QRasterWindow window;
+    window.setFlag(Qt::FramelessWindowHint);
+    window.resize(64, 64);
+    window.show();
+    QCOMPOSITOR_TRY_VERIFY(xdgToplevel());
+    exec([&] { xdgToplevel()->sendCompleteConfigure(); });
+    QCOMPOSITOR_TRY_VERIFY(xdgToplevel()->surface()->m_committed.buffer);
+
+    auto committedBuffer = [&] {
+        return ShmBuffer::fromBuffer(xdgToplevel()->surface()->m_committed.buffer);
+    };
+    auto pool = [&](int serial) -> ShmPool * {
+        for (ShmPool *pool : get<Shm>()->m_pools) {
+            if (pool->m_serial == serial)
+                return pool;
+        }
+        return nullptr;
+    };
+
+    QList<Buffer *> buffers;
+    int poolSerial = 0;
+    exec([&] {
+        ShmBuffer *buffer = committedBuffer();
+        QVERIFY(buffer);
+        QCOMPARE(buffer->m_size, QSize(64, 64));
+        QCOMPARE(buffer->m_offset, 0);
+        poolSerial = buffer->m_poolSerial;
+        QVERIFY(pool(poolSerial));
+        QVERIFY(pool(poolSerial)->m_size >= 64 * 64 * 4);
+        buffers << buffer;
+    });
+
+    // The first buffer is still in use, so the next one is allocated next to it
+    exec([&] { xdgToplevel()->surface()->sendFrameCallbacks(); });
+    window.update();
+    QCOMPOSITOR_TRY_VERIFY(committedBuffer() != buffers.last());
+    exec([&] {
+        ShmBuffer *buffer = committedBuffer();
+        QVERIFY(buffer);
+        QCOMPARE(buffer->m_poolSerial, poolSerial);
+        QVERIFY(buffer->m_offset >= 64 * 64 * 4);
+        buffers << buffer;
+    });
+
+    // The pool grows to make room for bigger buffers
+    exec([&] { xdgToplevel()->surface()->sendFrameCallbacks(); });
+    window.resize(96, 96);
+    QCOMPOSITOR_TRY_VERIFY(committedBuffer() && committedBuffer()->m_size == QSize(96, 96));
+    exec([&] {
+        ShmBuffer *buffer = committedBuffer();
+        QCOMPARE(buffer->m_poolSerial, poolSerial);
+        QVERIFY(buffer->m_offset >= 2 * 64 * 64 * 4);
+        QVERIFY(pool(poolSerial)->m_size >= buffer->m_offset + 96 * 96 * 4);
+        buffers << buffer;
+    });
+
+    // Once the buffers are released, their memory is reused
+    exec([&] {
+        for (Buffer *buffer : std::as_const(buffers))
+            buffer->send_release();
+        xdgToplevel()->surface()->sendFrameCallbacks();
+    });
+    window.resize(48, 48);
+    QCOMPOSITOR_TRY_VERIFY(committedBuffer() && committedBuffer()->m_size == QSize(48, 48));
+    exec([&] {
+        ShmBuffer *buffer = committedBuffer();
+        QCOMPARE(buffer->m_poolSerial, poolSerial);
+        QCOMPARE(buffer->m_offset, 0);
+        buffer->send_release();
+    });
+}
+
+void tst_surface::shmNonBlocking()
+{
+    qputenv("QT_WAYLAND_SHM_NONBLOCKING", "1");
+    qputenv("QT_WAYLAND_SHM_MAX_BUFFERS", "2");
+    auto cleanup = qScopeGuard([&] {
+        qunsetenv("QT_WAYLAND_SHM_NONBLOCKING");
+        qunsetenv("QT_WAYLAND_SHM_MAX_BUFFERS");
+        exec([&] { m_config.autoRelease = true; });
+    });
+    // The compositor holds on to buffers until they are explicitly released
+    exec([&] { m_config.autoRelease = false; });
+
+    class TestWindow : public QRasterWindow {
+    public:
+        void paintEvent(QPaintEvent *event) override
+        {
+            QPainter painter(this);
+            painter.fillRect(event->rect(), m_color);
+            ++m_paintCount;
+        }
+        QColor m_color = Qt::red;
+        int m_paintCount = 0;
+    };
+    TestWindow window;
+    window.setFlag(Qt::FramelessWindowHint);
+    window.resize(64, 64);
+    window.show();
+    QCOMPOSITOR_TRY_VERIFY(xdgToplevel());
+    exec([&] { xdgToplevel()->sendCompleteConfigure(); });
+    QCOMPOSITOR_TRY_VERIFY(xdgToplevel()->surface()->m_committed.buffer);
+    auto committedBuffer = [&] { return xdgToplevel()->surface()->m_committed.buffer; };
+    Buffer *first = exec([&] { return committedBuffer(); });
+
+    exec([&] { xdgToplevel()->surface()->sendFrameCallbacks(); });
+    window.m_color = Qt::green;
+    window.update();
+    QCOMPOSITOR_TRY_VERIFY(committedBuffer() != first);
+    Buffer *second = exec([&] { return committedBuffer(); });
+    const int paintCount = window.m_paintCount;
+
+    // Both buffers are held by the compositor, painting must neither block nor get lost
+    exec([&] { xdgToplevel()->surface()->sendFrameCallbacks(); });
+    window.m_color = Qt::blue;
+    window.update(QRect(0, 0, 16, 16));
+    QTRY_COMPARE(window.m_paintCount, paintCount + 1);
+    window.m_color = Qt::yellow;
+    window.update(QRect(32, 32, 16, 16));
+    QTRY_COMPARE(window.m_paintCount, paintCount + 2);
+    xdgPingAndWaitForPong(); // Make sure things have happened on the client
+    QCOMPOSITOR_COMPARE(committedBuffer(), second);
+
+    // All damage so far is committed as soon as a buffer is released
+    exec([&] { first->send_release(); });
+    QCOMPOSITOR_TRY_COMPARE(committedBuffer(), first);
+    exec([&] {
+        const QImage image = ShmBuffer::fromBuffer(first)->image();
+        QCOMPARE(image.pixelColor(0, 0), QColor(Qt::blue));
+        QCOMPARE(image.pixelColor(40, 40), QColor(Qt::yellow));
+        QCOMPARE(image.pixelColor(20, 20), QColor(Qt::green));
+
+        const auto &committed = xdgToplevel()->surface()->m_committed.commitSpecific;
+        const QRegion damage = committed.damage + committed.bufferDamage;
+        QVERIFY(damage.contains(QRect(0, 0, 16, 16)));
+        QVERIFY(damage.contains(QRect(32, 32, 16, 16)));
+        second->send_release();
+    });
+}
+
+void tst_surface::decorationDirtyMargins()
+{
+    class TestDecoration : public QtWaylandClient::QWaylandAbstractDecoration
+    {
+    public:
+        QMargins margins(MarginsType marginsType = Full) const override
+        {
+            return marginsType == ShadowsOnly ? QMargins() : QMargins(10, 10, 10, 10);
+        }
+        bool handleMouse(QtWaylandClient::QWaylandInputDevice *, const QPointF &, const QPointF &,
+                         Qt::MouseButtons, Qt::KeyboardModifiers) override { return false; }
+        bool handleTouch(QtWaylandClient::QWaylandInputDevice *, const QPointF &, const QPointF &,
+                         QEventPoint::State, Qt::KeyboardModifiers) override { return false; }
+
+        QColor m_color = Qt::red;
+        QRegion m_paintedRegion;
+
+    protected:
+        void paint(QPaintDevice *device) override
+        {
+            QPainter painter(device);
+            painter.fillRect(QRect(QPoint(), waylandWindow()->surfaceSize()), m_color);
+        }
+        bool paintClipped(QPainter *painter) override
+        {
+            m_paintedRegion += painter->clipRegion();
+            painter->fillRect(QRect(QPoint(), waylandWindow()->surfaceSize()), m_color);
+            return true;
+        }
+    };
+
+    QRasterWindow window;
+    window.setFlag(Qt::FramelessWindowHint);
+    window.resize(64, 64);
+    window.show();
+    QCOMPOSITOR_TRY_VERIFY(xdgToplevel());
+
+    TestDecoration decoration;
+    decoration.setWaylandWindow(static_cast<QtWaylandClient::QWaylandWindow *>(window.handle()));
+    const QSize surfaceSize = decoration.waylandWindow()->surfaceSize();
+    QImage image(surfaceSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::black);
+
+    // Everything is painted the first time
+    QPainter painter(&image);
+    QRegion painted = decoration.paintDirtyMargins(&painter);
+    painter.end();
+    const QRegion allMargins = QRegion(QRect(QPoint(), surfaceSize))
+            - QRect(QPoint(10, 10), surfaceSize - QSize(20, 20));
+    QCOMPARE(painted, allMargins);
+    QCOMPARE(image.pixelColor(0, 0), QColor(Qt::red));
+    QCOMPARE(image.pixelColor(surfaceSize.width() - 1, surfaceSize.height() - 1), QColor(Qt::red));
+    QCOMPARE(image.pixelColor(32, 32), QColor(Qt::black));
+
+    // Nothing changed, nothing is painted
+    decoration.m_paintedRegion = QRegion();
+    painter.begin(&image);
+    QVERIFY(decoration.paintDirtyMargins(&painter).isEmpty());
+    painter.end();
+    QVERIFY(decoration.m_paintedRegion.isEmpty());
+
+    // Only the part that was marked dirty is repainted
+    decoration.m_color = Qt::green;
+    decoration.update(QRect(20, 0, 10, 10));
+    painter.begin(&image);
+    painted = decoration.paintDirtyMargins(&painter);
+    painter.end();
+    QCOMPARE(painted, QRegion(20, 0, 10, 10));
+    QVERIFY(QRegion(20, 0, 10, 10).contains(decoration.m_paintedRegion.boundingRect()));
+    QCOMPARE(image.pixelColor(25, 5), QColor(Qt::green));
+    QCOMPARE(image.pixelColor(5, 5), QColor(Qt::red));
+    QCOMPARE(image.pixelColor(35, 5), QColor(Qt::red));
+    QCOMPARE(image.pixelColor(5, 32), QColor(Qt::red));
+}
+
 void tst_surface::createSubsurface()
 {
     m_config.autoFrameCallback = true;
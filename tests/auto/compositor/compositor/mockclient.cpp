@@ -58,6 +58,8 @@ const wl_output_listener MockClient::outputListener = {
 
 MockClient::~MockClient()
 {
+    delete shmServerBufferIntegration;
+    delete textureSharing;
     wl_display_disconnect(display);
 }
 
@@ -158,6 +160,8 @@ void MockClient::handleGlobal(uint32_t id, const QByteArray &interface)
         auto output = static_cast<wl_output *>(wl_registry_bind(registry, id, &wl_output_interface, 2));
         m_outputs.insert(id, output);
         wl_output_add_listener(output, &outputListener, this);
+    } else if (interface == "wl_subcompositor") {
+        subcompositor = static_cast<wl_subcompositor *>(wl_registry_bind(registry, id, &wl_subcompositor_interface, 1));
     } else if (interface == "wl_shm") {
         shm = static_cast<wl_shm *>(wl_registry_bind(registry, id, &wl_shm_interface, 1));
     } else if (interface == "wp_viewporter") {
@@ -173,8 +177,18 @@ void MockClient::handleGlobal(uint32_t id, const QByteArray &interface)
         m_seats << new MockSeat(s);
     } else if (interface == "zwp_idle_inhibit_manager_v1") {
         idleInhibitManager = static_cast<zwp_idle_inhibit_manager_v1 *>(wl_registry_bind(registry, id, &zwp_idle_inhibit_manager_v1_interface, 1));
+    } else if (interface == "wp_cursor_shape_manager_v1") {
+        cursorShapeManager = static_cast<wp_cursor_shape_manager_v1 *>(wl_registry_bind(registry, id, &wp_cursor_shape_manager_v1_interface, 1));
+    } else if (interface == "wp_fractional_scale_manager_v1") {
+        fractionalScaleManager = static_cast<wp_fractional_scale_manager_v1 *>(wl_registry_bind(registry, id, &wp_fractional_scale_manager_v1_interface, 1));
+    } else if (interface == "wp_single_pixel_buffer_manager_v1") {
+        singlePixelBufferManager = static_cast<wp_single_pixel_buffer_manager_v1 *>(wl_registry_bind(registry, id, &wp_single_pixel_buffer_manager_v1_interface, 1));
     } else if (interface == "zxdg_output_manager_v1") {
         xdgOutputManager = new QtWayland::zxdg_output_manager_v1(registry, id, 2);
+    } else if (interface == "qt_shm_emulation_server_buffer") {
+        shmServerBufferIntegration = new MockShmServerBufferIntegration(registry, id, 2);
+    } else if (interface == "zqt_texture_sharing_v1") {
+        textureSharing = new MockTextureSharing(registry, id, 1);
     }
 }
 
@@ -6,6 +6,9 @@
 #include <wayland-ivi-application-client-protocol.h>
 #include "wayland-viewporter-client-protocol.h"
 #include "wayland-idle-inhibit-unstable-v1-client-protocol.h"
+#include "wayland-cursor-shape-v1-client-protocol.h"
+#include "wayland-fractional-scale-v1-client-protocol.h"
+#include "wayland-single-pixel-buffer-v1-client-protocol.h"
 
 #include <QObject>
 #include <QImage>
@@ -14,6 +17,8 @@
 #include <QtCore/QMap>
 #include <QWaylandOutputMode>
 
+#include "mockshmserverbuffer.h"
+#include "mocktexturesharing.h"
 #include "mockxdgoutputv1.h"
 
 class MockSeat;
@@ -47,6 +52,7 @@ public:
 
     wl_display *display = nullptr;
     wl_compositor *compositor = nullptr;
+    wl_subcompositor *subcompositor = nullptr;
     QMap<uint, wl_output *> m_outputs;
     QMap<wl_output *, MockXdgOutputV1 *> m_xdgOutputs;
     wl_shm *shm = nullptr;
@@ -56,7 +62,12 @@ public:
     wp_viewporter *viewporter = nullptr;
     ivi_application *iviApplication = nullptr;
     zwp_idle_inhibit_manager_v1 *idleInhibitManager = nullptr;
+    wp_cursor_shape_manager_v1 *cursorShapeManager = nullptr;
+    wp_fractional_scale_manager_v1 *fractionalScaleManager = nullptr;
+    wp_single_pixel_buffer_manager_v1 *singlePixelBufferManager = nullptr;
     QtWayland::zxdg_output_manager_v1 *xdgOutputManager = nullptr;
+    MockShmServerBufferIntegration *shmServerBufferIntegration = nullptr;
+    MockTextureSharing *textureSharing = nullptr;
 
     QList<MockSeat *> m_seats;
 
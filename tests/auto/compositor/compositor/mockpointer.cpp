@@ -9,11 +9,11 @@ QT_WARNING_DISABLE_CLANG("-Wmissing-field-initializers")
 static void pointerEnter(void *pointer, struct wl_pointer *wlPointer, uint serial, struct wl_surface *surface, wl_fixed_t x, wl_fixed_t y)
 {
     Q_UNUSED(wlPointer);
-    Q_UNUSED(serial);
     Q_UNUSED(x);
     Q_UNUSED(y);
 
     static_cast<MockPointer *>(pointer)->m_enteredSurface = surface;
+    static_cast<MockPointer *>(pointer)->m_enterSerial = serial;
 }
 
 static void pointerLeave(void *pointer, struct wl_pointer *wlPointer, uint32_t serial, struct wl_surface *surface)
@@ -29,21 +29,25 @@ static void pointerLeave(void *pointer, struct wl_pointer *wlPointer, uint32_t s
 
 static void pointerMotion(void *pointer, struct wl_pointer *wlPointer, uint32_t time, wl_fixed_t x, wl_fixed_t y)
 {
-    Q_UNUSED(pointer);
     Q_UNUSED(wlPointer);
     Q_UNUSED(time);
-    Q_UNUSED(x);
-    Q_UNUSED(y);
+
+    auto *mockPointer = static_cast<MockPointer *>(pointer);
+    mockPointer->m_motionCount++;
+    mockPointer->m_position = QPointF(wl_fixed_to_double(x), wl_fixed_to_double(y));
 }
 
 static void pointerButton(void *pointer, struct wl_pointer *wlPointer, uint32_t serial, uint32_t time, uint32_t button, uint32_t state)
 {
-    Q_UNUSED(pointer);
     Q_UNUSED(wlPointer);
     Q_UNUSED(serial);
     Q_UNUSED(time);
     Q_UNUSED(button);
     Q_UNUSED(state);
+
+    auto *mockPointer = static_cast<MockPointer *>(pointer);
+    mockPointer->m_buttonCount++;
+    mockPointer->m_buttonPosition = mockPointer->m_position;
 }
 
 static void pointerAxis(void *pointer, struct wl_pointer *wlPointer, uint32_t time, uint32_t axis, wl_fixed_t value)
@@ -5,6 +5,7 @@
 #define MOCKPOINTER_H
 
 #include <QObject>
+#include <QPointF>
 #include "wayland-wayland-client-protocol.h"
 
 class MockPointer : public QObject
@@ -17,6 +18,11 @@ public:
 
     wl_pointer *m_pointer = nullptr;
     wl_surface *m_enteredSurface = nullptr;
+    uint m_enterSerial = 0;
+    int m_motionCount = 0;
+    QPointF m_position;
+    int m_buttonCount = 0;
+    QPointF m_buttonPosition;
 };
 
 #endif // MOCKPOINTER_H
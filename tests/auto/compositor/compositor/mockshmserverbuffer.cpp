@@ -0,0 +1,33 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "mockshmserverbuffer.h"
+
+#include <unistd.h>
+
+MockShmServerBufferIntegration::MockShmServerBufferIntegration(struct ::wl_registry *registry, uint32_t id, int version)
+    : QtWayland::qt_shm_emulation_server_buffer(registry, id, version)
+{
+}
+
+MockShmServerBufferIntegration::~MockShmServerBufferIntegration()
+{
+    for (const ServerBuffer &buffer : std::as_const(serverBuffers)) {
+        if (buffer.fd != -1)
+            close(buffer.fd);
+    }
+}
+
+void MockShmServerBufferIntegration::shm_emulation_server_buffer_server_buffer_created(struct ::qt_server_buffer *id, const QString &key,
+                                                                                       int32_t width, int32_t height,
+                                                                                       int32_t bytes_per_line, int32_t format)
+{
+    serverBuffers.append({ -1, key, QSize(width, height), bytes_per_line, format, id });
+}
+
+void MockShmServerBufferIntegration::shm_emulation_server_buffer_server_buffer_created_fd(struct ::qt_server_buffer *id, int32_t fd,
+                                                                                          int32_t width, int32_t height,
+                                                                                          int32_t bytes_per_line, int32_t format)
+{
+    serverBuffers.append({ fd, QString(), QSize(width, height), bytes_per_line, format, id });
+}
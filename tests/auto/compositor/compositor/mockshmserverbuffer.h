@@ -0,0 +1,39 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef MOCKSHMSERVERBUFFER_H
+#define MOCKSHMSERVERBUFFER_H
+
+#include <QList>
+#include <QSize>
+#include <QString>
+
+#include "qwayland-shm-emulation-server-buffer.h"
+
+// Records the server buffers of the shm-emulation-server integration
+class MockShmServerBufferIntegration : public QtWayland::qt_shm_emulation_server_buffer
+{
+public:
+    MockShmServerBufferIntegration(struct ::wl_registry *registry, uint32_t id, int version);
+    ~MockShmServerBufferIntegration();
+
+    struct ServerBuffer {
+        int fd = -1; // Only from server_buffer_created_fd
+        QString key; // Only from server_buffer_created
+        QSize size;
+        int bytesPerLine = 0;
+        int format = 0;
+        struct ::qt_server_buffer *buffer = nullptr;
+    };
+    QList<ServerBuffer> serverBuffers;
+
+protected:
+    void shm_emulation_server_buffer_server_buffer_created(struct ::qt_server_buffer *id, const QString &key,
+                                                           int32_t width, int32_t height,
+                                                           int32_t bytes_per_line, int32_t format) override;
+    void shm_emulation_server_buffer_server_buffer_created_fd(struct ::qt_server_buffer *id, int32_t fd,
+                                                              int32_t width, int32_t height,
+                                                              int32_t bytes_per_line, int32_t format) override;
+};
+
+#endif // MOCKSHMSERVERBUFFER_H
@@ -0,0 +1,21 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include "mocktexturesharing.h"
+
+MockTextureSharing::MockTextureSharing(struct ::wl_registry *registry, uint32_t id, int version)
+    : QtWayland::zqt_texture_sharing_v1(registry, id, version)
+{
+}
+
+void MockTextureSharing::zqt_texture_sharing_v1_image_failed(const QString &key, const QString &error_message)
+{
+    Q_UNUSED(error_message);
+    failedKeys.append(key);
+}
+
+void MockTextureSharing::zqt_texture_sharing_v1_provide_buffer(struct ::qt_server_buffer *buffer, const QString &key)
+{
+    Q_UNUSED(buffer);
+    providedKeys.append(key);
+}
@@ -0,0 +1,25 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef MOCKTEXTURESHARING_H
+#define MOCKTEXTURESHARING_H
+
+#include <QStringList>
+
+#include "qwayland-qt-texture-sharing-unstable-v1.h"
+
+// Records which shared images the compositor provided and which failed
+class MockTextureSharing : public QtWayland::zqt_texture_sharing_v1
+{
+public:
+    MockTextureSharing(struct ::wl_registry *registry, uint32_t id, int version);
+
+    QStringList providedKeys;
+    QStringList failedKeys;
+
+protected:
+    void zqt_texture_sharing_v1_image_failed(const QString &key, const QString &error_message) override;
+    void zqt_texture_sharing_v1_provide_buffer(struct ::qt_server_buffer *buffer, const QString &key) override;
+};
+
+#endif // MOCKTEXTURESHARING_H
@@ -22,15 +22,46 @@
 #include <QtWaylandCompositor/QWaylandResource>
 #include <QtWaylandCompositor/QWaylandKeymap>
 #include <QtWaylandCompositor/QWaylandViewporter>
+#include <QtWaylandCompositor/QWaylandSinglePixelBufferManagerV1>
 #include <QtWaylandCompositor/QWaylandIdleInhibitManagerV1>
+#include <QtWaylandCompositor/QWaylandCursorShapeManagerV1>
+#include <QtWaylandCompositor/QWaylandFractionalScaleManagerV1>
 #include <QtWaylandCompositor/QWaylandXdgOutputManagerV1>
 #include <qwayland-xdg-shell.h>
 #include <qwayland-ivi-application.h>
+#include <wayland-server-buffer-extension-client-protocol.h>
+#include <QtWaylandCompositor/private/qwaylandcompositor_p.h>
 #include <QtWaylandCompositor/private/qwaylandoutput_p.h>
 #include <QtWaylandCompositor/private/qwaylandsurface_p.h>
+#include <QtWaylandCompositor/private/qwaylandview_p.h>
+#include <QtWaylandCompositor/private/qwlserverbufferintegration_p.h>
+#if QT_CONFIG(opengl)
+#include <QtGui/QOffscreenSurface>
+#include <QtGui/QOpenGLContext>
+#include <QtGui/QOpenGLFunctions>
+#include <QtOpenGL/QOpenGLTexture>
+#endif
+#if QT_CONFIG(wayland_compositor_quick)
+#include <QtWaylandCompositor/private/qwaylandquickitem_p.h>
+#if QT_CONFIG(opengl)
+#include <QtWaylandCompositor/private/qwltexturesharingextension_p.h>
+#endif
+#include <QtWaylandCompositor/QWaylandQuickOutput>
+#include <QtQuick/QQuickWindow>
+#include <QtQuick/private/qquickitem_p.h>
+#include <QtQuick/private/qquickwindow_p.h>
+#include <QtQuick/QSGGeometryNode>
+#include <rhi/qrhi.h>
+#endif
 
+#include <QtCore/QScopeGuard>
 #include <QtTest/QtTest>
 
+#include <memory>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+
 class tst_WaylandCompositor : public QObject
 {
     Q_OBJECT
@@ -47,6 +78,7 @@ private slots:
     void seatCreation();
     void seatKeyboardFocus();
     void seatMouseFocus();
+    void seatMotionBatching();
     void inputRegion();
     void defaultInputRegionHiDpi();
     void singleClient();
@@ -59,7 +91,29 @@ private slots:
     void mapSurface();
     void mapSurfaceHiDpi();
     void frameCallback();
+    void frameCallbackMultipleSurfaces();
+    void multipleFrameCallbacks();
+    void occludedFrameCallbacks();
+    void viewDamageAccumulation();
+    void synchronizedSubsurface();
     void pixelFormats();
+#if QT_CONFIG(opengl)
+    void sharedMemoryOpenGLTextureAlpha();
+#endif
+#if QT_CONFIG(wayland_compositor_quick)
+    void sharedMemoryTexturePartialUpload();
+    void occlusionOfStackedItems();
+    void occlusionOfLockedItem();
+    void surfaceNodeOpaqueRegion();
+#endif
+    void shmEmulationServerBuffer();
+#if QT_CONFIG(opengl) && QT_CONFIG(wayland_compositor_quick)
+    void textureSharingAsyncLoad();
+    void textureSharingCacheEviction();
+    void textureSharingPreload();
+    void textureSharingMovedImage();
+    void textureSharingDiskCache();
+#endif
     void outputs();
     void customSurface();
 
@@ -90,6 +144,9 @@ private slots:
     void viewportHiDpi();
 
     void idleInhibit();
+    void cursorShape();
+    void fractionalScale();
+    void singlePixelBuffer();
 
     void xdgOutput();
 
@@ -634,6 +691,255 @@ void tst_WaylandCompositor::frameCallback()
     wl_surface_destroy(surface);
 }
 
+void tst_WaylandCompositor::frameCallbackMultipleSurfaces()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    QWaylandOutput *output = compositor.defaultOutput();
+
+    const int surfaceCount = 3;
+    wl_surface *surfaces[surfaceCount];
+    for (int i = 0; i < surfaceCount; ++i)
+        surfaces[i] = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), surfaceCount);
+
+    BufferView views[surfaceCount];
+    for (int i = 0; i < surfaceCount; ++i) {
+        views[i].setSurface(compositor.surfaces.at(i));
+        views[i].setOutput(output);
+    }
+
+    ShmBuffer buffer(QSize(16, 16), client.shm);
+    int frameCounters[surfaceCount] = {};
+    auto commitFrame = [&](int i) {
+        wl_surface_attach(surfaces[i], buffer.handle, 0, 0);
+        registerFrameCallback(surfaces[i], &frameCounters[i]);
+        wl_surface_damage(surfaces[i], 0, 0, 16, 16);
+        wl_surface_commit(surfaces[i]);
+    };
+
+    for (int i = 0; i < surfaceCount; ++i)
+        commitFrame(i);
+    QTRY_VERIFY(compositor.surfaces.at(surfaceCount - 1)->hasContent());
+
+    // Removing the first surface's view moves another one into its place
+    views[0].setOutput(nullptr);
+    output->frameStarted();
+    output->sendFrameCallbacks();
+    QTRY_COMPARE(frameCounters[1], 1);
+    QTRY_COMPARE(frameCounters[2], 1);
+    QCOMPARE(frameCounters[0], 0);
+
+    // Callbacks committed after the frame started are sent with the next one
+    commitFrame(2);
+    QTRY_VERIFY(QWaylandSurfacePrivate::get(compositor.surfaces.at(2))->hasFrameCallbacks());
+    output->frameStarted();
+    commitFrame(1);
+    QTRY_VERIFY(QWaylandSurfacePrivate::get(compositor.surfaces.at(1))->hasFrameCallbacks());
+    output->sendFrameCallbacks();
+    QTRY_COMPARE(frameCounters[2], 2);
+    QCOMPARE(frameCounters[1], 1);
+
+    output->frameStarted();
+    output->sendFrameCallbacks();
+    QTRY_COMPARE(frameCounters[1], 2);
+    QCOMPARE(frameCounters[2], 2);
+
+    for (wl_surface *surface : surfaces)
+        wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::multipleFrameCallbacks()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    wl_surface *surface = client.createSurface();
+
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+    BufferView view;
+    view.setSurface(waylandSurface);
+    view.setOutput(compositor.defaultOutput());
+
+    ShmBuffer buffer(QSize(16, 16), client.shm);
+    int frameCounter = 0;
+    for (int i = 0; i < 5; ++i) {
+        wl_surface_attach(surface, buffer.handle, 0, 0);
+        for (int j = 0; j < 3; ++j)
+            registerFrameCallback(surface, &frameCounter);
+        wl_surface_damage(surface, 0, 0, 16, 16);
+        wl_surface_commit(surface);
+
+        QTRY_VERIFY(QWaylandSurfacePrivate::get(waylandSurface)->hasFrameCallbacks());
+        compositor.defaultOutput()->frameStarted();
+        compositor.defaultOutput()->sendFrameCallbacks();
+        QVERIFY(!QWaylandSurfacePrivate::get(waylandSurface)->hasFrameCallbacks());
+        QTRY_COMPARE(frameCounter, (i + 1) * 3);
+    }
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::occludedFrameCallbacks()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    wl_surface *surface = client.createSurface();
+
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+    BufferView view;
+    view.setSurface(waylandSurface);
+    view.setOutput(compositor.defaultOutput());
+
+    ShmBuffer buffer(QSize(16, 16), client.shm);
+    int frameCounter = 0;
+    auto commitFrame = [&] {
+        wl_surface_attach(surface, buffer.handle, 0, 0);
+        registerFrameCallback(surface, &frameCounter);
+        wl_surface_damage(surface, 0, 0, 16, 16);
+        wl_surface_commit(surface);
+        QTRY_VERIFY(QWaylandSurfacePrivate::get(waylandSurface)->hasFrameCallbacks());
+    };
+    auto frame = [&] {
+        compositor.defaultOutput()->frameStarted();
+        compositor.defaultOutput()->sendFrameCallbacks();
+    };
+
+    commitFrame();
+    frame();
+    QTRY_COMPARE(frameCounter, 1);
+
+    // Occluded surfaces are throttled to one frame callback per second by default
+    QWaylandViewPrivate::get(&view)->occluded = true;
+    commitFrame();
+    frame();
+    QVERIFY(QWaylandSurfacePrivate::get(waylandSurface)->hasFrameCallbacks());
+
+    QWaylandViewPrivate::get(&view)->occluded = false;
+    frame();
+    QTRY_COMPARE(frameCounter, 2);
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::viewDamageAccumulation()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+
+    QWaylandView view;
+    view.setSurface(waylandSurface);
+    view.setOutput(compositor.defaultOutput());
+
+    QSignalSpy damagedSpy(waylandSurface, SIGNAL(damaged(const QRegion &)));
+
+    constexpr int bufferScale = 2;
+    const QSize bufferSize(64, 64);
+    ShmBuffer buffer(bufferSize, client.shm);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_set_buffer_scale(surface, bufferScale);
+    wl_surface_damage(surface, 0, 0, 4, 4);
+    wl_surface_commit(surface);
+    wl_surface_damage(surface, 10, 10, 2, 2);
+    wl_surface_commit(surface);
+    QTRY_COMPARE(damagedSpy.size(), 2);
+
+    // Both commits happened before advance(), so neither damage may be lost
+    QVERIFY(view.advance());
+    QCOMPARE(view.currentDamage(), QRegion(0, 0, 4, 4) | QRegion(10, 10, 2, 2));
+
+    wl_surface_damage(surface, 20, 20, 1, 1);
+    wl_surface_commit(surface);
+    QTRY_COMPARE(damagedSpy.size(), 3);
+    QVERIFY(view.advance());
+    QCOMPARE(view.currentDamage(), QRegion(20, 20, 1, 1));
+
+    // The buffer damage is accumulated until it is taken, and is in buffer coordinates
+    QCOMPARE(view.takeBufferDamage(), QRegion(0, 0, 8, 8) | QRegion(20, 20, 4, 4) | QRegion(40, 40, 2, 2));
+    QCOMPARE(view.takeBufferDamage(), QRegion());
+
+    // Damage that is not taken does not fragment without bound
+    for (int i = 0; i < 20; ++i) {
+        wl_surface_damage(surface, i, 2 * i, 1, 1);
+        wl_surface_commit(surface);
+        QTRY_COMPARE(damagedSpy.size(), 4 + i);
+        QVERIFY(view.advance());
+    }
+    const QRegion damage = view.takeBufferDamage();
+    QVERIFY(damage.rectCount() <= 16);
+    QCOMPARE(damage.boundingRect(), QRect(0, 0, 40, 80));
+
+    // Once it covers the buffer, it is the buffer
+    wl_surface_damage(surface, 0, 0, 16, 32);
+    wl_surface_commit(surface);
+    wl_surface_damage(surface, 16, 0, 16, 32);
+    wl_surface_commit(surface);
+    QTRY_COMPARE(damagedSpy.size(), 25);
+    QVERIFY(view.advance());
+    QCOMPARE(view.takeBufferDamage(), QRegion(0, 0, 64, 64));
+
+    wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::synchronizedSubsurface()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    QVERIFY(client.subcompositor);
+
+    wl_surface *parent = client.createSurface();
+    wl_surface *child = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 2);
+    QWaylandSurface *waylandParent = compositor.surfaces.at(0);
+    QWaylandSurface *waylandChild = compositor.surfaces.at(1);
+
+    wl_subsurface *subsurface = wl_subcompositor_get_subsurface(client.subcompositor, child, parent);
+    QTRY_VERIFY(QWaylandSurfacePrivate::get(waylandChild)->isSubsurface());
+
+    QSignalSpy parentDamagedSpy(waylandParent, SIGNAL(damaged(const QRegion &)));
+    QSignalSpy childDamagedSpy(waylandChild, SIGNAL(damaged(const QRegion &)));
+
+    // Subsurfaces are synchronized by default, the state is cached until the parent commits
+    const QSize size(32, 32);
+    ShmBuffer buffer(size, client.shm);
+    wl_surface_attach(child, buffer.handle, 0, 0);
+    wl_surface_damage(child, 0, 0, 4, 4);
+    wl_surface_commit(child);
+    wl_surface_damage(child, 8, 8, 4, 4);
+    wl_surface_commit(child);
+    wl_surface_commit(parent);
+    QTRY_COMPARE(parentDamagedSpy.size(), 1);
+    QCOMPARE(childDamagedSpy.size(), 1);
+    QCOMPARE(childDamagedSpy.at(0).at(0).value<QRegion>(), QRegion(0, 0, 4, 4) | QRegion(8, 8, 4, 4));
+    QCOMPARE(waylandChild->bufferSize(), size);
+
+    // In desynchronized mode, commits are applied immediately
+    wl_subsurface_set_desync(subsurface);
+    wl_surface_damage(child, 0, 0, 1, 1);
+    wl_surface_commit(child);
+    QTRY_COMPARE(childDamagedSpy.size(), 2);
+    QCOMPARE(parentDamagedSpy.size(), 1);
+
+    wl_subsurface_destroy(subsurface);
+    wl_surface_destroy(child);
+    wl_surface_destroy(parent);
+}
+
 void tst_WaylandCompositor::pixelFormats()
 {
     TestCompositor compositor;
@@ -663,6 +969,689 @@ void tst_WaylandCompositor::pixelFormats()
     wl_surface_destroy(surface);
 }
 
+#if QT_CONFIG(opengl)
+void tst_WaylandCompositor::sharedMemoryOpenGLTextureAlpha()
+{
+    QOpenGLContext context;
+    if (!context.create())
+        QSKIP("OpenGL is not available");
+    QOffscreenSurface offscreenSurface;
+    offscreenSurface.setFormat(context.format());
+    offscreenSurface.create();
+    if (!context.makeCurrent(&offscreenSurface))
+        QSKIP("Could not make the OpenGL context current");
+
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+    BufferView view;
+    view.setSurface(waylandSurface);
+    view.setOutput(compositor.defaultOutput());
+
+    QSize size(8, 8);
+    ShmBuffer buffer(size, client.shm);
+    buffer.image.fill(QColor(255, 0, 0, 128)); // Stored premultiplied
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, size.width(), size.height());
+    wl_surface_commit(surface);
+    QTRY_VERIFY(waylandSurface->hasContent());
+
+    QOpenGLTexture *texture = view.bufferRef.toOpenGLTexture();
+    QVERIFY(texture);
+
+    QOpenGLFunctions *gl = context.functions();
+    GLuint fbo = 0;
+    gl->glGenFramebuffers(1, &fbo);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture->textureId(), 0);
+    const GLenum status = gl->glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    uchar texel[4] = {};
+    gl->glReadPixels(3, 3, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+    gl->glBindFramebuffer(GL_FRAMEBUFFER, context.defaultFramebufferObject());
+    gl->glDeleteFramebuffers(1, &fbo);
+    QCOMPARE(status, GLenum(GL_FRAMEBUFFER_COMPLETE));
+
+    // The premultiplied pixels are uploaded as they are
+    QVERIFY(qAbs(int(texel[0]) - 128) <= 1);
+    QCOMPARE(int(texel[1]), 0);
+    QCOMPARE(int(texel[2]), 0);
+    QVERIFY(qAbs(int(texel[3]) - 128) <= 1);
+
+    wl_surface_destroy(surface);
+}
+#endif
+
+#if QT_CONFIG(wayland_compositor_quick)
+void tst_WaylandCompositor::sharedMemoryTexturePartialUpload()
+{
+    QRhiNullInitParams params;
+    std::unique_ptr<QRhi> rhi(QRhi::create(QRhi::Null, &params));
+    QVERIFY(rhi);
+
+    QWaylandSharedMemoryTexture texture;
+    auto uploadAndReadBack = [&]() {
+        QRhiCommandBuffer *cb = nullptr;
+        if (rhi->beginOffscreenFrame(&cb) != QRhi::FrameOpSuccess)
+            return QImage();
+        QRhiResourceUpdateBatch *batch = rhi->nextResourceUpdateBatch();
+        texture.commitTextureOperations(rhi.get(), batch);
+        QRhiReadbackResult result;
+        batch->readBackTexture(QRhiReadbackDescription(texture.rhiTexture()), &result);
+        cb->resourceUpdate(batch);
+        rhi->endOffscreenFrame();
+        return QImage(reinterpret_cast<const uchar *>(result.data.constData()),
+                      result.pixelSize.width(), result.pixelSize.height(),
+                      QImage::Format_RGBA8888_Premultiplied).copy();
+    };
+
+    QImage image(32, 32, QImage::Format_RGBA8888_Premultiplied);
+    image.fill(Qt::red);
+    texture.setImage(image, QRegion());
+    QImage result = uploadAndReadBack();
+    QCOMPARE(result.size(), image.size());
+    QCOMPARE(result.pixelColor(0, 0), QColor(Qt::red));
+    QCOMPARE(result.pixelColor(31, 31), QColor(Qt::red));
+
+    // The whole image changes, but only the damaged part is uploaded
+    image.fill(Qt::blue);
+    texture.setImage(image, QRegion(8, 8, 4, 4) + QRegion(20, 2, 2, 2));
+    result = uploadAndReadBack();
+    QCOMPARE(result.pixelColor(8, 8), QColor(Qt::blue));
+    QCOMPARE(result.pixelColor(11, 11), QColor(Qt::blue));
+    QCOMPARE(result.pixelColor(21, 3), QColor(Qt::blue));
+    QCOMPARE(result.pixelColor(0, 0), QColor(Qt::red));
+    QCOMPARE(result.pixelColor(12, 12), QColor(Qt::red));
+    QCOMPARE(result.pixelColor(20, 4), QColor(Qt::red));
+
+    // Nothing damaged, nothing uploaded
+    image.fill(Qt::green);
+    texture.setImage(image, QRegion());
+    result = uploadAndReadBack();
+    QCOMPARE(result.pixelColor(0, 0), QColor(Qt::red));
+    QCOMPARE(result.pixelColor(8, 8), QColor(Qt::blue));
+
+    // A new size always uploads everything
+    QImage resized(16, 16, QImage::Format_RGBA8888_Premultiplied);
+    resized.fill(Qt::green);
+    texture.setImage(resized, QRegion(0, 0, 1, 1));
+    result = uploadAndReadBack();
+    QCOMPARE(result.size(), resized.size());
+    QCOMPARE(result.pixelColor(15, 15), QColor(Qt::green));
+}
+
+void tst_WaylandCompositor::occlusionOfStackedItems()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    ShmBuffer buffer(QSize(16, 16), client.shm);
+    wl_region *region = wl_compositor_create_region(client.compositor);
+    wl_region_add(region, 0, 0, 16, 16);
+    QList<wl_surface *> surfaces;
+    for (int i = 0; i < 4; ++i) {
+        wl_surface *surface = client.createSurface();
+        wl_surface_attach(surface, buffer.handle, 0, 0);
+        wl_surface_set_opaque_region(surface, region);
+        wl_surface_damage(surface, 0, 0, 16, 16);
+        wl_surface_commit(surface);
+        surfaces << surface;
+    }
+    QTRY_COMPARE(compositor.surfaces.size(), 4);
+    for (QWaylandSurface *surface : std::as_const(compositor.surfaces))
+        QTRY_VERIFY(surface->hasContent());
+
+    QQuickWindow window;
+    window.resize(64, 64);
+    QWaylandQuickOutput output(&compositor, &window);
+
+    auto createItem = [&](int index, QQuickItem *parent, const QPointF &position) {
+        auto *item = new QWaylandQuickItem(parent);
+        item->setSurface(compositor.surfaces.at(index));
+        item->setPosition(position);
+        item->setSize(QSizeF(16, 16));
+        return item;
+    };
+    auto isOccluded = [](QWaylandQuickItem *item) {
+        return QWaylandViewPrivate::get(item->view())->occluded;
+    };
+
+    // Later siblings are stacked on top
+    QWaylandQuickItem *covered = createItem(0, window.contentItem(), QPointF(0, 0));
+    QWaylandQuickItem *cover = createItem(1, window.contentItem(), QPointF(0, 0));
+    QWaylandQuickItem *behindTranslucent = createItem(2, window.contentItem(), QPointF(32, 0));
+    auto *translucentParent = new QQuickItem(window.contentItem());
+    translucentParent->setOpacity(0.5);
+    QWaylandQuickItem *translucent = createItem(3, translucentParent, QPointF(32, 0));
+    QCOMPARE(translucent->opacity(), 1.0);
+
+    output.updateStarted();
+    QVERIFY(isOccluded(covered));
+    QVERIFY(!isOccluded(cover));
+    QVERIFY(!isOccluded(behindTranslucent));
+    QVERIFY(!isOccluded(translucent));
+
+    // The parent is fully opaque again
+    translucentParent->setOpacity(1);
+    output.updateStarted();
+    QVERIFY(isOccluded(behindTranslucent));
+    QVERIFY(!isOccluded(translucent));
+
+    // Views of hidden items are occluded, and do not occlude
+    translucentParent->setVisible(false);
+    output.updateStarted();
+    QVERIFY(!isOccluded(behindTranslucent));
+    QVERIFY(isOccluded(translucent));
+
+    // Only items that draw their surface's committed state occlude
+    cover->setBufferLocked(true);
+    output.updateStarted();
+    QVERIFY(!isOccluded(covered));
+    cover->setBufferLocked(false);
+    cover->setPaintEnabled(false);
+    output.updateStarted();
+    QVERIFY(!isOccluded(covered));
+
+    wl_region_destroy(region);
+    for (wl_surface *surface : std::as_const(surfaces))
+        wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::occlusionOfLockedItem()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    ShmBuffer buffer(QSize(16, 16), client.shm);
+    wl_region *region = wl_compositor_create_region(client.compositor);
+    wl_region_add(region, 0, 0, 16, 16);
+    QList<wl_surface *> surfaces;
+    for (int i = 0; i < 2; ++i) {
+        wl_surface *surface = client.createSurface();
+        wl_surface_attach(surface, buffer.handle, 0, 0);
+        wl_surface_set_opaque_region(surface, region);
+        wl_surface_damage(surface, 0, 0, 16, 16);
+        wl_surface_commit(surface);
+        surfaces << surface;
+    }
+    QTRY_COMPARE(compositor.surfaces.size(), 2);
+    for (QWaylandSurface *surface : std::as_const(compositor.surfaces))
+        QTRY_VERIFY(surface->hasContent());
+
+    QQuickWindow window;
+    window.resize(64, 64);
+    QWaylandQuickOutput output(&compositor, &window);
+
+    QList<QWaylandQuickItem *> items;
+    for (QWaylandSurface *surface : std::as_const(compositor.surfaces)) {
+        auto *item = new QWaylandQuickItem(window.contentItem());
+        item->setSurface(surface);
+        item->setSize(QSizeF(16, 16));
+        items << item;
+    }
+    QWaylandQuickItem *covered = items.at(0);
+    QWaylandQuickItem *cover = items.at(1);
+
+    // Lets the items update their paint nodes, as the scene graph does when syncing
+    auto surfaceNode = [&window, covered] {
+        QQuickWindowPrivate::get(&window)->updateDirtyNodes();
+        return static_cast<QWaylandSurfaceNode *>(QQuickItemPrivate::get(covered)->paintNode);
+    };
+
+    output.updateStarted();
+    QWaylandSurfaceNode *node = surfaceNode();
+    QVERIFY(node);
+    QVERIFY(node->isSubtreeBlocked());
+
+    // A locked view, like during a close animation, keeps its node but still follows the occlusion
+    covered->setBufferLocked(true);
+    cover->setVisible(false);
+    output.updateStarted();
+    QCOMPARE(surfaceNode(), node);
+    QVERIFY(!node->isSubtreeBlocked());
+
+    cover->setVisible(true);
+    output.updateStarted();
+    QCOMPARE(surfaceNode(), node);
+    QVERIFY(node->isSubtreeBlocked());
+
+    wl_region_destroy(region);
+    for (wl_surface *surface : std::as_const(surfaces))
+        wl_surface_destroy(surface);
+}
+
+void tst_WaylandCompositor::surfaceNodeOpaqueRegion()
+{
+    QImage image(16, 16, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QWaylandSharedMemoryTexture texture;
+    texture.setImage(image, image.rect());
+    QVERIFY(texture.hasAlphaChannel());
+
+    QWaylandSurfaceNode node;
+    node.setTexture(&texture);
+    QCOMPARE(node.childCount(), 2);
+    auto *opaquePart = static_cast<QSGGeometryNode *>(node.childAtIndex(0));
+    auto *translucentPart = static_cast<QSGGeometryNode *>(node.childAtIndex(1));
+
+    // Only the opaque region is drawn without blending, also at full opacity
+    QVERIFY(!(opaquePart->opaqueMaterial()->flags() & QSGMaterial::Blending));
+    QVERIFY(translucentPart->opaqueMaterial()->flags() & QSGMaterial::Blending);
+    QVERIFY(translucentPart->material()->flags() & QSGMaterial::Blending);
+
+    // The area a part covers in item coordinates, and the texture coordinate at its top
+    auto bounds = [](QSGGeometryNode *part) {
+        const QSGGeometry *geometry = part->geometry();
+        const QSGGeometry::TexturedPoint2D *v = geometry->vertexDataAsTexturedPoint2D();
+        QPolygonF points;
+        float top = std::numeric_limits<float>::max();
+        float textureTop = 0;
+        for (int i = 0; i < geometry->vertexCount(); ++i) {
+            points << QPointF(v[i].x, v[i].y);
+            if (v[i].y < top) {
+                top = v[i].y;
+                textureTop = v[i].ty;
+            }
+        }
+        return std::make_pair(points.boundingRect(), textureTop);
+    };
+
+    // The top quarter of the surface is opaque
+    const QRectF source(0, 0, 16, 16);
+    const QRegion opaqueRegion(0, 0, 16, 4);
+    node.update(QRectF(0, 0, 16, 16), source, QSize(16, 16), opaqueRegion);
+    QCOMPARE(opaquePart->geometry()->vertexCount(), 6);
+    QCOMPARE(bounds(opaquePart).first, QRectF(0, 0, 16, 4));
+    QCOMPARE(bounds(opaquePart).second, 0.f);
+    QCOMPARE(bounds(translucentPart).first, QRectF(0, 4, 16, 12));
+
+    // Buffers with a bottom-left origin are drawn flipped, and so is the opaque region
+    node.update(QRectF(0, 16, 16, -16), source, QSize(16, 16), opaqueRegion);
+    QCOMPARE(opaquePart->geometry()->vertexCount(), 6);
+    QCOMPARE(bounds(opaquePart).first, QRectF(0, 0, 16, 4));
+    QCOMPARE(bounds(opaquePart).second, 1.f);
+    QCOMPARE(bounds(translucentPart).first, QRectF(0, 4, 16, 12));
+
+    // Occluded nodes block their subtree
+    QVERIFY(!node.isSubtreeBlocked());
+    node.setOccluded(true);
+    QVERIFY(node.isSubtreeBlocked());
+}
+#endif
+
+void tst_WaylandCompositor::shmEmulationServerBuffer()
+{
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    auto cleanup = qScopeGuard([] { qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION"); });
+
+    TestCompositor compositor;
+    compositor.create();
+    QtWayland::ServerBufferIntegration *integration = QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration();
+    if (!integration)
+        QSKIP("The shm-emulation-server server buffer integration is not available");
+
+    MockClient client;
+    QVERIFY(client.shmServerBufferIntegration);
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    wl_client *waylandClient = compositor.surfaces.at(0)->client()->client();
+
+    // An A8 image with an odd width, so that the lines are padded
+    QImage image(5, 3, QImage::Format_Alpha8);
+    QVERIFY(image.bytesPerLine() > image.width());
+    for (int y = 0; y < image.height(); ++y) {
+        for (int x = 0; x < image.width(); ++x)
+            image.scanLine(y)[x] = uchar(x * 50 + y * 10);
+    }
+
+    std::unique_ptr<QtWayland::ServerBuffer> serverBuffer(
+            integration->createServerBufferFromImage(image, QtWayland::ServerBuffer::A8));
+    QVERIFY(serverBuffer);
+    QVERIFY(!serverBuffer->bufferInUse());
+    QVERIFY(serverBuffer->resourceForClient(waylandClient));
+    QVERIFY(serverBuffer->bufferInUse());
+    compositor.flushClients();
+
+    QTRY_COMPARE(client.shmServerBufferIntegration->serverBuffers.size(), 1);
+    const auto &received = client.shmServerBufferIntegration->serverBuffers.first();
+    if (received.fd == -1)
+        QSKIP("Server buffers are not passed as memfds on this platform");
+    QCOMPARE(received.size, image.size());
+    QCOMPARE(received.bytesPerLine, image.bytesPerLine());
+    QCOMPARE(received.format, int(QtWayland::qt_shm_emulation_server_buffer::format_A8));
+
+    // The memfd is sealed, so clients can read it without any locking
+    const qsizetype byteCount = qsizetype(received.bytesPerLine) * received.size.height();
+#ifdef F_GET_SEALS
+    const int seals = fcntl(received.fd, F_GET_SEALS);
+    QCOMPARE(seals & (F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW), F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW);
+#endif
+    QCOMPARE(mmap(nullptr, byteCount, PROT_READ | PROT_WRITE, MAP_SHARED, received.fd, 0), MAP_FAILED);
+
+    void *data = mmap(nullptr, byteCount, PROT_READ, MAP_SHARED, received.fd, 0);
+    QVERIFY(data != MAP_FAILED);
+    const QImage mapped(static_cast<const uchar *>(data), received.size.width(), received.size.height(),
+                        received.bytesPerLine, QImage::Format_Alpha8);
+    QCOMPARE(mapped, image);
+    munmap(data, byteCount);
+
+    // Asking again for the same client reuses the resource
+    QVERIFY(serverBuffer->resourceForClient(waylandClient));
+    compositor.flushClients();
+    QTest::qWait(50);
+    QCOMPARE(client.shmServerBufferIntegration->serverBuffers.size(), 1);
+
+    // The buffer is no longer in use once the client releases it
+    qt_server_buffer_release(received.buffer);
+    qt_server_buffer_destroy(received.buffer);
+    QTRY_VERIFY(!serverBuffer->bufferInUse());
+
+    wl_surface_destroy(surface);
+}
+
+#if QT_CONFIG(opengl) && QT_CONFIG(wayland_compositor_quick)
+class TextureSharingTestCompositor : public TestCompositor {
+    Q_OBJECT
+public:
+    TextureSharingTestCompositor() : textureSharing(this) {}
+    QWaylandTextureSharingExtension textureSharing;
+};
+
+static QImage sharedTestImage(const QSize &size)
+{
+    QImage image(size, QImage::Format_RGBA8888);
+    image.fill(Qt::red);
+    return image;
+}
+
+// Requests the shared image key, and waits until the compositor either provides it or fails
+static bool requestSharedImage(MockClient &client, const QString &key)
+{
+    MockTextureSharing *textureSharing = client.textureSharing;
+    const qsizetype answers = textureSharing->providedKeys.size() + textureSharing->failedKeys.size();
+    textureSharing->request_image(key);
+    return QTest::qWaitFor([&] {
+        return textureSharing->providedKeys.size() + textureSharing->failedKeys.size() > answers;
+    });
+}
+
+// Maps the last server buffer the client got, and returns a copy of its pixels
+static QImage lastServerBufferImage(MockClient &client)
+{
+    const auto &received = client.shmServerBufferIntegration->serverBuffers.last();
+    const qsizetype byteCount = qsizetype(received.bytesPerLine) * received.size.height();
+    void *data = mmap(nullptr, byteCount, PROT_READ, MAP_SHARED, received.fd, 0);
+    if (data == MAP_FAILED)
+        return QImage();
+    const QImage image = QImage(static_cast<const uchar *>(data), received.size.width(), received.size.height(),
+                                received.bytesPerLine, QImage::Format_RGBA8888_Premultiplied).copy();
+    munmap(data, byteCount);
+    return image;
+}
+
+void tst_WaylandCompositor::textureSharingAsyncLoad()
+{
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    auto cleanup = qScopeGuard([] { qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION"); });
+
+    QTemporaryDir imageDir;
+    QVERIFY(imageDir.isValid());
+    QVERIFY(sharedTestImage(QSize(16, 8)).save(imageDir.filePath(QStringLiteral("red.png"))));
+
+    TextureSharingTestCompositor compositor;
+    compositor.textureSharing.setImageSearchPath(imageDir.path());
+    compositor.create();
+    if (!QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration())
+        QSKIP("The shm-emulation-server server buffer integration is not available");
+
+    QList<QtWayland::ServerBuffer *> results;
+    connect(&compositor.textureSharing, &QWaylandTextureSharingExtension::bufferResult, &compositor,
+            [&results](const QString &key, QtWayland::ServerBuffer *buffer) {
+        if (key == QLatin1String("red"))
+            results.append(buffer);
+    });
+
+    // The image is decoded in the background, and the second request waits for the same load
+    compositor.textureSharing.requestBuffer(QStringLiteral("red"));
+    compositor.textureSharing.requestBuffer(QStringLiteral("red"));
+    QCOMPARE(results.size(), 0);
+    QTRY_COMPARE(results.size(), 2);
+    QVERIFY(results.at(0));
+    QCOMPARE(results.at(1), results.at(0));
+    QCOMPARE(results.at(0)->size(), QSize(16, 8));
+
+    // Once it is loaded, the buffer is answered right away
+    compositor.textureSharing.requestBuffer(QStringLiteral("red"));
+    QCOMPARE(results.size(), 3);
+    QCOMPARE(results.at(2), results.at(0));
+}
+
+void tst_WaylandCompositor::textureSharingCacheEviction()
+{
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    qputenv("QT_WAYLAND_SHAREDTEXTURE_CACHE_SIZE", "1");
+    auto cleanup = qScopeGuard([] {
+        qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION");
+        qunsetenv("QT_WAYLAND_SHAREDTEXTURE_CACHE_SIZE");
+    });
+
+    // Each image takes a quarter of the 1 MB cache
+    const QStringList keys = { QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c"),
+                               QStringLiteral("d"), QStringLiteral("e") };
+    QTemporaryDir imageDir;
+    QVERIFY(imageDir.isValid());
+    for (const QString &key : keys)
+        QVERIFY(sharedTestImage(QSize(256, 256)).save(imageDir.filePath(key + QLatin1String(".png"))));
+
+    TextureSharingTestCompositor compositor;
+    compositor.textureSharing.setImageSearchPath(imageDir.path());
+    compositor.create();
+    if (!QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration())
+        QSKIP("The shm-emulation-server server buffer integration is not available");
+
+    {
+        // The buffers stay cached when the client using them is gone
+        MockClient client;
+        QTRY_VERIFY(client.textureSharing && client.shmServerBufferIntegration);
+        for (const QString &key : keys.mid(0, 4)) {
+            QVERIFY(requestSharedImage(client, key));
+            QCOMPARE(client.textureSharing->providedKeys.last(), key);
+        }
+    }
+    QTRY_COMPARE(compositor.clients().size(), 0);
+
+    MockClient client;
+    QTRY_VERIFY(client.textureSharing && client.shmServerBufferIntegration);
+
+    // Using "a" again leaves "b" as the least recently used, so it goes when "e" does not fit
+    QVERIFY(requestSharedImage(client, QStringLiteral("a")));
+    QVERIFY(requestSharedImage(client, QStringLiteral("e")));
+    QCOMPARE(client.textureSharing->providedKeys, QStringList({ QStringLiteral("a"), QStringLiteral("e") }));
+
+    // Without the files, only the cached images can still be provided
+    for (const QString &key : keys)
+        QVERIFY(QFile::remove(imageDir.filePath(key + QLatin1String(".png"))));
+    for (const QString &key : keys) {
+        QVERIFY(requestSharedImage(client, key));
+        QCOMPARE(client.textureSharing->failedKeys.contains(key), key == QLatin1String("b"));
+    }
+    QCOMPARE(client.textureSharing->failedKeys.size(), 1);
+}
+
+void tst_WaylandCompositor::textureSharingPreload()
+{
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    qputenv("QT_WAYLAND_SHAREDTEXTURE_CACHE_SIZE", "1");
+    auto cleanup = qScopeGuard([] {
+        qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION");
+        qunsetenv("QT_WAYLAND_SHAREDTEXTURE_CACHE_SIZE");
+    });
+
+    // Each image takes a quarter of the 1 MB cache, so the last one is not preloaded
+    const QStringList keys = { QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c"),
+                               QStringLiteral("d"), QStringLiteral("e") };
+    QTemporaryDir imageDir;
+    QVERIFY(imageDir.isValid());
+    QFile manifest(imageDir.filePath(QStringLiteral("manifest")));
+    QVERIFY(manifest.open(QIODevice::WriteOnly | QIODevice::Text));
+    manifest.write("# Shown right after startup\n\n");
+    for (const QString &key : keys) {
+        QVERIFY(sharedTestImage(QSize(256, 256)).save(imageDir.filePath(key + QLatin1String(".png"))));
+        manifest.write(key.toUtf8() + '\n');
+    }
+    manifest.close();
+
+    TextureSharingTestCompositor compositor;
+    compositor.textureSharing.setImageSearchPath(imageDir.path());
+    compositor.textureSharing.setPreloadManifest(manifest.fileName());
+    QSignalSpy preloadSpy(&compositor.textureSharing, &QWaylandTextureSharingExtension::preloadFinished);
+    compositor.create();
+    if (!QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration())
+        QSKIP("The shm-emulation-server server buffer integration is not available");
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression("stopped preloading at \"e\""));
+    QTRY_COMPARE(preloadSpy.size(), 1);
+
+    // Without the files, only the preloaded images can be provided, from the cache
+    for (const QString &key : keys)
+        QVERIFY(QFile::remove(imageDir.filePath(key + QLatin1String(".png"))));
+    MockClient client;
+    QTRY_VERIFY(client.textureSharing && client.shmServerBufferIntegration);
+    for (const QString &key : keys) {
+        QVERIFY(requestSharedImage(client, key));
+        QCOMPARE(client.textureSharing->failedKeys.contains(key), key == QLatin1String("e"));
+    }
+    QCOMPARE(client.textureSharing->providedKeys, keys.mid(0, 4));
+}
+
+void tst_WaylandCompositor::textureSharingMovedImage()
+{
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    qputenv("QT_WAYLAND_SHAREDTEXTURE_CACHE_SIZE", "0");
+    auto cleanup = qScopeGuard([] {
+        qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION");
+        qunsetenv("QT_WAYLAND_SHAREDTEXTURE_CACHE_SIZE");
+    });
+
+    QTemporaryDir imageDir;
+    QVERIFY(imageDir.isValid());
+    QVERIFY(QDir(imageDir.path()).mkpath(QStringLiteral("first")));
+    QVERIFY(QDir(imageDir.path()).mkpath(QStringLiteral("second")));
+    const QString firstPath = imageDir.filePath(QStringLiteral("first/red.png"));
+    const QString secondPath = imageDir.filePath(QStringLiteral("second/red.png"));
+    QVERIFY(sharedTestImage(QSize(16, 8)).save(firstPath));
+
+    TextureSharingTestCompositor compositor;
+    compositor.textureSharing.setImageSearchPath(imageDir.filePath(QStringLiteral("first")) + QLatin1Char(';')
+                                                 + imageDir.filePath(QStringLiteral("second")));
+    compositor.create();
+    if (!QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration())
+        QSKIP("The shm-emulation-server server buffer integration is not available");
+
+    {
+        MockClient client;
+        QTRY_VERIFY(client.textureSharing && client.shmServerBufferIntegration);
+        QVERIFY(requestSharedImage(client, QStringLiteral("red")));
+        QCOMPARE(client.textureSharing->providedKeys, QStringList(QStringLiteral("red")));
+    }
+    QTRY_COMPARE(compositor.clients().size(), 0);
+
+    // Nothing is cached, and the file is no longer where it was found first
+    QVERIFY(QFile::rename(firstPath, secondPath));
+
+    MockClient client;
+    QTRY_VERIFY(client.textureSharing && client.shmServerBufferIntegration);
+    QVERIFY(requestSharedImage(client, QStringLiteral("red")));
+    QCOMPARE(client.textureSharing->providedKeys, QStringList(QStringLiteral("red")));
+    QVERIFY(client.textureSharing->failedKeys.isEmpty());
+}
+
+void tst_WaylandCompositor::textureSharingDiskCache()
+{
+    qputenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION", "shm-emulation-server");
+    auto cleanup = qScopeGuard([] { qunsetenv("QT_WAYLAND_SERVER_BUFFER_INTEGRATION"); });
+
+    QTemporaryDir imageDir;
+    QTemporaryDir cacheDir;
+    QVERIFY(imageDir.isValid());
+    QVERIFY(cacheDir.isValid());
+    const QSize size(16, 8);
+    QVERIFY(sharedTestImage(size).save(imageDir.filePath(QStringLiteral("red.png"))));
+
+    // Loads the image in a compositor of its own, so that nothing is cached in memory
+    auto loadImage = [&]() -> QImage {
+        TextureSharingTestCompositor compositor;
+        compositor.textureSharing.setImageSearchPath(imageDir.path());
+        compositor.textureSharing.setDiskCachePath(cacheDir.path());
+        compositor.create();
+        MockClient client;
+        if (!QTest::qWaitFor([&] { return client.textureSharing && client.shmServerBufferIntegration; })
+            || !requestSharedImage(client, QStringLiteral("red"))
+            || client.textureSharing->providedKeys.isEmpty()) {
+            return QImage();
+        }
+        return lastServerBufferImage(client);
+    };
+
+    {
+        TestCompositor compositor;
+        compositor.create();
+        if (!QWaylandCompositorPrivate::get(&compositor)->serverBufferIntegration())
+            QSKIP("The shm-emulation-server server buffer integration is not available");
+    }
+
+    // The decoded image is written to the cache, as a header followed by the pixels
+    QImage image = loadImage();
+    if (image.isNull())
+        QSKIP("Server buffers are not passed as memfds on this platform");
+    QCOMPARE(image.pixel(0, 0), qRgba(255, 0, 0, 255));
+    const QStringList cacheFiles = QDir(cacheDir.path()).entryList({ QStringLiteral("*.rgba") }, QDir::Files);
+    QCOMPARE(cacheFiles.size(), 1);
+    QFile cacheFile(cacheDir.filePath(cacheFiles.first()));
+    const qint64 headerSize = 6 * sizeof(quint32);
+    QCOMPARE(cacheFile.size(), headerSize + size.width() * 4 * size.height());
+
+    // Change the first pixel in the cache, so that reading it back can be told from decoding
+    QVERIFY(cacheFile.open(QIODevice::ReadWrite));
+    QVERIFY(cacheFile.seek(headerSize));
+    const uchar green[] = { 0, 255, 0, 255 };
+    QCOMPARE(cacheFile.write(reinterpret_cast<const char *>(green), sizeof(green)), qint64(sizeof(green)));
+    cacheFile.close();
+    image = loadImage();
+    QCOMPARE(image.size(), size);
+    QCOMPARE(image.pixel(0, 0), qRgba(0, 255, 0, 255));
+
+    // A broken header is rejected, and the image is decoded and cached again. The last
+    // width only fits 32 bits when multiplied by four if it wraps around.
+    const struct { qint64 offset; quint32 value; } corruptions[] = {
+        { 0, 0 }, // magic
+        { 8, 0 }, // width
+        { 12, 0 }, // height
+        { 16, 4 }, // bytes per line
+        { 8, 0x40000001 }, // width
+    };
+    for (const auto &corruption : corruptions) {
+        QVERIFY(cacheFile.open(QIODevice::ReadWrite));
+        QVERIFY(cacheFile.seek(headerSize));
+        QCOMPARE(cacheFile.write(reinterpret_cast<const char *>(green), sizeof(green)), qint64(sizeof(green)));
+        QVERIFY(cacheFile.seek(corruption.offset));
+        QCOMPARE(cacheFile.write(reinterpret_cast<const char *>(&corruption.value), sizeof(quint32)),
+                 qint64(sizeof(quint32)));
+        cacheFile.close();
+
+        image = loadImage();
+        QCOMPARE(image.size(), size);
+        QCOMPARE(image.pixel(0, 0), qRgba(255, 0, 0, 255));
+        QCOMPARE(cacheFile.size(), headerSize + size.width() * 4 * size.height());
+    }
+}
+#endif
+
 void tst_WaylandCompositor::outputs()
 {
     TestCompositor compositor;
@@ -852,6 +1841,66 @@ void tst_WaylandCompositor::seatMouseFocus()
     delete view;
 }
 
+void tst_WaylandCompositor::seatMotionBatching()
+{
+    TestCompositor compositor;
+    compositor.create();
+
+    MockClient client;
+    QTRY_COMPARE(client.m_seats.size(), 1);
+    MockPointer *mockPointer = client.m_seats.first()->pointer();
+    QVERIFY(mockPointer);
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandView view;
+    view.setSurface(compositor.surfaces.at(0));
+    view.setOutput(compositor.defaultOutput());
+
+    QWaylandSeat *seat = compositor.defaultSeat();
+    QSignalSpy batchingSpy(seat, &QWaylandSeat::motionBatchingEnabledChanged);
+    seat->setMotionBatchingEnabled(true);
+    QCOMPARE(batchingSpy.size(), 1);
+
+    // Entering the surface is not delayed
+    seat->sendMouseMoveEvent(&view, QPointF(10, 10));
+    compositor.flushClients();
+    QTRY_COMPARE(mockPointer->m_enteredSurface, surface);
+    QTRY_COMPARE(mockPointer->m_motionCount, 1);
+
+    // Motion between two frames is merged into one event
+    for (int i = 1; i <= 10; ++i)
+        seat->sendMouseMoveEvent(&view, QPointF(10 + i, 10));
+    compositor.defaultOutput()->frameStarted();
+    compositor.flushClients();
+    QTRY_COMPARE(mockPointer->m_motionCount, 2);
+    QCOMPARE(mockPointer->m_position, QPointF(20, 10));
+
+    // Merged motion is sent right before a button event
+    seat->sendMouseMoveEvent(&view, QPointF(25, 10));
+    seat->sendMouseMoveEvent(&view, QPointF(30, 10));
+    seat->sendMousePressEvent(Qt::LeftButton);
+    compositor.flushClients();
+    QTRY_COMPARE(mockPointer->m_buttonCount, 1);
+    QCOMPARE(mockPointer->m_motionCount, 3);
+    QCOMPARE(mockPointer->m_buttonPosition, QPointF(30, 10));
+
+    // Nothing is left to send with the next frame
+    compositor.defaultOutput()->frameStarted();
+    seat->sendMouseReleaseEvent(Qt::LeftButton);
+    compositor.flushClients();
+    QTRY_COMPARE(mockPointer->m_buttonCount, 2);
+    QCOMPARE(mockPointer->m_motionCount, 3);
+
+    // Disabling batching sends pending motion and stops merging
+    seat->sendMouseMoveEvent(&view, QPointF(35, 10));
+    seat->setMotionBatchingEnabled(false);
+    seat->sendMouseMoveEvent(&view, QPointF(40, 10));
+    compositor.flushClients();
+    QTRY_COMPARE(mockPointer->m_motionCount, 5);
+    QCOMPARE(mockPointer->m_position, QPointF(40, 10));
+}
+
 void tst_WaylandCompositor::inputRegion()
 {
     TestCompositor compositor(true);
@@ -1730,6 +2779,190 @@ void tst_WaylandCompositor::idleInhibit()
     QTRY_COMPARE(changedSpy.size(), 1);
 }
 
+class CursorShapeCompositor : public TestCompositor
+{
+    Q_OBJECT
+public:
+    CursorShapeCompositor() : TestCompositor(true), cursorShapeManager(this) {}
+    QWaylandCursorShapeManagerV1 cursorShapeManager;
+};
+
+void tst_WaylandCompositor::cursorShape()
+{
+    CursorShapeCompositor compositor;
+    compositor.create();
+    MockClient client;
+    QTRY_VERIFY(client.cursorShapeManager);
+    QTRY_COMPARE(client.m_seats.size(), 1);
+    MockPointer *mockPointer = client.m_seats.first()->pointer();
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandView view;
+    view.setSurface(compositor.surfaces.at(0));
+
+    QSignalSpy shapeSpy(&compositor.cursorShapeManager, &QWaylandCursorShapeManagerV1::cursorShapeRequested);
+    QSignalSpy cursorSurfaceSpy(compositor.defaultSeat(), &QWaylandSeat::cursorSurfaceRequested);
+
+    QWaylandSeat *seat = compositor.defaultSeat();
+    seat->sendMouseMoveEvent(&view, QPointF(10, 10), QPointF(100, 100));
+    compositor.flushClients();
+    QTRY_COMPARE(mockPointer->m_enteredSurface, surface);
+
+    auto *device = wp_cursor_shape_manager_v1_get_pointer(client.cursorShapeManager, mockPointer->m_pointer);
+
+    // Requests with an outdated serial are ignored
+    wp_cursor_shape_device_v1_set_shape(device, mockPointer->m_enterSerial - 1, WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_TEXT);
+    wp_cursor_shape_device_v1_set_shape(device, mockPointer->m_enterSerial, WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_EW_RESIZE);
+    QTRY_COMPARE(shapeSpy.size(), 1);
+    QCOMPARE(shapeSpy.first().at(0).value<QWaylandSeat *>(), seat);
+    QCOMPARE(shapeSpy.first().at(1).value<QWaylandCursorShapeManagerV1::Shape>(), QWaylandCursorShapeManagerV1::EwResizeShape);
+    QCOMPARE(cursorSurfaceSpy.size(), 1);
+    QCOMPARE(cursorSurfaceSpy.first().at(0).value<QWaylandSurface *>(), nullptr);
+
+    // Shapes without a Qt::CursorShape of their own are still reported as they are
+    wp_cursor_shape_device_v1_set_shape(device, mockPointer->m_enterSerial, WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_CONTEXT_MENU);
+    QTRY_COMPARE(shapeSpy.size(), 2);
+    QCOMPARE(shapeSpy.last().at(1).value<QWaylandCursorShapeManagerV1::Shape>(), QWaylandCursorShapeManagerV1::ContextMenuShape);
+    QCOMPARE(QWaylandCursorShapeManagerV1::toCursorShape(QWaylandCursorShapeManagerV1::ContextMenuShape), Qt::ArrowCursor);
+    QCOMPARE(QWaylandCursorShapeManagerV1::toCursorShape(QWaylandCursorShapeManagerV1::EwResizeShape), Qt::SizeHorCursor);
+
+    wp_cursor_shape_device_v1_set_shape(device, mockPointer->m_enterSerial, 1000);
+    QTRY_COMPARE(client.error, EPROTO);
+    QCOMPARE(client.protocolError.code, uint(WP_CURSOR_SHAPE_DEVICE_V1_ERROR_INVALID_SHAPE));
+    QCOMPARE(shapeSpy.size(), 2);
+}
+
+class FractionalScaleCompositor : public TestCompositor
+{
+    Q_OBJECT
+public:
+    FractionalScaleCompositor() : fractionalScaleManager(this) {}
+    QWaylandFractionalScaleManagerV1 fractionalScaleManager;
+};
+
+static void preferredScaleFunc(void *data, wp_fractional_scale_v1 *fractionalScale, uint32_t scale)
+{
+    Q_UNUSED(fractionalScale);
+    *static_cast<uint *>(data) = scale;
+}
+
+void tst_WaylandCompositor::fractionalScale()
+{
+    FractionalScaleCompositor compositor;
+    compositor.create();
+    MockClient client;
+    QTRY_VERIFY(client.fractionalScaleManager);
+    QWaylandOutput *output = compositor.defaultOutput();
+    QCOMPARE(output->fractionalScaleFactor(), 1.0);
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+
+    static const wp_fractional_scale_v1_listener listener = { preferredScaleFunc };
+    uint preferredScale = 0;
+    auto *fractionalScale = wp_fractional_scale_manager_v1_get_fractional_scale(client.fractionalScaleManager, surface);
+    wp_fractional_scale_v1_add_listener(fractionalScale, &listener, &preferredScale);
+
+    // Unmapped surfaces get the scale of the default output
+    compositor.flushClients();
+    QTRY_COMPARE(preferredScale, 120u);
+
+    output->setScaleFactor(2);
+    output->setFractionalScaleFactor(1.5);
+    QCOMPARE(output->fractionalScaleFactor(), 1.5);
+
+    BufferView view;
+    view.setSurface(compositor.surfaces.at(0));
+    view.setOutput(output);
+    ShmBuffer buffer(QSize(30, 30), client.shm);
+    wl_surface_attach(surface, buffer.handle, 0, 0);
+    wl_surface_damage(surface, 0, 0, 30, 30);
+    wl_surface_commit(surface);
+    QTRY_VERIFY(compositor.surfaces.at(0)->hasContent());
+
+    // The scale is sent in 120ths when the surface enters the output
+    output->frameStarted();
+    output->sendFrameCallbacks();
+    QTRY_COMPARE(preferredScale, 180u);
+
+    output->setFractionalScaleFactor(1.25);
+    compositor.flushClients();
+    QTRY_COMPARE(preferredScale, 150u);
+
+    // Without a fractional scale, the integer one is used
+    output->resetFractionalScaleFactor();
+    QCOMPARE(output->fractionalScaleFactor(), 2.0);
+    compositor.flushClients();
+    QTRY_COMPARE(preferredScale, 240u);
+
+    wp_fractional_scale_v1_destroy(fractionalScale);
+}
+
+class SinglePixelBufferCompositor : public TestCompositor
+{
+    Q_OBJECT
+public:
+    SinglePixelBufferCompositor() : viewporter(this), singlePixelBufferManager(this) {}
+    QWaylandViewporter viewporter;
+    QWaylandSinglePixelBufferManagerV1 singlePixelBufferManager;
+};
+
+static void singlePixelBufferRelease(void *data, wl_buffer *buffer)
+{
+    Q_UNUSED(buffer);
+    ++*static_cast<int *>(data);
+}
+
+void tst_WaylandCompositor::singlePixelBuffer()
+{
+    SinglePixelBufferCompositor compositor;
+    compositor.create();
+    MockClient client;
+    QTRY_VERIFY(client.singlePixelBufferManager);
+    QTRY_VERIFY(client.viewporter);
+
+    wl_surface *surface = client.createSurface();
+    QTRY_COMPARE(compositor.surfaces.size(), 1);
+    QWaylandSurface *waylandSurface = compositor.surfaces.at(0);
+
+    BufferView view;
+    view.setSurface(waylandSurface);
+
+    // Half transparent red, the channels are premultiplied
+    wl_buffer *buffer = wp_single_pixel_buffer_manager_v1_create_u32_rgba_buffer(
+            client.singlePixelBufferManager, 0x80000000, 0, 0, 0x80000000);
+    static const wl_buffer_listener listener = { singlePixelBufferRelease };
+    int releaseCount = 0;
+    wl_buffer_add_listener(buffer, &listener, &releaseCount);
+
+    wp_viewport *viewport = wp_viewporter_get_viewport(client.viewporter, surface);
+    wp_viewport_set_destination(viewport, 200, 100);
+    wl_surface_attach(surface, buffer, 0, 0);
+    wl_surface_damage(surface, 0, 0, 200, 100);
+    wl_surface_commit(surface);
+
+    QTRY_VERIFY(waylandSurface->hasContent());
+    QCOMPARE(waylandSurface->bufferSize(), QSize(1, 1));
+    QCOMPARE(waylandSurface->destinationSize(), QSize(200, 100));
+    QVERIFY(!view.bufferRef.isSharedMemory());
+    const QColor color = view.bufferRef.solidColor();
+    QCOMPARE(color.red(), 255);
+    QCOMPARE(color.green(), 0);
+    QCOMPARE(color.blue(), 0);
+    QCOMPARE(color.alpha(), 128);
+    QCOMPARE(view.bufferRef.image().size(), QSize(1, 1));
+
+    // The color is copied on commit, so the buffer can be reused at once
+    compositor.flushClients();
+    QTRY_COMPARE(releaseCount, 1);
+
+    wp_viewport_destroy(viewport);
+    wl_buffer_destroy(buffer);
+    wl_surface_destroy(surface);
+    QCOMPARE(client.error, 0);
+}
+
 class XdgOutputCompositor : public TestCompositor
 {
     Q_OBJECT